@@ -1,6 +1,12 @@
 
 cd src
 
+ls mkoptab.go
+go run mkoptab.go
+git add mkoptab.go
+git add optab.go
+git add ../res/myth_instructions.json
+
 cd clox
 ls lox.c
 9c lox.c
@@ -10,14 +16,78 @@ rm lox.o
 git add lox.c
 git add lox.h
 git add myth.h
+git add optab.h
+git add myst.h
+git add io.h
+git add spi.h
+git add sd.h
+git add tcall.h
+git add mtrace.h
+git add myth.hpp
+
+ls mtdump.c
+9c mtdump.c
+9l mtdump.o
+mv a.out ../../mtdump
+rm mtdump.o
+git add mtdump.c
+
+ls bench.c
+9c bench.c vtable.c
+9l bench.o vtable.o
+mv a.out ../../bench
+rm bench.o vtable.o
+git add bench.c
+git add vtable.c
+
+ls wcet.c
+9c wcet.c
+9l wcet.o
+mv a.out ../../wcet
+rm wcet.o
+git add wcet.c
+
+ls mrun.cc
+c++ -std=c++17 -O2 -I$PLAN9/include mrun.cc -L$PLAN9/lib -l9
+mv a.out ../../mrun
+git add mrun.cc
+git add revs.hpp
+git add lasm.hpp
+
+ls blurchk.cc
+c++ -std=c++17 -O2 -I$PLAN9/include blurchk.cc -L$PLAN9/lib -l9
+mv a.out ../../blurchk
+git add blurchk.cc
 cd ..
 
 ls goldie.go
 git add goldie.go
-go build goldie.go
+git add peephole.go
+git add link.go
+go build goldie.go optab.go peephole.go link.go
 mv goldie ..
 cd ..
 
 git add lox.asm
 git add build.sh
 
+# Checks, in a scratch directory so corestate.myst stays as it is
+
+d=`pwd`
+t=`mktemp -d`
+cd $t
+
+# lox -s runs before the ramdisk is mapped: step an E write selecting SMEM
+printf 'P[COLD]0\n        ne 2\n        END\n' >step.asm
+$d/goldie step.asm >/dev/null
+$d/lox -s
+$d/lox -r | grep -q 'pc:02h' || echo 'CHECK FAILED: lox -s on an E write'
+
+# lasm.hpp assembles lox.asm as goldie does: run both images the same
+mkdir goldie lasm
+(cd goldie && $d/goldie $d/lox.asm >/dev/null && $d/mrun corestate.myst)
+(cd lasm && $d/mrun $d/lox.asm)
+cmp goldie/corestate.myst lasm/corestate.myst || echo 'CHECK FAILED: lasm and goldie differ on lox.asm'
+
+cd $d
+rm -r $t
@@ -331,38 +331,143 @@ P[NextArg]+  (Advance LOX ARG PTR to next string)
 
 
 ;************* **************************************************************
-P[SPI_RdByte]+  (Read one byte over SPI bus / 25LC EEPROM)
+P[SPI_RdByte]+  (Read one byte over SPI bus / 25LC EEPROM, result in R)
 ;************* **************************************************************
 
-           SCH, SCL
-           SSI, SSO, SCH SCL
-           SSI, SSO, SCH SCL
-           SSI, SSO, SCH SCL
-           SSI, SSO, SCH SCL
-           SSI, SSO, SCH SCL
-           SSI, SSO, SCH SCL
-           SSI, SSO, SCH SCL
-           SSI, SSO
+           OWN
+           ns FFh               (Dummy byte, keeps MOSI high)
 
+           (Mode 0, MSB first. Keep this exact sequence,
+            the emulator transfers it as one byte.)
+
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+
+           sr RET
+
+
+;************* **************************************************************
+P[SPI_WrByte]+ (Write R over SPI bus / 25LC EEPROM, received byte in R)
+;************* **************************************************************
+
+           OWN
+           rs
+
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+           SSO SCH SSI SCL
+
+           sr RET
+
+
+;************** *************************************************************
+P[SMEM_Addr]+  (Set SMEM address to G:O:R, select auto-increment mode)
+;************** *************************************************************
+
+           OWN
+           ne 0                 (Deselect all devices)
+           rp ne 21h, ne 01h    (POR onto bus, latch bits 0-7)
+           o0 0r
+           rp ne 31h, ne 01h    (Bits 8-15)
+           gp ne 41h, ne 01h    (Bits 16-23)
+           np 1, ne 61h         (Mode latch: auto-increment)
+           ne 0
            RET
 
 
+;************** *************************************************************
+P[SMEM_Read]+  (Read R bytes from SMEM into G:O, zero means 256)
+;************** *************************************************************
+
+           OWN i6
+           M1 ri                (Loop counter)
+           ne 0
+
+      O[SMEMRdLoop]
+           ne 12h, pm           (Strobe data onto bus, PIR latches, store)
+           ne 10h               (Release strobe, address has advanced)
+           na 1                 (Next destination byte)
+           nw <SMEMRdLoop
+
+           ne 0
+           6i RET
+
+
+;*************** ************************************************************
+P[SMEM_Write]+  (Write R bytes from G:O to SMEM, zero means 256)
+;*************** ************************************************************
+
+           OWN i6
+           M1 ri                (Loop counter)
+           ne 01h               (POR drives bus)
+
+      O[SMEMWrLoop]
+           mp                   (Next source byte)
+           ne 51h, ne 01h       (Write strobe, address advances)
+           na 1
+           nw <SMEMWrLoop
+
+           ne 0
+           6i RET
+
+
+;*********** ****************************************************************
+P[Cycles]+  (Read cycle counter: bits 16-23 in G, 8-15 in O, 0-7 in R)
+;*********** ****************************************************************
+
+           (The counter and timer count instructions executed,
+            not board clocks: an instruction takes three clocks.)
+
+           OWN
+           ne 0
+           ne 70h               (Snapshot counter and timer)
+           ne 16h, pr, r0       (Bits 0-7)
+           ne 10h, ne 16h, pr, r1
+           ne 10h, ne 16h, pg   (Bits 16-23)
+           ne 0
+           1o 0r RET
+
+
 ;************* **************************************************************
-P[SPI_WrByte]+ (Write one byte to SPI bus / 25LC EEPROM)
+P[TimerSet]+  (Start countdown timer from O:R cycles)
 ;************* **************************************************************
 
-           SCH SCL,
-           SSO SCH SCL,
-           SSO SCH SCL,
-           SSO SCH SCL,
-           SSO SCH SCL,
-           SSO SCH SCL,
-           SSO SCH SCL,
-           SSO SCH SCL
+           (A cycle is one instruction, see Cycles)
 
+           OWN
+           r0 o1
+           ne 0
+           CLR rp, ne 81h, ne 01h (Reload bits 16-23, zero)
+           1r rp, ne 81h, ne 01h (Reload bits 8-15)
+           0r rp, ne 81h         (Reload bits 0-7, starts countdown)
+           ne 0
            RET
 
 
+;************** *************************************************************
+P[TimerLeft]+  (Remaining timer cycles in O:R, zero when expired)
+;************** *************************************************************
+
+           OWN
+           ne 0
+           ne 70h               (Snapshot counter and timer)
+           ne 17h, pr, r0
+           ne 10h, ne 17h, pr, r1
+           ne 0
+           1o 0r RET
+
+
 ;Todo: Port these routines over from Paver project
 
 ;@SPI_reset
@@ -1803,11 +1908,19 @@ P[LOXBASE]7Fh
     C[SH2_SMEMA0LE]20h  (SMEM address bit latch 0-7)
     C[SH3_SMEMA1LE]30h  (SMEM address bit latch 8-15)
     C[SH4_SMEMA2LE]40h  (SMEM address bit latch 16-23)
+    C[SH5_SMEMWE]50h    (SMEM data byte write strobe, from bus)
+    C[SH6_SMEMMODE]60h  (SMEM mode latch, bit 0 auto-increment)
+    C[SH7_CYCLE]70h     (Snapshot cycle counter and timer)
+    C[SH8_TIMLE]80h     (Timer reload byte latch, starts countdown)
 
     C[SL0_NULL]0        (NULL device for SL)
     C[SL1_PAROE]1       (CPU parallel port output enable)
     C[SL2_SMEMOE]2      (SMEM data byte output enable)
     C[SL3_SMEMWE]3      (SMEM data byte write enable)
+    C[SL4_EECS]4        (25LC EEPROM chip select, SPI)
+    C[SL5_SDCS]5        (SD card chip select, SPI)
+    C[SL6_CYCOE]6       (Cycle counter snapshot byte output enable)
+    C[SL7_TIMOE]7       (Timer remaining cycles byte output enable)
 
 
     0 ; This is required due to some bug in wrDebugTxt()
@@ -0,0 +1,176 @@
+/*
+    Dispatch benchmark for the Myth/LOX emulation engines:
+    table dispatch (myth.h), computed goto (vtable.c) and
+    tail-call threaded (tcall.h).
+
+    Runs the firmware in "corestate.myst" like lox does, with
+    the given arguments, until END. No devices are attached,
+    so all engines see the same machine. The run is repeated
+    until every engine has retired at least the number of
+    instructions given with -n, final states are cross-checked.
+
+    Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+    Build using:
+    9c bench.c vtable.c
+    9l bench.o vtable.o
+
+    Run:
+    ./a.out [-n instructions] [args...]
+*/
+
+#include <u.h>
+#include <libc.h>
+#include "myth.h"
+#include "lox.h"
+#include "myst.h"
+#include "tcall.h"
+
+#define MAXRUN 100*1000*1000L /*Instructions per run without END*/
+
+long vtable_run(uchar ram[256][256], uchar reg[16], long n);
+
+struct myth_vm start, vm;
+uchar imgbuf[MYST_MAXSIZE(256, 256, NREGS)];
+
+enum { STEP, VTABLE, TCALL, NENGINE };
+char *engname[NENGINE] = { "myth.h", "vtable.c", "tcall.h" };
+
+
+void
+load(char *fname)
+{
+        int fdesc, err;
+        long n;
+        uchar regs[NREGS];
+
+        fdesc = open(fname, OREAD);
+        if (fdesc == -1) sysfatal("cannot open image");
+        n = readn(fdesc, imgbuf, sizeof imgbuf);
+        close(fdesc);
+        err = myst_decode(imgbuf, n, MYST_LOX, &start.ram[0][0], 256, 256, regs, NREGS);
+        if (err) sysfatal("unusable image");
+        unpackregs(&start, regs);
+}
+
+
+/* Arguments are passed as lox.c does
+*/
+
+void
+setargs(int argc, char *argv[])
+{
+        int i, k, offs;
+
+        for (i=0x00; i<0xF0; i++)
+                start.ram[0x7F][i] = 0;
+        offs = 0x80;
+        for (i=0; i<argc; i++) {
+                for (k=0; argv[i][k] && offs < 0xEF; k++)
+                        start.ram[0x7F][offs++] = argv[i][k];
+                start.ram[0x7F][offs++] = 0;
+                if (offs >= 0xEF) break;
+        }
+        start.ram[0x7F][POS] = 0;
+        start.ram[0x7F][ARG] = 0x80;
+        start.ram[0x7F][ECODE] = 0;
+}
+
+
+long
+runstep(struct myth_vm *vm)
+{
+        long n;
+
+        for (n=0; n<MAXRUN; ) {
+                n += myth_step(vm);
+                if (vm->scrounge == END) break;
+        }
+        return n;
+}
+
+long
+runvtable(struct myth_vm *vm)
+{
+        uchar reg[16];
+        long left;
+
+        reg[0] = vm->e_new; reg[1] = vm->sclk; reg[2] = vm->miso; reg[3] = vm->mosi;
+        reg[4] = vm->sir; reg[5] = vm->sor; reg[6] = vm->pir; reg[7] = vm->por;
+        reg[8] = vm->r; reg[9] = vm->o; reg[10] = vm->i; reg[11] = vm->pc;
+        reg[12] = vm->co; reg[13] = vm->c; reg[14] = vm->g; reg[15] = vm->l;
+        left = vtable_run(vm->ram, reg, MAXRUN);
+        vm->e_old = vm->e_new; vm->e_new = reg[0];
+        vm->sclk = reg[1]; vm->miso = reg[2]; vm->mosi = reg[3];
+        vm->sir = reg[4]; vm->sor = reg[5]; vm->pir = reg[6]; vm->por = reg[7];
+        vm->r = reg[8]; vm->o = reg[9]; vm->i = reg[10]; vm->pc = reg[11];
+        vm->co = reg[12]; vm->c = reg[13]; vm->g = reg[14]; vm->l = reg[15];
+        if (left < 0) return MAXRUN;
+        vm->scrounge = END;
+        return MAXRUN - left;
+}
+
+long
+runtcall(struct myth_vm *vm)
+{
+        long n;
+
+        for (n=0; n<MAXRUN; ) {
+                n += tcall_run(vm, MAXRUN - n);
+                if (vm->scrounge == END) break;
+        }
+        return n;
+}
+
+long (*engine[NENGINE])(struct myth_vm*) = { runstep, runvtable, runtcall };
+
+
+int
+samestate(struct myth_vm *a, struct myth_vm *b)
+{
+        return !memcmp(a->ram, b->ram, sizeof a->ram)
+            && a->e_new == b->e_new && a->sclk == b->sclk
+            && a->mosi == b->mosi && a->sir == b->sir && a->sor == b->sor
+            && a->por == b->por && a->r == b->r && a->o == b->o
+            && a->i == b->i && a->pc == b->pc && a->co == b->co
+            && a->c == b->c && a->g == b->g && a->l == b->l;
+}
+
+
+void
+main(int argc, char *argv[])
+{
+        static struct myth_vm ref;
+        long target, total, once;
+        vlong t0, t1;
+        int e;
+
+        target = 50*1000*1000L;
+        if (argc > 2 && !strcmp(argv[1], "-n")) {
+                target = atol(argv[2]);
+                argc -= 2;
+                argv += 2;
+        }
+        load("corestate.myst");
+        setargs(argc-1, argv+1);
+
+        for (e=0; e<NENGINE; e++) {
+                vm = start;
+                once = engine[e](&vm);
+                if (e == STEP) ref = vm;
+                else if (!samestate(&vm, &ref))
+                        print("%s: final state differs from myth.h\n", engname[e]);
+
+                total = 0;
+                t0 = nsec();
+                do {
+                        vm = start;
+                        total += engine[e](&vm);
+                } while (total < target);
+                t1 = nsec();
+                print("%-9s %ld instr/run, %ld instr in %lld ms, %.1f MIPS\n",
+                        engname[e], once, total, (t1-t0)/1000000,
+                        total * 1000.0 / (t1-t0));
+        }
+        exits(nil);
+}
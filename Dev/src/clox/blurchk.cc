@@ -0,0 +1,164 @@
+/*
+    Exhaustive check of an ALU look-up ROM image (blur3.obj, see
+    Prototype/blurgen.c) against the ALU of myth.h (LOX) and of the
+    revs.hpp models of the Verilog revision (mythlib.c) and of the
+    Abuladdin prototype (sonne_run.c). All 16 x 256 x 256 entries.
+    The C emulators themselves are not linked in, so a row only
+    vouches for them as far as revs.hpp follows them.
+
+    ROM address: op<<16 | b<<8 | a, with a the first operand
+    (LOX R, Verilog and Abuladdin A), b the second (O, B).
+    Each emulator computes a 256 byte row per op and b with its
+    own ALU opcode handler, inlined into a loop the compiler can
+    vectorise, rows are compared with memcmp.
+
+    LOX op 0 is CLR where the ROM has IDA, which is reported
+    but not counted as an error.
+
+    Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+    Build using:
+    c++ -std=c++17 -O2 -I$PLAN9/include blurchk.cc -L$PLAN9/lib -l9
+
+    Run:
+    ./a.out [rom]
+*/
+
+#include "revs.hpp"
+
+#define BLURSIZE (16*256*256)
+
+struct LoxAlu
+{
+        static constexpr const char *name = "myth.h";
+        static constexpr uint known = 1<<CLR; /*Ops that differ by design*/
+
+        template<int Op>
+        static void
+        row(uchar *out, uchar b)
+        {
+                static myth::Vm vm;
+                uchar *code = vm.ram[0];
+                uchar pc = 0, r, o = b;
+                long n = 1;
+
+                for (int a=0; a<256; a++) {
+                        r = a;
+                        myth::Handler<0x10|Op>::exec(&vm, &code, &pc, &r, &o, &n);
+                        out[a] = r;
+                }
+        }
+};
+
+struct VerilogAlu
+{
+        static constexpr const char *name = "revs.hpp Verilog";
+        static constexpr uint known = 0;
+
+        template<int Op>
+        static void
+        row(uchar *out, uchar b)
+        {
+                static myth::VerilogVm vm;
+                myth::Verilog::Live x(vm);
+                long n = 1;
+
+                vm.reg_B = b;
+                for (int a=0; a<256; a++) {
+                        vm.reg_A = a;
+                        myth::Verilog::exec<0x10|Op>(vm, x, n);
+                        out[a] = vm.reg_R;
+                }
+        }
+};
+
+struct AbuladdinAlu
+{
+        static constexpr const char *name = "revs.hpp Abuladdin";
+        static constexpr uint known = 0;
+
+        template<int Op>
+        static void
+        row(uchar *out, uchar b) /*FR: alu_result() into R*/
+        {
+                static myth::AbuladdinVm vm;
+                myth::Abuladdin::Live x(vm);
+                long n = 1;
+
+                vm.alu_op = Op;
+                vm.bacc = b;
+                for (int a=0; a<256; a++) {
+                        vm.aacc = a;
+                        vm.alu_lock = 0;
+                        myth::Abuladdin::exec<0x71>(vm, x, n);
+                        out[a] = vm.rreg;
+                }
+        }
+};
+
+
+/* Mismatching entries per op, bit set in *bad for unexpected ones
+*/
+
+template<class A, int Op = 0>
+void
+check(uchar *rom, long *diff, uint *bad)
+{
+        uchar row[256];
+        uchar *want;
+        int b, a;
+
+        if constexpr (Op < 16) {
+                diff[Op] = 0;
+                for (b=0; b<256; b++) {
+                        A::template row<Op>(row, b);
+                        want = rom + (Op<<16 | b<<8);
+                        if (memcmp(row, want, 256) == 0) continue;
+                        for (a=0; a<256; a++)
+                                diff[Op] += row[a] != want[a];
+                }
+                if (diff[Op] && !(A::known & 1<<Op)) *bad |= 1<<Op;
+                check<A, Op+1>(rom, diff, bad);
+        }
+}
+
+template<class A>
+int
+verify(uchar *rom)
+{
+        long diff[16];
+        uint bad = 0;
+        int op;
+        vlong t0, t1;
+
+        t0 = nsec();
+        check<A>(rom, diff, &bad);
+        t1 = nsec();
+        print("%-18s %s  %lld us\n", A::name, bad ? "FAIL" : "ok", (t1-t0)/1000);
+        for (op=0; op<16; op++)
+                if (diff[op])
+                        print("  op %2d: %ld entries differ%s\n", op, diff[op],
+                                bad & 1<<op ? "" : " (by design)");
+        return bad != 0;
+}
+
+
+void
+main(int argc, char *argv[])
+{
+        static uchar rom[BLURSIZE];
+        char *fname;
+        int fdesc, fail;
+
+        fname = argc > 1 ? argv[1] : (char*) "blur3.obj";
+        fdesc = open(fname, OREAD);
+        if (fdesc == -1) sysfatal((char*) "cannot open ROM image");
+        if (readn(fdesc, rom, BLURSIZE) != BLURSIZE) sysfatal((char*) "short ROM image");
+        close(fdesc);
+
+        fail = verify<LoxAlu>(rom);
+        fail |= verify<VerilogAlu>(rom);
+        fail |= verify<AbuladdinAlu>(rom);
+        if (fail) exits((char*) "mismatch");
+        exits(0);
+}
@@ -8,28 +8,102 @@
 
 #include <u.h>
 #include <libc.h>
+#include <sys/mman.h>
 #include "myth.h"
+#include "lox.h"
 
 extern struct myth_vm vm;
+extern long cycles; /*Run loop instruction counter*/
 
-static uchar lnybble_old, lnybble_new, hnybble_old, hnybble_new;
+/* SMem is a 16MB ramdisk mapped from a sparse host file,
+   so only blocks actually written occupy disk space.
+   Writes mark 4KB blocks dirty, smem_sync() flushes only those.
+*/
+
+#define SMEMSIZE (256*256*256)
+#define SMEMBLKSHIFT 12 /*4KB dirty tracking blocks*/
+#define SMEMNBLKS (SMEMSIZE >> SMEMBLKSHIFT)
 
 struct SMem {
-        uchar data[256*256*256]; /*16MB*/
+        uchar *data; /*16MB, mapped by smem_open()*/
+        uchar dirty[SMEMNBLKS/8]; /*One bit per block*/
         uchar a0, /*Address select bits 0-7*/
               a1, /*Address select bits 8-15*/
               a2; /*Address select bits 16-23*/
+        uchar mode; /*Mode latch, see SMEM_AUTOINC*/
 };
 
+#define SMEM_AUTOINC 1 /*Data strobes advance the 24-bit address*/
+
 struct SMem smem;
 
 uchar bus; /*Byte value on parallel bus, assume pull-down*/
 
 
+/* Map the ramdisk file 'fname', creating it if necessary.
+   Without a file name the ramdisk is anonymous and volatile.
+   Returns 1 if the file was created, 0 if it existed, -1 on error.
+*/
+int
+smem_open(char *fname)
+{
+        int fdesc, created;
+        Dir d;
+
+        created = 0;
+        memset(smem.dirty, 0, sizeof smem.dirty);
+        if (fname == nil) {
+                smem.data = mmap(nil, SMEMSIZE, PROT_READ|PROT_WRITE,
+                                MAP_PRIVATE|MAP_ANON, -1, 0);
+                return smem.data == MAP_FAILED ? -1 : 0;
+        }
+
+        fdesc = open(fname, ORDWR);
+        if (fdesc == -1) {
+                fdesc = create(fname, ORDWR, 0666);
+                if (fdesc == -1) return -1;
+                created = 1;
+        }
+
+        /*Extend without allocating, holes read as zero*/
+        nulldir(&d);
+        d.length = SMEMSIZE;
+        if (dirfwstat(fdesc, &d) < 0) {
+                close(fdesc);
+                return -1;
+        }
+
+        smem.data = mmap(nil, SMEMSIZE, PROT_READ|PROT_WRITE,
+                        MAP_SHARED, fdesc, 0);
+        close(fdesc);
+        return smem.data == MAP_FAILED ? -1 : created;
+}
+
+/* Write back the dirty blocks, coalescing adjacent ones
+*/
+void
+smem_sync(void)
+{
+        long blk, run;
+
+        for (blk=0; blk<SMEMNBLKS; blk++) {
+                for (run=blk; run<SMEMNBLKS
+                     && smem.dirty[run>>3] & 1<<(run&7); run++)
+                        ;
+                if (run > blk)
+                        msync(smem.data + (blk << SMEMBLKSHIFT),
+                              (run - blk) << SMEMBLKSHIFT, MS_SYNC);
+                blk = run;
+        }
+        memset(smem.dirty, 0, sizeof smem.dirty);
+}
+
+
 uchar
 get_smemdata()
 {
     long addr = (smem.a2 << 16) + (smem.a1 << 8) + smem.a0;
+    if (smem.data == nil) return 0; /*Not mapped yet, lox -s and -r*/
     return smem.data[addr];
 }
 
@@ -37,94 +111,218 @@ void
 set_smemdata(uchar byteval)
 {
     long addr = (smem.a2 << 16) + (smem.a1 << 8) + smem.a0;
+    if (smem.data == nil) return;
+    if (smem.data[addr] == byteval) return; /*Keep block clean*/
     smem.data[addr] = byteval;
+    smem.dirty[addr >> (SMEMBLKSHIFT+3)] |= 1 << ((addr >> SMEMBLKSHIFT) & 7);
 }
 
+void
+smem_advance(void) /*Burst mode address counter*/
+{
+        if (!(smem.mode & SMEM_AUTOINC)) return;
+        if (++smem.a0) return;
+        if (++smem.a1) return;
+        ++smem.a2;
+}
+
+
+/* Cycle counter and countdown timer, derived from the run loop's
+   instruction counter when accessed, so they cost nothing per step.
+   A CYCLE latch strobe snapshots both and restarts the byte readers,
+   each CYCOE/TIMOE strobe then drives the next byte, LSB first.
+   Each TIMLE strobe shifts the bus into the 24-bit reload value
+   (high byte first) and restarts the countdown from it, so a load
+   takes three strobes: fewer keep bytes of the value before.
+   Both count instructions, not board clocks. An instruction takes
+   three clocks (wcet.c, myth.hpp ThreePhase), scale by 3 for those.
+*/
+
+struct Timer {
+        ulong cycsnap; /*32-bit counter snapshot*/
+        ulong timsnap; /*Remaining cycles snapshot, zero when expired*/
+        ulong reload;
+        long deadline;
+        uchar cycidx, timidx;
+};
+
+struct Timer timer;
+
+uchar
+timer_byte(ulong val, uchar *idx)
+{
+        uchar b = val >> (8 * (*idx & 3));
+        *idx = (*idx + 1) & 3;
+        return b;
+}
+
+
+/* Device registry for the E register select lines.
+   Each of SL1-15 and SH1-15 can hold one device, slot 0 is
+   the null device. The core calls edispatch() through vm->eio
+   on every write to E, so steps without I/O cost nothing.
+
+   enable:  device selected (rising edge)
+   disable: device deselected (falling edge)
+   active:  E rewritten while device stays selected
+   Any callback may be nil.
+*/
+
+struct device {
+        char *name;
+        void (*enable)(struct myth_vm*, struct device*);
+        void (*disable)(struct myth_vm*, struct device*);
+        void (*active)(struct myth_vm*, struct device*);
+        void *priv; /*Device private state*/
+};
+
+struct device *sldev[16];
+struct device *shdev[16];
+
+#define DEVCALL(d, fn) if ((d) && (d)->fn) (d)->fn(vm, (d))
 
 void
-SL_enable(uchar id)
+edispatch(struct myth_vm *vm)
 {
-        switch(id){
-                case SL0_NULL:;
-                case SL1_PAROE: bus = vm.por; break;
-                case SL2_SMEMOE: bus = get_smemdata(); break;
-                case SL3_SMEMWE: set_smemdata(bus); break;
-                default:;
+        uchar lold = vm->e_old & 0xF, lnew = vm->e_new & 0xF;
+        uchar hold = vm->e_old >> 4, hnew = vm->e_new >> 4;
+
+        /*SL before SH, so one E write can drive and latch the bus*/
+        if (lnew != lold){
+                DEVCALL(sldev[lold], disable);
+                DEVCALL(sldev[lnew], enable);
         }
+        else DEVCALL(sldev[lnew], active);
+
+        if (hnew != hold){
+                DEVCALL(shdev[hold], disable);
+                DEVCALL(shdev[hnew], enable);
+        }
+        else DEVCALL(shdev[hnew], active);
 }
 
+/* Attach device at its select value as written to E,
+   i.e. SLx_... for the low nybble, SHx_... for the high nybble
+*/
 void
-SL_disable(uchar id)
+devattach(uchar sel, struct device *d)
 {
-        switch(id){
-                case SL1_PAROE: bus = 0; /*Tri-state pull-down*/
-                default:;
-        }
+        if (sel & 0xF0) shdev[sel >> 4] = d;
+        else if (sel) sldev[sel] = d;
 }
 
 
+/* Built-in devices
+*/
+
 void
-SH_enable(uchar id)
+paroe_enable(struct myth_vm *vm, struct device *d)
 {
-        switch(id){
-                case SH0_NULL:;
-                case SH1_PARLE: vm.pir = bus;             break;
-                case SH2_SMEMA0LE: smem.a0 = bus; break;
-                case SH3_SMEMA1LE: smem.a1 = bus; break;
-                case SH4_SMEMA2LE: smem.a2 = bus; break;
-                default:;
-        }
+        bus = vm->por;
 }
 
+void
+paroe_active(struct myth_vm *vm, struct device *d) /*Follow POR while selected*/
+{
+        bus = vm->por;
+}
 
 void
-SH_disable(uchar id)
+paroe_disable(struct myth_vm *vm, struct device *d)
 {
-        switch(id){
-                default:;
-        }
+        bus = 0; /*Tri-state pull-down*/
 }
 
 void
-SL_active(uchar id)
+parle_enable(struct myth_vm *vm, struct device *d)
 {
-        switch(id){
-                default:;
-        }
+        vm->pir = bus;
 }
 
 void
-SH_active(uchar id)
+smemoe_enable(struct myth_vm *vm, struct device *d)
 {
-        switch(id){
-                default:;
-        }
+        bus = get_smemdata();
+        smem_advance();
 }
 
 void
-virtualio() /*Run this after each CPU step for device emulation*/
+smemwe_enable(struct myth_vm *vm, struct device *d)
 {
-        /*Handle virtual IO operation*/
-        
-        lnybble_old = vm.e_old & 0xF;
-        lnybble_new = vm.e_new & 0xF;
-        hnybble_old = (vm.e_old >> 4) & 0xF;
-        hnybble_new = (vm.e_new >> 4) & 0xF;
+        set_smemdata(bus);
+        smem_advance();
+}
 
-        /*SL device selection changed*/
-        if (lnybble_new != lnybble_old){
-                SL_disable(lnybble_old); // falling edge
-                SL_enable(lnybble_new); // rising edge
-        } /*When level triggered*/
-        else
-        if (lnybble_new) SL_active(lnybble_new);
+void
+latch_enable(struct myth_vm *vm, struct device *d) /*Latch bus into *priv*/
+{
+        *(uchar*)d->priv = bus;
+}
 
-        /*SH device selection changed*/
-        if (hnybble_new != hnybble_old){
-                SH_disable(hnybble_old); // falling edge
-                SH_enable(hnybble_new); // rising edge
-        } /*When level triggered*/
-        if (hnybble_new) SH_active(hnybble_new);
+void
+cycle_enable(struct myth_vm *vm, struct device *d)
+{
+        timer.cycsnap = cycles;
+        timer.timsnap = timer.deadline > cycles ? timer.deadline - cycles : 0;
+        timer.cycidx = timer.timidx = 0;
+}
+
+void
+cycoe_enable(struct myth_vm *vm, struct device *d)
+{
+        bus = timer_byte(timer.cycsnap, &timer.cycidx);
+}
+
+void
+timoe_enable(struct myth_vm *vm, struct device *d)
+{
+        bus = timer_byte(timer.timsnap, &timer.timidx);
+}
+
+void
+timle_enable(struct myth_vm *vm, struct device *d)
+{
+        timer.reload = ((timer.reload << 8) | bus) & 0xFFFFFF;
+        timer.deadline = cycles + timer.reload;
+}
+
+/* The PAR latch is transparent: it also follows the bus when
+   E is rewritten while it stays selected, as does PAROE with POR.
+   SL3_SMEMWE shares the low nybble with SL1_PAROE and therefore
+   never sees CPU data; SH5_SMEMWE is the write strobe for that.
+*/
+
+struct device paroe = {"paroe", paroe_enable, paroe_disable, paroe_active, nil};
+struct device parle = {"parle", parle_enable, nil, parle_enable, nil};
+struct device smemoe = {"smemoe", smemoe_enable, nil, nil, &smem};
+struct device smemwe = {"smemwe", smemwe_enable, nil, nil, &smem};
+struct device smemwr = {"smemwr", smemwe_enable, nil, nil, &smem};
+struct device smemmode = {"smemmode", latch_enable, nil, nil, &smem.mode};
+struct device cycle = {"cycle", cycle_enable, nil, nil, &timer};
+struct device cycoe = {"cycoe", cycoe_enable, nil, nil, &timer};
+struct device timoe = {"timoe", timoe_enable, nil, nil, &timer};
+struct device timle = {"timle", timle_enable, nil, nil, &timer};
+struct device smema0le = {"smema0le", latch_enable, nil, nil, &smem.a0};
+struct device smema1le = {"smema1le", latch_enable, nil, nil, &smem.a1};
+struct device smema2le = {"smema2le", latch_enable, nil, nil, &smem.a2};
+
+void
+ioinit(struct myth_vm *vm) /*Attach LOX devices, see lox.h*/
+{
+        devattach(SL1_PAROE, &paroe);
+        devattach(SL2_SMEMOE, &smemoe);
+        devattach(SL3_SMEMWE, &smemwe);
+        devattach(SH1_PARLE, &parle);
+        devattach(SH2_SMEMA0LE, &smema0le);
+        devattach(SH3_SMEMA1LE, &smema1le);
+        devattach(SH4_SMEMA2LE, &smema2le);
+        devattach(SH5_SMEMWE, &smemwr);
+        devattach(SH6_SMEMMODE, &smemmode);
+        devattach(SL6_CYCOE, &cycoe);
+        devattach(SL7_TIMOE, &timoe);
+        devattach(SH7_CYCLE, &cycle);
+        devattach(SH8_TIMLE, &timle);
+        vm->eio = edispatch;
 }
 
 
@@ -0,0 +1,454 @@
+#ifndef __LASM_HPP__
+#define __LASM_HPP__ 1
+
+/* In-process LOX assembler for Sonne 8 micro-controller Rev. Myth/LOX
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+   myth::assemble() does what goldie.go does, from a string into a
+   myth::Program instead of from a file into corestate.myst, and
+   myth::load() puts a Program into a machine as lox would load
+   that image. Tests can assemble and run any number of programs
+   in one process, with no files in between.
+
+   The object code is the same byte for byte, the two passes and
+   the quirks included: a word that is nothing else assembles to
+   0 (with a warning), <label searches the whole page from the
+   current offset downwards and wraps around, constants keep their
+   first definition and the last line of the source is ignored
+   unless the source ends with a newline. Pass 2 takes up each
+   P[...] where pass 1 left it, as goldie does. Where goldie panics or
+   hangs, assemble() returns -1 (Program::err) or goes on with
+   the next kind of word.
+
+   Program keeps the symbol table: page labels, offset labels per
+   page and constants. sym() looks up "Page", "Page.Offs" or a
+   constant. A Program is large, keep it static or on the heap.
+*/
+
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "myth.hpp"
+#include "optab.h"
+
+namespace myth {
+
+struct Program
+{
+        uchar ram[256][256];
+        uchar lid[256]; /*Bytes assembled into each page, as lox_debug.txt*/
+        int line[256][256]; /*Source line of each object byte, 0 if none*/
+        std::string page[256]; /*Page labels*/
+        std::map<int, std::string> offs[256]; /*Offset labels per page*/
+        std::vector<std::pair<std::string, uchar>> consts; /*In source order*/
+        std::vector<std::string> warn; /*As goldie prints them*/
+        std::string err;
+        int errline;
+
+        /* page<<8 for "Page", page<<8 | offset for "Page.Offs",
+           the value of a constant, -1 if undefined */
+        long
+        sym(const std::string &name) const
+        {
+                std::string::size_type dot = name.find('.');
+                int j;
+
+                for (auto &c : consts)
+                        if (c.first == name) return c.second;
+                for (j=0; j<256; j++) {
+                        if (page[j] != name.substr(0, dot)) continue;
+                        if (dot == std::string::npos) return j << 8;
+                        for (auto &o : offs[j])
+                                if (o.second == name.substr(dot+1)) return j << 8 | o.first;
+                }
+                return -1;
+        }
+};
+
+namespace lasm {
+
+typedef std::unordered_map<std::string, uchar> Symtab;
+
+/* Number and character literals of goldie.go, then the mnemonics
+*/
+inline Symtab
+mksymtab(void)
+{
+        static const char *ctl[][2] = {{"'SP'", "\x20"}, {"'NUL'", "\x00"}, {"'CR'", "\x0D"}, {"'LF'", "\x0A"}};
+        Symtab t;
+        char s[16];
+        int i, k;
+
+        for (i=0; i<256; i++) {
+                t.emplace(std::to_string(i), i);
+                snprint(s, sizeof s, "%.2Xh", i);
+                t.emplace(s, i);
+                for (k=0; k<8; k++) s[k + k/4] = i & 0x80>>k ? '1' : '0';
+                s[4] = '_';
+                s[9] = 'b';
+                s[10] = 0;
+                t.emplace(s, i);
+        }
+        for (i=1; i<=128; i++) t.emplace(std::to_string(-i), -i);
+        for (i=0; i<16; i++) {
+                snprint(s, sizeof s, "%Xh", i);
+                t.emplace(s, i);
+                for (k=0; k<4; k++) s[k] = i & 8>>k ? '1' : '0';
+                s[4] = 'b';
+                s[5] = 0;
+                t.emplace(s, i);
+        }
+        for (i=0x21; i<0x7F; i++) t.emplace(std::string("'") + (char) i + "'", i);
+        for (auto &c : ctl) t.emplace(c[0], c[1][0]);
+        for (i=0; i<256; i++) t.emplace(myth_opname(i), i);
+        return t;
+}
+
+/* Where pass 1 was after a P[...], pass 2 goes on from there
+*/
+struct Unit
+{
+        int line, word;
+        uchar page, offs;
+        bool incomment, instring;
+};
+
+struct Lasm
+{
+        Program &p;
+        const Symtab &symtab;
+        Symtab konst; /*First definition wins*/
+        std::vector<Unit> units;
+        int pass, line, word;
+        uchar page, offs;
+        bool incomment, instring;
+
+        Lasm(Program &prog, const Symtab &t) : p(prog), symtab(t) {}
+
+        int
+        error(const char *msg)
+        {
+                p.err = msg;
+                p.errline = line;
+                return -1;
+        }
+
+        const std::string&
+        olabel(int pg, int k) const
+        {
+                static const std::string none;
+                auto o = p.offs[pg].find(k);
+                return o == p.offs[pg].end() ? none : o->second;
+        }
+
+        void
+        put(uchar b)
+        {
+                if (pass == 2) {
+                        p.ram[page][offs] = b;
+                        p.line[page][offs] = line;
+                }
+                if (offs == 255) page++;
+                else if (pass == 1) p.lid[page]++;
+                offs++;
+        }
+
+        void
+        putstr(const std::string &s)
+        {
+                for (uchar c : s) put(c);
+        }
+
+        /* x[label]value, -1 if the ] is missing */
+        int
+        extract(const std::string &w, std::string &label, bool &hasval, uchar &val)
+        {
+                std::string::size_type i = w.find(']', 2);
+
+                if (i == std::string::npos) return -1;
+                label = w.substr(2, i-2);
+                hasval = i+1 < w.size() && w.back() != '+';
+                val = 0;
+                if (hasval) {
+                        auto s = symtab.find(w.substr(i+1));
+                        if (s != symtab.end()) val = s->second;
+                }
+                return 0;
+        }
+
+        bool
+        comment(const std::string &w)
+        {
+                if (w.find('(') != std::string::npos) {
+                        if (instring || w[0] == '"') return false;
+                        if (w.back() != ')') incomment = true;
+                        return true;
+                }
+                if (w.find(')') != std::string::npos) {
+                        if (instring || w.back() == '"') return false;
+                        incomment = false;
+                        return true;
+                }
+                return incomment;
+        }
+
+        bool
+        offsref(const std::string &w)
+        {
+                std::string::size_type dot;
+                std::string pg, o;
+                int j, k;
+
+                if (w.size() < 2) return false;
+                if (w[0] == '<') {
+                        for (j=0; j<256; j++)
+                                if (olabel(page, (uchar) (offs-j)) == w.substr(1)) {
+                                        put(offs-j);
+                                        return true;
+                                }
+                } else if (w[0] == '>') {
+                        for (k=offs; k<256; k++)
+                                if (olabel(page, k) == w.substr(1)) {
+                                        put(k);
+                                        return true;
+                                }
+                } else if ((dot = w.find('.')) != std::string::npos) {
+                        pg = w.substr(0, dot);
+                        o = w.substr(dot+1, w.find('.', dot+1) - dot-1);
+                        for (j=0; j<256; j++) {
+                                if (p.page[j] != pg) continue;
+                                for (k=0; k<256; k++)
+                                        if (olabel(j, k) == o) {
+                                                put(k);
+                                                return true;
+                                        }
+                        }
+                }
+                return false;
+        }
+
+        /* P[label]value, O[label]value, C[label]value; 1 if it is
+           one, -1 on error */
+        int
+        poc(const std::string &w)
+        {
+                std::string label;
+                bool hasval;
+                uchar val;
+
+                if (w.find("P[") != std::string::npos) {
+                        if (extract(w, label, hasval, val)) return error("Missing ]");
+                        if (hasval) {
+                                page = val;
+                                offs = 0;
+                        } else if (w.back() == '+') {
+                                page++;
+                                offs = 0;
+                        }
+                        p.page[page] = label;
+                        if (pass == 1) units.push_back(Unit{line, word, page, offs, incomment, instring});
+                        return 1;
+                }
+                if (w.find("O[") != std::string::npos) {
+                        if (extract(w, label, hasval, val)) return error("Missing ]");
+                        if (hasval) {
+                                offs = val;
+                                if (pass == 1 && offs > p.lid[page]) p.lid[page] = offs;
+                        }
+                        p.offs[page][offs] = label;
+                        return 1;
+                }
+                if (w.find("C[") != std::string::npos) {
+                        if (extract(w, label, hasval, val)) return error("Missing ]");
+                        if (!hasval) return error("Const has no value");
+                        if (pass == 1) {
+                                konst.emplace(label, val);
+                                p.consts.emplace_back(label, val);
+                        }
+                        return 1;
+                }
+                return 0;
+        }
+
+        bool
+        lookup(const Symtab &t, const std::string &w)
+        {
+                auto s = t.find(w.size() > 1 && w.back() == ',' ? w.substr(0, w.size()-1) : w);
+
+                if (s == t.end()) return false;
+                put(s->second);
+                return true;
+        }
+
+        bool
+        pageref(const std::string &w)
+        {
+                std::string s = w.size() > 1 && w.back() == ',' ? w.substr(0, w.size()-1) : w;
+                int j;
+
+                if (s.empty()) return false;
+                for (j=0; j<256; j++)
+                        if (p.page[j] == s) {
+                                put(j);
+                                return true;
+                        }
+                return false;
+        }
+
+        bool
+        trapcall(const std::string &w)
+        {
+                int j;
+
+                if (w.empty() || w[0] != '*') return false;
+                for (j=0; j<32; j++)
+                        if (p.page[j] == w.substr(1)) {
+                                put(0x20 | j);
+                                return true;
+                        }
+                return false;
+        }
+
+        /* 1 if part of a string literal, -1 on error */
+        int
+        strlit(const std::string &w)
+        {
+                if (!w.empty() && w[0] == '"' && !instring) {
+                        if (incomment) return 0;
+                        if (w.size() == 1) return error("Single double quote");
+                        instring = w.back() != '"';
+                        putstr(w.substr(1, w.size() - (instring ? 1 : 2)));
+                        return 1;
+                }
+                if (!w.empty() && w.back() == '"' && instring) {
+                        if (incomment) return 0;
+                        instring = false;
+                        if (w.size() > 1) putstr(" " + w.substr(0, w.size()-1));
+                        return 1;
+                }
+                if (instring) {
+                        putstr(" " + w);
+                        return 1;
+                }
+                return 0;
+        }
+
+        /* Pass 2 skips the P[...] of each unit and takes the
+           state pass 1 left it in, as goldie.go assembles units */
+        int
+        parse(const std::vector<std::vector<std::string>> &src)
+        {
+                std::vector<Unit>::iterator u = units.begin();
+                char msg[128];
+                int r;
+
+                page = offs = 0;
+                incomment = instring = false;
+                for (line=1; line<=(int) src.size(); line++)
+                        for (word=0; word<(int) src[line-1].size(); word++) {
+                                std::string w = src[line-1][word];
+
+                                if (pass == 2 && u != units.end() && u->line == line && u->word == word) {
+                                        page = u->page;
+                                        offs = u->offs;
+                                        incomment = u->incomment;
+                                        instring = u->instring;
+                                        u++;
+                                        continue;
+                                }
+                                if (w[0] == ';') break;
+                                if (w.back() == ',') w.pop_back();
+
+                                if (comment(w) || offsref(w)) continue;
+                                if ((r = poc(w)) || (r = lookup(symtab, w)) || (r = lookup(konst, w))
+                                || (r = pageref(w)) || (r = trapcall(w)) || (r = strlit(w))) {
+                                        if (r < 0) return -1;
+                                        continue;
+                                }
+                                if (pass == 2) {
+                                        snprint(msg, sizeof msg, "Line %d: Using 0 for unknown literal '%s'", line, w.c_str());
+                                        p.warn.push_back(msg);
+                                }
+                                put(0);
+                        }
+                return 0;
+        }
+};
+
+/* Lines as goldie.go reads them: up to each newline, split
+   into words at white space
+*/
+inline std::vector<std::vector<std::string>>
+words(const char *src, long n)
+{
+        std::vector<std::vector<std::string>> lines;
+        std::vector<std::string> w;
+        long i, k;
+
+        for (i=0; i<n; i++) {
+                if (src[i] == '\n') {
+                        lines.push_back(std::move(w));
+                        w.clear();
+                        continue;
+                }
+                if (isspace((uchar) src[i])) continue;
+                for (k=i; k<n && !isspace((uchar) src[k]); k++)
+                        ;
+                w.emplace_back(src+i, k-i);
+                i = k-1;
+        }
+        return lines;
+}
+
+}
+
+
+/* Returns 0, or -1 with Program::err and errline set
+*/
+inline int
+assemble(const char *src, long n, Program &prog)
+{
+        static const lasm::Symtab symtab = lasm::mksymtab();
+        lasm::Lasm a(prog, symtab);
+        auto lines = lasm::words(src, n);
+
+        memset(prog.ram, 0, sizeof prog.ram);
+        memset(prog.lid, 0, sizeof prog.lid);
+        memset(prog.line, 0, sizeof prog.line);
+        for (auto &s : prog.page) s.clear();
+        for (auto &o : prog.offs) o.clear();
+        prog.consts.clear();
+        prog.warn.clear();
+        prog.err.clear();
+        prog.errline = 0;
+
+        a.pass = 1;
+        if (a.parse(lines)) return -1;
+        a.pass = 2;
+        return a.parse(lines);
+}
+
+inline int
+assemble(const std::string &src, Program &prog)
+{
+        return assemble(src.data(), src.size(), prog);
+}
+
+/* Machine state of the image goldie would write: the object code,
+   all registers zero. Device callbacks stay as they are.
+*/
+inline void
+load(Vm &vm, const Program &prog)
+{
+        uchar regs[NREGS];
+
+        memset(regs, 0, sizeof regs);
+        unpackregs(&vm, regs);
+        memcpy(vm.ram, prog.ram, sizeof vm.ram);
+}
+
+}
+
+#endif
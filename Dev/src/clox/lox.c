@@ -29,6 +29,10 @@
 #include "myth.h"
 #include "lox.h"
 #include "io.h"
+#include "spi.h"
+#include "sd.h"
+#include "myst.h"
+#include "mtrace.h"
 
 
 void load( struct myth_vm*, char *);
@@ -40,17 +44,26 @@ void savesmem( char* fname);
 
 struct myth_vm vm;
 char* fname_vm = "corestate.myst";
+long cycles; /*Instructions executed in this run, read by devices*/
 int i,n;
+struct mtrace trace; /*Binary execution trace if tracing*/
+int tracing;
 
 
+uchar imgbuf[MYST_MAXSIZE(256, 256, NREGS)];
+
 void
 save(struct myth_vm *vm, char *fname_vm)
 {   
         int fdesc;
-        create(fname_vm, 0, 0666);
-        fdesc=open(fname_vm, OWRITE);
+        long n;
+        uchar regs[NREGS];
+
+        packregs(vm, regs);
+        n = myst_encode(imgbuf, MYST_LOX, &vm->ram[0][0], 256, 256, regs, NREGS);
+        fdesc=create(fname_vm, OWRITE, 0666);
         if (fdesc != -1) {
-             write(fdesc, vm, sizeof(struct myth_vm));
+             write(fdesc, imgbuf, n);
              close(fdesc);
         }
         else print("Write error\n");
@@ -59,40 +72,49 @@ save(struct myth_vm *vm, char *fname_vm)
 void
 load(struct myth_vm *vm, char *fname_vm)
 {
-        int fdesc;
+        int fdesc, err;
+        long n;
+        uchar regs[NREGS];
+
         fdesc=open(fname_vm, OREAD);
-        if(fdesc != -1) {
-                read(fdesc, vm, sizeof(struct myth_vm));
-                close(fdesc);
+        if(fdesc == -1) {
+                save(vm, "corestate.myst");
+                return;
+        }
+        n = readn(fdesc, imgbuf, sizeof imgbuf);
+        close(fdesc);
+
+        /*Raw struct dump written by earlier versions*/
+        if (n == sizeof vm->ram + NREGS && !myst_ismagic(imgbuf, n)) {
+                memmove(vm->ram, imgbuf, sizeof vm->ram);
+                unpackregs(vm, imgbuf + sizeof vm->ram);
+                return;
         }
-        else save(vm, "corestate.myst");
+
+        err = myst_decode(imgbuf, n, MYST_LOX, &vm->ram[0][0], 256, 256, regs, NREGS);
+        if (err) {
+                print("Image '%s' unusable (myst error %d)\n", fname_vm, err);
+                exits("Bad image");
+        }
+        unpackregs(vm, regs);
 }
 
 void
 savesmem(char* fname)
 {
-        int fdesc;
-        create(fname, 0, 0666);
-        fdesc=open(fname, OWRITE);
-        if (fdesc != -1) {
-             write(fdesc, smem.data, sizeof(smem.data));
-             close(fdesc);
-       }
-        else print("Write error\n");
+        USED(fname);
+        smem_sync();
 }
 
 void
 loadsmem(char* fname)
 {
-        int fdesc;
-        fdesc=open(fname, OREAD);
-        if(fdesc != -1) {
-                read(fdesc, smem.data, sizeof(smem.data));
-                close(fdesc);
-        }
-        else {
-                print("Created LOX ramdisk file\n");
-                savesmem("ramdisk.myth");
+        switch(smem_open(fname)){
+                case -1:
+                        print("Cannot map LOX ramdisk file %s\n", fname);
+                        exits("ramdisk");
+                case 1:
+                        print("Created LOX ramdisk file\n");
         }
 }
 
@@ -121,7 +143,8 @@ usage()
         print("Usage:\n");
         print("Single step\t-s\n");
         print("Print regs\t-r\n");
-        print("Run with args\t[-f file] <args>\n\n");
+        print("Run with args\t[-f file] <args>\n");
+        print("Trace a run\t-t trace [-f file] <args>\n\n");
         exits("Show usage completed");
 }
 
@@ -129,6 +152,7 @@ void
 singlestep()
 {
         //myth_reset(&vm);
+        vm.spibyte = nil; /*One instruction per step*/
         myth_step(&vm);
         save(&vm, fname_vm);
         //print("myth\n");
@@ -157,6 +181,12 @@ printregs()
         print( "pir:%.02Xh(%d)(%b) ", vm.pir, vm.pir, vm.pir);
         print( "por:%.02Xh(%d)(%b)\n", vm.por, vm.por, vm.por);
 
+        n = vm.ram[vm.c][vm.pc];
+        print( "Next @%.02X.%.02X: %s", vm.c, vm.pc, myth_opname(n));
+        if (myth_oplen(n) == 2)
+                print( " %.02Xh", vm.ram[vm.c][(uchar)(vm.pc+1)]);
+        print( "\n");
+
         print( "Locals @l%.02X: ", vm.l);
         for( i=0; i<8; i++){
                 n = vm.ram[vm.l][GIRO_BASE_OFFSET +i];
@@ -171,7 +201,7 @@ printregs()
 void
 main(int argc, char *argv[])
 {
-        int cyc;
+        int n;
         int offs, chpos;
         char ch;
         int withfile;
@@ -179,7 +209,20 @@ main(int argc, char *argv[])
         withfile = 0;
         if (argc==1) usage();
 
+        if (argc>3 && !strcmp("-t", argv[1])){
+                if (mtopen(&trace, argv[2])){
+                        print("Cannot create trace file %s\n", argv[2]);
+                        exits("trace");
+                }
+                tracing = 1;
+                argc -= 2;
+                argv += 2;
+        }
+
         load(&vm, fname_vm);
+        ioinit(&vm);
+        spiinit(&vm);
+        sdinit(&vm);
         if (argc==2 && !strcmp("-s", argv[1])) singlestep();
         if (argc==2 && !strcmp("-r", argv[1])) printregs();
         if (!strcmp("-f", argv[1])){
@@ -193,6 +236,7 @@ main(int argc, char *argv[])
                         usage();
                 }
         }
+        else loadsmem(nil); /*Scratch ramdisk*/
 
         /* Clear LOX arg buffer, output text buffer and return code
         */
@@ -215,20 +259,20 @@ main(int argc, char *argv[])
         /* Cycle until VM executes END,
            given max. number of cycles
         */
-        for( cyc=1; cyc<999*1000; cyc++){
+        for( cycles=1; cycles<999*1000; cycles+=n){
 
-                myth_step( &vm);
+                n = tracing ? mtstep(&trace, &vm, cycles) : myth_step( &vm);
                 if (vm.scrounge == END) break;
-                else virtualio();
         }
+        if (tracing) mtclose(&trace);
 
-        if( cyc==999*1000) {
+        if( cycles>=999*1000) {
                  print( "Error:\n");
                  print( "999k cycles elapsed without END (re-run?)\n!\n");
                  exits( "Elapsed");
         }
         else{
-                print("END after %d cycles: ", cyc);
+                print("END after %ld cycles: ", cycles);
 
                 /* Reset Program Counter for next run
                    Reset pointers to arg buffer and output text buffer
@@ -254,6 +298,8 @@ main(int argc, char *argv[])
 
         print("\n");
         save(&vm, fname_vm);
+        eesave();
+        sdclose();
         if (withfile) savesmem(argv[2]);
         exits("Run completed");
 }
@@ -39,11 +39,48 @@
 #define SL1_PAROE     1    /* CPU parallel port output enable */
 #define SL2_SMEMOE    2    /* SMEM data byte output enable */
 #define SL3_SMEMWE    3    /* SMEM data byte write enable */
+#define SL4_EECS      4    /* 25LC EEPROM chip select (SPI) */
+#define SL5_SDCS      5    /* SD card chip select (SPI) */
+#define SL6_CYCOE     6    /* Cycle counter snapshot byte output enable */
+#define SL7_TIMOE     7    /* Timer remaining cycles byte output enable */
 
 #define SH0_NULL      0    /* NULL device for SH */        
 #define SH1_PARLE     1<<4 /* CPU parallel port latch enable */
 #define SH2_SMEMA0LE  2<<4 /* SMEM address bit latch 0-7 */
 #define SH3_SMEMA1LE  3<<4 /* SMEM address bit latch 8-15 */
 #define SH4_SMEMA2LE  4<<4 /* SMEM address bit latch 16-23 */
+#define SH5_SMEMWE    5<<4 /* SMEM data byte write strobe, from bus */
+#define SH6_SMEMMODE  6<<4 /* SMEM mode latch, bit 0 auto-increment */
+#define SH7_CYCLE     7<<4 /* Snapshot cycle counter and timer */
+#define SH8_TIMLE     8<<4 /* Timer reload byte latch, starts countdown */
+
+
+/* Register block order in .myst images, see myst.h
+*/
+#define NREGS 18
+
+void
+packregs(struct myth_vm *vm, uchar *regs)
+{
+        regs[0] = vm->e_old; regs[1] = vm->e_new;
+        regs[2] = vm->sclk; regs[3] = vm->miso; regs[4] = vm->mosi;
+        regs[5] = vm->sir; regs[6] = vm->sor;
+        regs[7] = vm->pir; regs[8] = vm->por;
+        regs[9] = vm->r; regs[10] = vm->o; regs[11] = vm->i; regs[12] = vm->pc;
+        regs[13] = vm->co; regs[14] = vm->c; regs[15] = vm->g; regs[16] = vm->l;
+        regs[17] = vm->scrounge;
+}
+
+void
+unpackregs(struct myth_vm *vm, uchar *regs)
+{
+        vm->e_old = regs[0]; vm->e_new = regs[1];
+        vm->sclk = regs[2]; vm->miso = regs[3]; vm->mosi = regs[4];
+        vm->sir = regs[5]; vm->sor = regs[6];
+        vm->pir = regs[7]; vm->por = regs[8];
+        vm->r = regs[9]; vm->o = regs[10]; vm->i = regs[11]; vm->pc = regs[12];
+        vm->co = regs[13]; vm->c = regs[14]; vm->g = regs[15]; vm->l = regs[16];
+        vm->scrounge = regs[17];
+}
 
 #endif
@@ -0,0 +1,156 @@
+/*
+    Runs a machine image of any Sonne 8 revision on the
+    engines of myth.hpp and revs.hpp, then saves it back.
+
+    .myst images name their machine, raw images need -a
+    (Abuladdin "daffodil" memory dump) or -v (Verilog sasm dump).
+    A .myst image is saved in place, a raw one to name.myst
+    beside it, so that the raw loaders can still read the input.
+    Runs until the revision halts (LOX END, Verilog NOP or P
+    write, Abuladdin HALT) or the budget is spent.
+    Verilog images start from warm reset as in mythlib.c.
+    A .asm file is LOX source: it is assembled in process
+    (lasm.hpp) and the machine saved to corestate.myst, as
+    goldie followed by lox would.
+
+    Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+    Build using:
+    c++ -std=c++17 -O2 -I$PLAN9/include mrun.cc -L$PLAN9/lib -l9
+
+    Run:
+    ./a.out [-a|-v] [-n instructions] [-p top] [-t] image|source.asm
+*/
+
+#include <type_traits>
+
+#include "revs.hpp"
+#include "lasm.hpp"
+
+enum { PLAIN, PROFILE, TRACE };
+
+long budget[] = {0, 999*1000L, 1000, 65535}; /*Per MYST_ machine, as lox, mythlib.c, sonne_run.c*/
+
+
+template<class I, class... P>
+long
+go(typename I::State &vm, long n, int top)
+{
+        static myth::BasicEngine<I, P...> e(vm);
+        long done;
+
+        done = e.runall(n);
+        if constexpr ((std::is_same_v<P, myth::Profile> || ...))
+                e.report(1, top, I::name);
+        return done;
+}
+
+template<class I>
+void
+run(typename I::State &vm, char *fname, long n, int mode, int top)
+{
+        long done;
+
+        I::boot(vm);
+        if (n == 0) n = budget[I::machine];
+
+        switch (mode) {
+        case PLAIN: done = go<I>(vm, n, top); break;
+        case PROFILE: done = go<I, myth::Profile>(vm, n, top); break;
+        default: done = go<I, myth::Trace>(vm, n, top); break;
+        }
+        print("%s after %ld instructions\n", I::halted(vm) ? "Halted" : "Stopped", done);
+        if (myth::savefile<I>(vm, fname))
+                sysfatal((char*) "cannot save %s", fname);
+}
+
+template<class I>
+void
+runimg(uchar *img, long len, char *fname, long n, int mode, int top)
+{
+        static typename I::State vm;
+        int err;
+
+        err = myth::load<I>(vm, img, len);
+        if (err) sysfatal((char*) "unusable image (%d)", err);
+        if (!myst_ismagic(img, len))
+                fname = smprint((char*) "%s.myst", fname);
+        run<I>(vm, fname, n, mode, top);
+}
+
+void
+runasm(int fdesc, long n, int mode, int top)
+{
+        static myth::Program prog;
+        static myth::Vm vm;
+        std::vector<char> src;
+        long len, got;
+
+        for (len=0; ; len+=got) {
+                src.resize(len + 8192);
+                if ((got = read(fdesc, src.data()+len, 8192)) <= 0) break;
+        }
+        if (myth::assemble(src.data(), len, prog))
+                sysfatal((char*) "line %d: %s", prog.errline, prog.err.c_str());
+        for (auto &w : prog.warn) print("%s\n", w.c_str());
+        myth::load(vm, prog);
+        run<myth::Lox>(vm, (char*) "corestate.myst", n, mode, top);
+}
+
+void
+usage(void)
+{
+        print("Usage: mrun [-a|-v] [-n instructions] [-p top] [-t] image|source.asm\n");
+        exits((char*) "usage");
+}
+
+
+void
+main(int argc, char *argv[])
+{
+        static uchar img[MYST_MAXSIZE(256, 256, 32)];
+        int fdesc, machine, mode, top;
+        long len, n;
+        char *dot;
+
+        machine = 0;
+        mode = PLAIN;
+        top = 20;
+        n = 0;
+        for (argc--, argv++; argc > 1 && argv[0][0] == '-'; argc--, argv++) {
+                if (!strcmp(argv[0], "-a")) machine = MYST_ABULADDIN;
+                else if (!strcmp(argv[0], "-v")) machine = MYST_VERILOG;
+                else if (!strcmp(argv[0], "-t")) mode = TRACE;
+                else if (!strcmp(argv[0], "-n") && argc > 2) {
+                        n = atol(argv[1]);
+                        argc--, argv++;
+                }
+                else if (!strcmp(argv[0], "-p") && argc > 2) {
+                        mode = PROFILE;
+                        top = atoi(argv[1]);
+                        argc--, argv++;
+                }
+                else usage();
+        }
+        if (argc != 1) usage();
+
+        fdesc = open(argv[0], OREAD);
+        if (fdesc == -1) sysfatal((char*) "cannot open image");
+        dot = strrchr(argv[0], '.');
+        if (dot && !strcmp(dot, ".asm")) {
+                runasm(fdesc, n, mode, top);
+                close(fdesc);
+                exits(0);
+        }
+        len = readn(fdesc, img, sizeof img);
+        close(fdesc);
+        if (myst_ismagic(img, len) && len > 5) machine = img[5];
+
+        switch (machine) {
+        case MYST_LOX: runimg<myth::Lox>(img, len, argv[0], n, mode, top); break;
+        case MYST_VERILOG: runimg<myth::Verilog>(img, len, argv[0], n, mode, top); break;
+        case MYST_ABULADDIN: runimg<myth::Abuladdin>(img, len, argv[0], n, mode, top); break;
+        default: sysfatal((char*) "unknown machine, use -a or -v for raw images");
+        }
+        exits(0);
+}
@@ -0,0 +1,106 @@
+/*
+    Decodes a binary execution trace written by lox -t (see
+    mtrace.h) into one disassembled line per instruction:
+
+    cycle  C.PC: mnemonic literal  R O I E  delta
+
+    With -n only the last n records are shown, -c counts
+    executions per opcode instead.
+
+    Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+    Build using:
+    9c mtdump.c
+    9l mtdump.o
+
+    Run:
+    ./a.out [-n records] [-c] trace
+*/
+
+#include <u.h>
+#include <libc.h>
+#include <bio.h>
+#include "mtrace.h"
+
+char *regname[NREGS] = {
+        "e_old", "e", "sclk", "miso", "mosi", "sir", "sor", "pir", "por",
+        "r", "o", "i", "pc", "co", "c", "g", "l", "scrounge"
+};
+
+ulong
+cycleof(struct mtrec *rec)
+{
+        return rec->cycle[0] | rec->cycle[1]<<8 | rec->cycle[2]<<16 | (ulong) rec->cycle[3]<<24;
+}
+
+void
+dumprec(Biobuf *out, struct mtrec *rec)
+{
+        Bprint(out, "%10lud  %.2X.%.2X: %-4s", cycleof(rec), rec->c, rec->pc, myth_opname(rec->op));
+        if (myth_oplen(rec->op) == 2) Bprint(out, " %.2X", rec->lit);
+        else Bprint(out, "   ");
+        Bprint(out, "  R:%.2X O:%.2X I:%.2X E:%.2X", rec->r, rec->o, rec->i, rec->e);
+        if (rec->what == MT_MEM)
+                Bprint(out, "  %.2X.%.2X=%.2X", rec->page, rec->offs, rec->val);
+        else if (rec->what < NREGS)
+                Bprint(out, "  %s=%.2X", regname[rec->what], rec->val);
+        Bprint(out, "\n");
+}
+
+void
+usage(void)
+{
+        print("Usage: mtdump [-n records] [-c] trace\n");
+        exits("usage");
+}
+
+
+void
+main(int argc, char *argv[])
+{
+        static struct mtrec buf[MT_CHUNK];
+        static uvlong count[256];
+        uchar hdr[MT_HDRSIZE];
+        Biobuf out;
+        vlong size, nrec, first;
+        long got, k;
+        int fdesc, tally;
+
+        first = 0;
+        tally = 0;
+        for (argc--, argv++; argc > 1 && argv[0][0] == '-'; argc--, argv++) {
+                if (!strcmp(argv[0], "-c")) tally = 1;
+                else if (!strcmp(argv[0], "-n") && argc > 2) {
+                        first = -strtoll(argv[1], nil, 10);
+                        argc--, argv++;
+                }
+                else usage();
+        }
+        if (argc != 1) usage();
+
+        fdesc = open(argv[0], OREAD);
+        if (fdesc == -1) sysfatal("cannot open trace");
+        if (readn(fdesc, hdr, sizeof hdr) != sizeof hdr || memcmp(hdr, MT_MAGIC, 4))
+                sysfatal("not a trace");
+        if (hdr[4] != MT_VERSION || hdr[5] != MYST_LOX || hdr[6] != sizeof(struct mtrec))
+                sysfatal("unsupported trace version %d machine %d", hdr[4], hdr[5]);
+
+        size = seek(fdesc, 0, 2);
+        nrec = (size - MT_HDRSIZE) / sizeof(struct mtrec);
+        if (first < 0) first = nrec + first > 0 ? nrec + first : 0;
+        seek(fdesc, MT_HDRSIZE + first * sizeof(struct mtrec), 0);
+
+        Binit(&out, 1, OWRITE);
+        while ((got = readn(fdesc, buf, sizeof buf) / sizeof(struct mtrec)) > 0)
+                for (k=0; k<got; k++) {
+                        if (tally) count[buf[k].op]++;
+                        else dumprec(&out, &buf[k]);
+                }
+        if (tally)
+                for (k=0; k<256; k++)
+                        if (count[k]) Bprint(&out, "%.2lX %-4s %12llud\n", k, myth_opname(k), count[k]);
+        Bprint(&out, "%lld records\n", nrec - first);
+        Bterm(&out);
+        close(fdesc);
+        exits(nil);
+}
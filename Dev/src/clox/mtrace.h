@@ -0,0 +1,284 @@
+#ifndef __MTRACE_H__
+#define __MTRACE_H__ 1
+
+/* Binary execution trace for Sonne 8 micro-controller Rev. Myth/LOX
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+   mtstep() runs one myth_step() and appends a fixed-size record
+   per instruction retired to an in-memory ring, also for each of
+   a fused SPI byte transfer. A writer thread drains the ring to
+   the trace file in chunks of MT_CHUNK records, so the core only
+   pays for filling in 16 bytes. When the writer falls behind the
+   core waits for it, records are never dropped.
+
+   File: MT_MAGIC, version, machine (MYST_LOX), record size,
+   then the records. Decode with mtdump.c.
+
+   Record: cycle (32 bit little endian) at which the instruction
+   started, C, PC, opcode, literal (next code byte), then R, O, I
+   and E after it, and one delta: the memory byte written (what
+   MT_MEM, page, offs, val) or else the first other register that
+   changed (what = index in the .myst register block, see lox.h,
+   val), MT_NONE if none did.
+   C and PC after the instruction are in the next record.
+*/
+
+#include <u.h>
+#include <libc.h>
+#include <pthread.h>
+#include "myth.h"
+#include "lox.h"
+#include "myst.h"
+
+#define MT_MAGIC "MTRC"
+#define MT_VERSION 1
+#define MT_HDRSIZE 8
+
+#define MT_RING (1<<16) /*Records in the ring, multiple of MT_CHUNK*/
+#define MT_CHUNK 4096 /*Records per write*/
+
+#define MT_MEM 0xFF
+#define MT_NONE 0xFE
+
+/*Registers reported as delta, with their .myst index (see
+  packregs()), the record has the others anyway*/
+#define MT_DELTAS(X) X(15, g) X(16, l) X(13, co) X(6, sor) X(5, sir) \
+        X(8, por) X(7, pir) X(2, sclk) X(4, mosi) X(3, miso)
+
+struct mtrec
+{
+        uchar cycle[4];
+        uchar c, pc, op, lit;
+        uchar r, o, i, e;
+        uchar what, val;
+        uchar page, offs;
+};
+
+struct mtrace
+{
+        struct mtrec ring[MT_RING];
+        ulong head; /*Records filled, core only*/
+        ulong pub; /*Records handed to the writer*/
+        ulong tail; /*Records written*/
+        int done;
+        int fd;
+        pthread_t writer;
+        pthread_mutex_t lk;
+        pthread_cond_t more, room;
+};
+
+
+/* Writer thread: wait for published records, write them out
+   in one or two pieces depending on wrap-around
+*/
+
+void*
+mtwriter(void *arg)
+{
+        struct mtrace *t = arg;
+        ulong from, to, k;
+
+        for (;;) {
+                pthread_mutex_lock(&t->lk);
+                while (t->tail == t->pub && !t->done)
+                        pthread_cond_wait(&t->more, &t->lk);
+                from = t->tail;
+                to = t->pub;
+                pthread_mutex_unlock(&t->lk);
+                if (from == to) return nil; /*Done and drained*/
+
+                while (from != to) {
+                        k = MT_RING - from % MT_RING;
+                        if (k > to - from) k = to - from;
+                        write(t->fd, &t->ring[from % MT_RING], k * sizeof(struct mtrec));
+                        from += k;
+                }
+                pthread_mutex_lock(&t->lk);
+                t->tail = to;
+                pthread_cond_signal(&t->room);
+                pthread_mutex_unlock(&t->lk);
+        }
+}
+
+/* Hand the filled records to the writer, then make sure the
+   next chunk fits into the ring
+*/
+void
+mtpublish(struct mtrace *t)
+{
+        pthread_mutex_lock(&t->lk);
+        t->pub = t->head;
+        pthread_cond_signal(&t->more);
+        while (t->head - t->tail > MT_RING - MT_CHUNK)
+                pthread_cond_wait(&t->room, &t->lk);
+        pthread_mutex_unlock(&t->lk);
+}
+
+int
+mtopen(struct mtrace *t, char *fname)
+{
+        uchar hdr[MT_HDRSIZE] = {'M', 'T', 'R', 'C', MT_VERSION, MYST_LOX, sizeof(struct mtrec), 0};
+
+        t->fd = create(fname, OWRITE, 0666);
+        if (t->fd == -1) return -1;
+        write(t->fd, hdr, sizeof hdr);
+        t->head = t->pub = t->tail = 0;
+        t->done = 0;
+        pthread_mutex_init(&t->lk, nil);
+        pthread_cond_init(&t->more, nil);
+        pthread_cond_init(&t->room, nil);
+        if (pthread_create(&t->writer, nil, mtwriter, t)) {
+                close(t->fd);
+                return -1;
+        }
+        return 0;
+}
+
+void
+mtclose(struct mtrace *t)
+{
+        mtpublish(t);
+        pthread_mutex_lock(&t->lk);
+        t->done = 1;
+        pthread_cond_signal(&t->more);
+        pthread_mutex_unlock(&t->lk);
+        pthread_join(t->writer, nil);
+        close(t->fd);
+}
+
+
+/* Memory byte a LOX opcode stores to, as page<<8 | offset,
+   -1 if none (see writesg()/writesl() in myth.hpp)
+*/
+int
+mtwraddr(struct myth_vm *vm, uchar op)
+{
+        uchar src = op>>4 & 7, dst = op & 15;
+
+        if (op & 0x80) {
+                if (src <= MLx && (dst == xMG || dst == xML)) return -1; /*Scrounge*/
+                if (dst == xMG) return vm->g << 8 | vm->o;
+                if (dst == xML) return vm->l << 8 | vm->o;
+                return -1;
+        }
+        if ((op & 0xC8) == 0x48) return vm->l << 8 | (GIRO_BASE_OFFSET + (op & 7));
+        if (op == OWN) return vm->l << 8 | 0xFF;
+        return -1;
+}
+
+/* The MT_DELTAS registers, to diff before and after
+*/
+
+#define MT_FIELD(k, reg) uchar reg;
+#define MT_SAVE(k, reg) s->reg = vm->reg;
+#define MT_DIFF(k, reg) if (rec->what == MT_NONE && a->reg != b->reg) { rec->what = k; rec->val = b->reg; }
+
+struct mtregs { MT_DELTAS(MT_FIELD) };
+
+void
+mtsave(struct mtregs *s, struct myth_vm *vm)
+{
+        MT_DELTAS(MT_SAVE)
+}
+
+/* First register that differs between a and b, into rec
+*/
+void
+mtdelta(struct mtrec *rec, struct mtregs *a, struct mtregs *b)
+{
+        rec->what = MT_NONE;
+        rec->val = 0;
+        MT_DELTAS(MT_DIFF)
+}
+
+void
+mtput(struct mtrace *t, struct mtrec *rec, ulong cycle)
+{
+        rec->cycle[0] = cycle;
+        rec->cycle[1] = cycle >> 8;
+        rec->cycle[2] = cycle >> 16;
+        rec->cycle[3] = cycle >> 24;
+        t->ring[t->head % MT_RING] = *rec;
+        if (++t->head % MT_CHUNK == 0) mtpublish(t);
+}
+
+/* A fused SPI byte transfer (see spirun() in myth.h) retires
+   SPIRUN instructions in one myth_step(). Each gets its record,
+   replayed from the byte shifted in as spibit() would have
+   clocked it: SSI shifts a bit into SIR, MISO presents the
+   next one after the falling edge.
+*/
+void
+mtspirun(struct mtrace *t, struct mtrec *rec, struct mtregs *s, struct myth_vm *vm, ulong cycle)
+{
+        struct mtregs prev;
+        uchar in = vm->sir;
+        int k;
+
+        for (k=0; k<SPIRUN; k++) {
+                prev = *s;
+                switch (k & 3) {
+                case 0: /*SSO*/
+                        s->mosi = s->sor >> 7;
+                        s->sor <<= 1;
+                        break;
+                case 1: /*SCH*/
+                        s->sclk = 1;
+                        break;
+                case 2: /*SSI*/
+                        s->sir = s->sir << 1 | (in >> (7 - k/4) & 1);
+                        break;
+                case 3: /*SCL*/
+                        s->sclk = 0;
+                        s->miso = k < SPIRUN-1 ? in >> (6 - k/4) & 1 : vm->miso;
+                        break;
+                }
+                rec->op = spiseq[k];
+                rec->lit = vm->ram[rec->c][(uchar) (rec->pc+1)];
+                mtdelta(rec, &prev, s);
+                mtput(t, rec, cycle + k);
+                rec->pc++;
+        }
+}
+
+/* myth_step() with one trace record per instruction retired,
+   returns its result
+*/
+int
+mtstep(struct mtrace *t, struct myth_vm *vm, ulong cycle)
+{
+        struct mtrec rec;
+        struct mtregs before, after;
+        int addr, n;
+
+        mtsave(&before, vm);
+        rec.c = vm->c;
+        rec.pc = vm->pc;
+        rec.op = vm->ram[vm->c][vm->pc];
+        rec.lit = vm->ram[vm->c][(uchar) (vm->pc+1)];
+        addr = mtwraddr(vm, rec.op);
+        rec.page = addr >> 8;
+        rec.offs = addr;
+
+        n = myth_step(vm);
+
+        rec.r = vm->r;
+        rec.o = vm->o;
+        rec.i = vm->i;
+        rec.e = vm->e_new;
+        if (n > 1) {
+                mtspirun(t, &rec, &before, vm, cycle);
+                return n;
+        }
+        if (addr != -1) {
+                rec.what = MT_MEM;
+                rec.val = vm->ram[rec.page][rec.offs];
+        } else {
+                mtsave(&after, vm);
+                mtdelta(&rec, &before, &after);
+        }
+        mtput(t, &rec, cycle);
+        return n;
+}
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef __MYST_H__
+#define __MYST_H__ 1
+
+/* Machine image container (.myst) for Sonne 8 micro-controller
+   emulators and assemblers. Shared by lox, mythlib.c, sasm.c and
+   the engines of myth.hpp, goldie.go carries a Go port of the
+   encoder.
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+   Uses no library calls so that it can be included under
+   both Plan 9 libc and stdio builds.
+
+   Layout (multi-byte fields little-endian):
+
+   0    4  Magic "MYST"
+   4    1  Format version (MYST_VERSION)
+   5    1  Machine id (MYST_LOX etc.)
+   6    2  Page size in bytes
+   8    2  Number of pages
+   10   1  Number of register bytes (n)
+   11   1  Reserved, zero
+   12   n  Register bytes, order defined per machine
+   ..   .  Page presence bitmap, one bit per page, LSB first
+   ..   .  Contents of present (nonzero) pages, ascending
+   ..   4  Adler-32 checksum over all preceding bytes
+*/
+
+#define MYST_VERSION 1
+
+#define MYST_LOX 1       /*Myth/LOX (Dev/src/clox/myth.h)*/
+#define MYST_VERILOG 2   /*Myth Verilog revision (mythlib.c)*/
+#define MYST_ABULADDIN 3 /*Abuladdin prototype (sonne_run.c, revs.hpp)*/
+
+#define MYST_HDRSIZE 12
+
+/*Upper bound for the encoded size of a machine image*/
+#define MYST_MAXSIZE(pgsize, npages, nregs) \
+        (MYST_HDRSIZE + (nregs) + ((npages)+7)/8 + (long)(pgsize)*(npages) + 4)
+
+/*Error codes returned by myst_decode()*/
+#define MYST_EMAGIC -1    /*Not a .myst image*/
+#define MYST_EVERSION -2  /*Unknown format version*/
+#define MYST_EMACHINE -3  /*Image is for another machine*/
+#define MYST_ELAYOUT -4   /*Page geometry or register block mismatch*/
+#define MYST_ETRUNC -5    /*Image shorter than announced*/
+#define MYST_ECHECKSUM -6 /*Checksum mismatch*/
+
+/*Helpers are inline so that units using only some stay warning free*/
+#ifdef __GNUC__
+#define MYST_INLINE static inline
+#else
+#define MYST_INLINE static
+#endif
+
+
+MYST_INLINE unsigned long
+myst_adler32(const unsigned char *p, long n)
+{
+        unsigned long a = 1, b = 0;
+        long chunk;
+
+        while (n > 0) {
+                chunk = n < 5552 ? n : 5552; /*Defer modulo*/
+                n -= chunk;
+                while (chunk--) {
+                        a += *p++;
+                        b += a;
+                }
+                a %= 65521;
+                b %= 65521;
+        }
+        return (b << 16) | a;
+}
+
+MYST_INLINE int
+myst_ismagic(const unsigned char *in, long len)
+{
+        return len >= 4 && in[0]=='M' && in[1]=='Y' && in[2]=='S' && in[3]=='T';
+}
+
+MYST_INLINE int
+myst_pagezero(const unsigned char *pg, int pgsize)
+{
+        int k;
+        for (k=0; k<pgsize; k++)
+                if (pg[k]) return 0;
+        return 1;
+}
+
+
+/* Encode machine state into 'out', which must hold at least
+   MYST_MAXSIZE(pgsize, npages, nregs) bytes.
+   Returns the number of bytes used.
+*/
+
+MYST_INLINE long
+myst_encode(unsigned char *out, int machine,
+            const unsigned char *ram, int pgsize, int npages,
+            const unsigned char *regs, int nregs)
+{
+        long pos, bmp, k;
+        unsigned long sum;
+        int pg;
+
+        out[0]='M'; out[1]='Y'; out[2]='S'; out[3]='T';
+        out[4] = MYST_VERSION;
+        out[5] = machine;
+        out[6] = pgsize & 0xFF; out[7] = pgsize >> 8;
+        out[8] = npages & 0xFF; out[9] = npages >> 8;
+        out[10] = nregs;
+        out[11] = 0;
+        pos = MYST_HDRSIZE;
+
+        for (k=0; k<nregs; k++)
+                out[pos++] = regs[k];
+
+        bmp = pos;
+        for (k=0; k<(npages+7)/8; k++)
+                out[pos++] = 0;
+
+        for (pg=0; pg<npages; pg++) {
+                const unsigned char *src = ram + (long)pg*pgsize;
+                if (myst_pagezero(src, pgsize)) continue;
+                out[bmp + pg/8] |= 1 << (pg&7);
+                for (k=0; k<pgsize; k++)
+                        out[pos++] = src[k];
+        }
+
+        sum = myst_adler32(out, pos);
+        out[pos++] = sum & 0xFF;
+        out[pos++] = (sum >> 8) & 0xFF;
+        out[pos++] = (sum >> 16) & 0xFF;
+        out[pos++] = (sum >> 24) & 0xFF;
+        return pos;
+}
+
+
+/* Decode image 'in' of 'len' bytes into 'ram' and 'regs'.
+   Geometry must match the caller's. Absent pages are cleared.
+   Returns 0, or one of the MYST_E* codes leaving state untouched.
+*/
+
+MYST_INLINE int
+myst_decode(const unsigned char *in, long len, int machine,
+            unsigned char *ram, int pgsize, int npages,
+            unsigned char *regs, int nregs)
+{
+        long pos, bmp, need, k;
+        unsigned long sum;
+        int pg, present;
+
+        if (!myst_ismagic(in, len) || len < MYST_HDRSIZE + 4)
+                return MYST_EMAGIC;
+        if (in[4] != MYST_VERSION) return MYST_EVERSION;
+        if (in[5] != machine) return MYST_EMACHINE;
+        if ((in[6] | in[7]<<8) != pgsize || (in[8] | in[9]<<8) != npages
+            || in[10] != nregs)
+                return MYST_ELAYOUT;
+
+        bmp = MYST_HDRSIZE + nregs;
+        need = bmp + (npages+7)/8 + 4;
+        if (len < need) return MYST_ETRUNC;
+        present = 0;
+        for (pg=0; pg<npages; pg++)
+                if (in[bmp + pg/8] & (1 << (pg&7))) present++;
+        need += (long)present*pgsize;
+        if (len < need) return MYST_ETRUNC;
+
+        sum = (unsigned long) in[need-4] | (unsigned long) in[need-3] << 8
+            | (unsigned long) in[need-2] << 16 | (unsigned long) in[need-1] << 24;
+        if (sum != myst_adler32(in, need-4)) return MYST_ECHECKSUM;
+
+        for (k=0; k<nregs; k++)
+                regs[k] = in[MYST_HDRSIZE + k];
+
+        pos = bmp + (npages+7)/8;
+        for (pg=0; pg<npages; pg++) {
+                unsigned char *dst = ram + (long)pg*pgsize;
+                if (in[bmp + pg/8] & (1 << (pg&7)))
+                        for (k=0; k<pgsize; k++) dst[k] = in[pos++];
+                else
+                        for (k=0; k<pgsize; k++) dst[k] = 0;
+        }
+        return 0;
+}
+
+#endif
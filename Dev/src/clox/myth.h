@@ -37,6 +37,10 @@ struct myth_vm /*Complete machine state including all RAM*/
         uchar l;    /*Local Page Index*/
 
         uchar scrounge; /*Set by VM if scrounge opcode executed, else zero*/
+
+        void (*eio)(struct myth_vm*); /*Called after writes to E - set by PERIPHERY*/
+        void (*sio)(struct myth_vm*); /*Called after SCLK changes - set by PERIPHERY*/
+        int (*spibyte)(struct myth_vm*); /*Byte transfer fast path - set by PERIPHERY*/
 };
 
 /*
@@ -92,18 +96,10 @@ struct myth_vm /*Complete machine state including all RAM*/
 
 
 void myth_reset(struct myth_vm *vm);
-void myth_step(struct myth_vm *vm);
+int myth_step(struct myth_vm *vm);
 
 static uchar fetch(struct myth_vm *vm);
-static uchar srcval(struct myth_vm *vm, uchar srcreg);
-static int scrounge(uchar opcode);
-static void pair(struct myth_vm *vm, uchar opcode);
-static void giro(struct myth_vm *vm, uchar opcode);
-static void trap(struct myth_vm *vm, uchar opcode);
-static void alu(struct myth_vm *vm, uchar opcode);
-static void fix(struct myth_vm *vm, uchar opcode);
-static void sys(struct myth_vm *vm, uchar opcode);
-static void call(struct myth_vm *vm, uchar dstpage);
+static int spirun(struct myth_vm *vm);
 
 
 /* The 'REGx' notation means: REG into (something)
@@ -189,7 +185,7 @@ static void call(struct myth_vm *vm, uchar dstpage);
 #define M2 6
 #define M1 7
 
-#define GIRO_BASE_OFFSET 0xF8 /*Local-page offset used by DIRO instructions*/
+#define GIRO_BASE_OFFSET 0xF8 /*Local-page offset used by GIRO instructions*/
 
 void
 myth_reset(struct myth_vm *vm) /*Initialise machine state*/
@@ -222,24 +218,6 @@ myth_reset(struct myth_vm *vm) /*Initialise machine state*/
 }
 
 
-void
-myth_step(struct myth_vm *vm)
-{
-        vm->scrounge = 0;
-        uchar opcode = fetch(vm);
-
-        /*Decode priority encoded opcode*/
-        /*Execute decoded instruction*/
-
-        if (opcode&0x80) pair(vm, opcode);
-        else if (opcode&0x40) giro(vm, opcode);
-        else if (opcode&0x20) trap(vm, opcode);
-        else if (opcode&0x10) alu(vm, opcode);
-        else if (opcode&0x08) fix(vm, opcode);
-        else sys(vm, opcode);
-}
-
-
 /* Fetch next byte in CODE stream, then increment PC.
    Fetches either an instruction, or an instruction literal (FETCHx)
 */
@@ -253,232 +231,65 @@ fetch(struct myth_vm *vm)
 }
 
 
-/* TRAP has identical operation, but with an
-   immediate destination page Offset
+/* Canonical SPI mode 0 byte transfer: 8 x SSO SCH SSI SCL.
+   When SSO begins this run with SCLK low, the whole byte is
+   handed to the spibyte hook, which may decline (returns 0)
+   and leave the bits to be clocked one by one.
 */
 
-void
-call(struct myth_vm *vm, uchar dstpage)
-{
-        /*Save origin*/
-        vm->i = vm->pc;
-        vm->co = vm->c;
-
-        /*Branch to page head*/
-        vm->pc = 0;
-        vm->c = dstpage;
-
-        /*Create stack frame*/
-        vm->l--;
-}
+#define SPIRUN 32
 
+static uchar spiseq[SPIRUN] = {
+        SSO, SCH, SSI, SCL, SSO, SCH, SSI, SCL,
+        SSO, SCH, SSI, SCL, SSO, SCH, SSI, SCL,
+        SSO, SCH, SSI, SCL, SSO, SCH, SSI, SCL,
+        SSO, SCH, SSI, SCL, SSO, SCH, SSI, SCL
+};
 
-void
-trap(struct myth_vm *vm, uchar opcode)
+int
+spirun(struct myth_vm *vm) /*PC points behind the SSO*/
 {
-        uchar dstpage = opcode & 31; /*Zero except low order 5 bits*/
-        call(vm, dstpage);
+        uchar *p;
+        int k;
+
+        if (vm->sclk || vm->pc > 256 - (SPIRUN-1)) return 0;
+        p = &vm->ram[vm->c][vm->pc];
+        for (k=1; k<SPIRUN; k++)
+                if (p[k-1] != spiseq[k]) return 0;
+        return 1;
 }
 
 
-/* First part of handling PAIR instructions,
-   derives the source value
-*/
+#define L7 (vm->ram[vm->l][GIRO_BASE_OFFSET +7])
 
-uchar
-srcval(struct myth_vm *vm, uchar srcreg)
-{
-        switch(srcreg){
-                case FETCHx: return fetch(vm); /*pseudo reg*/
-                case MGx: return vm->ram[ vm->g][ vm->o]; /*pseudo reg*/
-                case MLx: return vm->ram[ vm->l][ vm->o]; /*pseudo reg*/
-                case Gx: return vm->g;
-                case Rx: return vm->r;
-                case Ix: return vm->i;
-                case Sx: return vm->sir;
-           default /*Px*/: return vm->pir;
-        }
-}
 
+/* One handler per opcode with all fields folded into
+   constants, and the dispatch table myth_optab[].
+   Generated by mkoptab.go from res/myth_instructions.json.
 
-/* SCROUNGING of certain PAIR instructions:
-Remap undesirable opcodes to other,
-application specific opcodes or CPU extensions etc.
-Don't assume that these are generally NOPs!
+   SCROUNGING of certain PAIR instructions:
+   Their handlers only set vm->scrounge, so that undesirable
+   opcodes can be remapped to other, application specific
+   opcodes or CPU extensions etc.
+   Don't assume that these are generally NOPs!
 */
 
-int
-scrounge(uchar opcode)
-{
-        switch(opcode & 0x7F /*0111_1111 zero b7*/){
-                case 16*FETCHx + xMG: return opcode; /*NM => NOP (reserved)*/
-                case 16*FETCHx + xML: return opcode; /*NL => NOP (reserved)*/
-                case 16*MGx + xMG: return opcode; /*MM => NOP (reserved)*/
-                case 16*MGx + xML: return opcode; /*ML => NOP (reserved)*/
-                case 16*MLx + xMG: return opcode; /*LM => NOP (reserved)*/
-                case 16*MLx + xML: return opcode; /*LL => NOP (reserved)*/
-                case 16*Gx + xG: return opcode; /*GG => NOP (reserved)*/
-                case 16*Rx + xR: return opcode; /*RR => NOP (reserved)*/
-                case 16*Ix + xI: return opcode; /*II => NOP (reserved)*/
-        }
-        return 0;
-}
+#include "optab.h"
 
 
-/* Second part of handling PAIR instructions,
-   stores source value into destination
+/* Execute one instruction, returns the number of instructions
+   retired (more than one when a run was fused, see spirun())
 */
 
-void
-pair(struct myth_vm *vm, uchar opcode)
-{
-        uchar src = (opcode >> 4) & 7; /*Zero except bits 4-6 at LSB*/
-        uchar dst = opcode & 15; /* Zero except bits 0-3 at LSB*/
-
-        if (scrounge(opcode)){
-                 vm->scrounge = opcode;
-                 return;
-        }
-
-        uchar v = srcval(vm, src);
-        int temp;
-        switch(dst){
-                case xO: vm->o = v; break;
-                case xMG: vm->ram[ vm->g][ vm->o] = v; break;
-                case xML: vm->ram[ vm->l][ vm->o] = v; break;
-                case xG: vm->g = v; break;
-                case xR: vm->r = v; break;
-                case xI: vm->i = v; break;
-                case xS: vm->sor = v; break;
-                case xP: vm->por = v; break;
-                case xE: vm->e_old = vm->e_new;
-                         vm->e_new = v;
-                         break;
-                case xSKIP:
-                        temp = vm->o + v;
-                        vm->o = (uchar) (temp & 0xFF);
-                        if (temp>255) vm->g += 1;
-                        break;
-                case xNEAR: vm->l += v; break;
-                case xJUMP: vm->pc = v; break;
-                case xJITD:
-                        if (vm->i) vm->pc = v;
-                        (vm->i)--; /*Post decrement, either case!*/
-                        break; 
-                case xJRT: if (vm->r) vm->pc = v; break;
-                case xJRF: if (!vm->r) vm->pc = v; break;
-                case xCALL: call(vm, v); break;
-        }
-}
-
-void
-giro(struct myth_vm *vm, uchar opcode) /*Execute GIRO instruction*/
-{
-        /* OPCODE
-            BITS 0-2 encode byte address offset in local page (from F8)
-            BIT 3 encodes GET/PUT mode
-            BITS 4-5 encode register index (DIRO)
-        */
-
-        #define BIT3 8
-        #define BITS45 (opcode >> 4) & 3
-        #define BITS02 opcode & 7
-
-        uchar index = BITS02;              
-        uchar *mptr = &(vm->ram[vm->l][GIRO_BASE_OFFSET + index]);
-
-        if(opcode & BIT3)
-                switch(BITS45){
-                        case 0: *mptr = vm->g; break;
-                        case 1: *mptr = vm->i; break;
-                        case 2: *mptr = vm->r; break;
-                        case 3: *mptr = vm->o; break;
-                }
-        else
-        switch(BITS45){
-                case 0: vm->g = *mptr; break;
-                case 1: vm->i = *mptr; break;
-                case 2: vm->r = *mptr; break;
-                case 3: vm->o = *mptr; break;
-        }
-}
-
-
-void
-alu(struct myth_vm *vm, uchar opcode)
+int
+myth_step(struct myth_vm *vm)
 {
-        switch(opcode & 15){/* Zero except low order 4 bits*/
-                case CLR: vm->r = 0; break;
-                case IDO: vm->r = vm->o; break;
-                case OCR: vm->r = ~vm->r; break;
-                case OCO: vm->r = ~vm->o; break;
-                case SLR: vm->r = vm->r << 1; break;
-                case SLO: vm->r = vm->o << 1; break;
-                case SRR: vm->r = vm->r >> 1; break;
-                case SRO: vm->r = vm->o >> 1; break;
-                case AND: vm->r = vm->r & vm->o; break;
-                case IOR: vm->r = vm->r | vm->o; break;
-                case EOR: vm->r = vm->r ^ vm->o; break;
-                case ADD: vm->r = vm->r + vm->o; break;
-                case CAR:
-                        vm->r = (uint) vm->r + (uint) vm->o > 255 ? 1 : 0;
-                        break;
-                case RLO: vm->r = (vm->r < vm->o) ? 255 : 0; break;
-                case REO: vm->r = (vm->r == vm->o) ? 255 : 0; break;
-                case RGO: vm->r = (vm->r > vm->o) ? 255 : 0; break;
-        }
-}
+        uchar *code = vm->ram[vm->c];
+        long n = SPIRUN-1; /*Room for one fused run*/
 
-
-void /*Add sign-extended number to R*/
-fix(struct myth_vm *vm, uchar opcode)
-{
-        switch(opcode & 7){ /*Zero except low order 3 bits*/
-                case P4: vm->r += 4; break;
-                case P1: vm->r += 1; break;
-                case P2: vm->r += 2; break;
-                case P3: vm->r += 3; break;
-                case M4: vm->r -= 4; break;
-                case M3: vm->r -= 3; break;
-                case M2: vm->r -= 2; break;
-                case M1: vm->r -= 1; break;
-        }
-}
-
-
-void
-sys(struct myth_vm *vm, uchar opcode)
-{
-        switch(opcode & 7){ /*Zero except low order 3 bits*/
-                
-                case NOP: break;
-                case SSI:
-                        /*Clocks in MISO line bit into LSB*/
-                        vm->sir = ((vm->sir)<<1) + vm->miso;
-                        break;
-                case SSO:
-                        /*Clocks out MSB first*/
-                        vm->mosi = (vm->sor)&0x80 ? 1:0;
-                        vm->sor <<= 1;
-                        break;
-                case SCL: vm->sclk = 0; break;
-                case SCH: vm->sclk = 1; break;
-
-                #define L7 (vm->ram[vm->l][GIRO_BASE_OFFSET +7])
-
-                case RET:
-                        vm->c = L7;
-                        vm->pc = vm->i;
-                        vm->l++;
-                        break;
-
-                case COR:
-                        vm->c = vm->r;
-                        vm->pc = vm->i;
-                        break;
-
-                case OWN: L7 = vm->co; break;
-        }
+        vm->scrounge = 0;
+        myth_optab[fetch(vm)](vm, &code, &vm->pc, &vm->r, &vm->o, &n);
+        return SPIRUN - n;
 }
 
-#endif
\ No newline at end of file
+#endif
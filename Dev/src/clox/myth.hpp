@@ -0,0 +1,493 @@
+#ifndef __MYTH_HPP__
+#define __MYTH_HPP__ 1
+
+/* Policy-based C++ engine for Sonne 8 micro-controllers
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+   myth::BasicEngine<Isa, Policies...> threads opcodes through a
+   computed goto table (GCC and clang), each entry the handler of
+   the ISA descriptor instantiated for that opcode, so that decoding
+   happens at compile time and every handler has its own indirect
+   jump to the next.
+   myth::Lox runs the opcode handlers of optab.h, so it executes
+   exactly what myth.h does, revs.hpp adds the older revisions.
+   myth::Engine<Policies...> is the LOX engine.
+
+   Instrumentation is chosen at compile time: every policy is a
+   base class of the engine and gets its hooks called with the
+   opcode as a template argument. Hooks a policy does not define
+   fall back to the empty ones of myth::Policy, and the engine
+   without policies compiles to the same dispatch as a hand
+   written one.
+
+   Hooks, all template<int Op, class E> members:
+     before(E&, const Regs&)        ahead of the opcode, Regs as fetched
+     after(E&, const Regs&, long)   instructions retired (SPIRUN if fused)
+     store(E&, const Regs&, addr, old)  RAM byte written by Op
+     edev(E&)                       E written, machine state spilled
+     sclk(E&)                       SCLK changed
+
+   store() is only compiled into opcodes that can write memory,
+   edev() and sclk() only into the ones that touch E or SCLK.
+   A policy with canstop set may end run() early with e.stop().
+   Regs is the register view of the ISA, Regs::addr() the
+   address of the opcode in the flat memory of Isa::mem().
+
+   Diagnostic build of lox, for example:
+
+     myth::Engine<myth::Trace, myth::Watch,
+                  myth::Devices<edispatch, spibit>> e(vm);
+     e.watch(0x7F00 | ECODE);
+     e.runall(999*1000);
+
+   With Devices, leave vm.eio and vm.sio nil or devices see
+   every edge twice.
+
+
+   An ISA descriptor provides:
+
+     State                 machine state, including memory
+     Live                  registers kept in locals during run():
+                           Live(State&), fetch(), regs(), spill(), reload()
+     Regs                  register view for hooks
+     machine, pgsize, npages, nregs   .myst geometry, see myst.h
+     mem(), getregs(), setregs(), loadraw()   image access
+     boot()                state a runner starts a loaded image from
+     begin(), halted()     run() entry, end condition of runall()
+     exec<Op>()            handler, returns OP_NEXT or OP_EXIT
+     writes(), wraddr<Op>()  memory stores, for store()
+     writese(), clocking(), sclk()   E and SCLK writes
+     name(), oplen(), trace()   disassembly
+*/
+
+#include <bitset>
+#include <vector>
+#include <algorithm>
+
+#include "myth.h"
+#include "lox.h"
+#include "myst.h"
+
+namespace myth {
+
+typedef struct myth_vm Vm;
+
+
+/* LOX opcode properties, from the encoding as in mkoptab.go
+*/
+
+constexpr int src(int op) { return op>>4 & 7; }
+constexpr int dst(int op) { return op & 15; }
+constexpr bool pair(int op) { return op & 0x80; }
+constexpr bool giroput(int op) { return (op & 0xC8) == 0x48; }
+
+constexpr bool
+scrounge(int op)
+{
+        return pair(op) && ((src(op) <= MLx && (dst(op) == xMG || dst(op) == xML))
+                || (src(op) == dst(op) && src(op) >= Gx && src(op) <= Ix));
+}
+
+constexpr bool literal(int op) { return pair(op) && src(op) == FETCHx && !scrounge(op); }
+constexpr bool writesg(int op) { return pair(op) && dst(op) == xMG && !scrounge(op); }
+constexpr bool writesl(int op) { return (pair(op) && dst(op) == xML && !scrounge(op))
+                                        || giroput(op) || op == OWN; }
+
+
+/* Compile-time binding of opcodes to their optab.h handlers
+*/
+
+template<int Op> struct Handler;
+
+#define MYTH_HANDLER(x) \
+template<> struct Handler<0x##x> { \
+        static inline int exec(OPARGS) { return op##x(vm, code, pc, r, o, n); } \
+};
+
+MYTH_OPLIST(MYTH_HANDLER)
+
+#undef MYTH_HANDLER
+
+
+struct Lox /*Myth/LOX, myth.h*/
+{
+        typedef Vm State;
+
+        struct Regs {
+                uchar c, pc, r, o;
+                uint addr() const { return c<<8 | pc; }
+        };
+
+        struct Live { /*PC, R and O stay in host registers*/
+                uchar *code;
+                uchar pc, r, o;
+
+                Live(State &vm) : code(vm.ram[vm.c]), pc(vm.pc), r(vm.r), o(vm.o) {}
+                uchar fetch(State&) { return code[pc++]; }
+                Regs regs(State &vm) const { return Regs{vm.c, (uchar) (pc-1), r, o}; }
+                void spill(State &vm) const { vm.pc = pc; vm.r = r; vm.o = o; }
+                void reload(State &vm) { r = vm.r; o = vm.o; }
+        };
+
+        static constexpr int machine = MYST_LOX;
+        static constexpr int pgsize = 256;
+        static constexpr int npages = 256;
+        static constexpr int nregs = NREGS;
+
+        static uchar *mem(State &vm) { return &vm.ram[0][0]; }
+        static void getregs(State &vm, uchar *regs) { packregs(&vm, regs); }
+        static void setregs(State &vm, uchar *regs) { unpackregs(&vm, regs); }
+        static int loadraw(State&, uchar*, long) { return MYST_EMAGIC; }
+
+        static void boot(State&) {}
+        static void begin(State &vm) { vm.scrounge = 0; }
+        static bool halted(State &vm) { return vm.scrounge == END; }
+
+        template<int Op>
+        static inline int
+        exec(State &vm, Live &x, long &n)
+        {
+                return Handler<Op>::exec(&vm, &x.code, &x.pc, &x.r, &x.o, &n);
+        }
+
+        static constexpr bool writes(int op) { return writesg(op) || writesl(op); }
+
+        template<int Op>
+        static inline uint
+        wraddr(State &vm, Live &x)
+        {
+                uchar offs = giroput(Op) ? GIRO_BASE_OFFSET + (Op & 7) : Op == OWN ? 0xFF : x.o;
+                return (writesg(Op) ? vm.g : vm.l) << 8 | offs;
+        }
+
+        static constexpr bool writese(int op) { return pair(op) && dst(op) == xE && !scrounge(op); }
+        static constexpr bool clocking(int op) { return op == SCL || op == SCH; }
+        static uchar sclk(State &vm) { return vm.sclk; }
+
+        static const char *name(int op) { return myth_opname(op); }
+        static int oplen(int op) { return myth_oplen(op); }
+
+        static void
+        trace(int fd, State &vm, const Regs &x, int op)
+        {
+                fprint(fd, "%.2X.%.2X: %-4s", x.c, x.pc, myth_opname(op));
+                if (literal(op))
+                        fprint(fd, " %.2X", vm.ram[x.c][(uchar) (x.pc+1)]);
+                else
+                        fprint(fd, "   ");
+                fprint(fd, "  R:%.2X O:%.2X I:%.2X G:%.2X L:%.2X E:%.2X\n",
+                        x.r, x.o, vm.i, vm.g, vm.l, vm.e_new);
+        }
+};
+
+
+struct Policy /*Empty hooks*/
+{
+        static constexpr bool canstop = false;
+
+        template<int Op, class E, class R> void before(E&, const R&) {}
+        template<int Op, class E, class R> void after(E&, const R&, long) {}
+        template<int Op, class E, class R> void store(E&, const R&, uint, uchar) {}
+        template<int Op, class E> void edev(E&) {}
+        template<int Op, class E> void sclk(E&) {}
+};
+
+
+template<class I, class... P>
+class BasicEngine : public P...
+{
+public:
+        typedef I Isa;
+        typedef typename I::State State;
+        typedef typename I::Regs Regs;
+
+        State &vm;
+
+        explicit BasicEngine(State &v) : vm(v) {}
+
+        void stop() { stopped = true; }
+
+        /* Execute up to 'budget' instructions, returns the number
+           retired (counted as by myth_step()). Stops early when a
+           handler returns OP_EXIT, e.g. after a LOX scrounge.
+        */
+        long
+        run(long budget)
+        {
+#define MYTH_LABEL(op) &&L##op,
+                static void *const dispatch[256] = { MYTH_OPLIST(MYTH_LABEL) };
+#undef MYTH_LABEL
+                typename I::Live x(vm);
+                long n = budget;
+
+                I::begin(vm);
+                stopped = false;
+
+#define MYTH_NEXT if (n <= 0 || (canstop && stopped)) goto out; n--; goto *dispatch[x.fetch(vm)]
+                MYTH_NEXT;
+#define MYTH_CASE(op) L##op: if (exec<0x##op>(x, n) != OP_NEXT) goto out; MYTH_NEXT;
+                MYTH_OPLIST(MYTH_CASE)
+#undef MYTH_CASE
+#undef MYTH_NEXT
+out:
+                x.spill(vm);
+                return budget - n;
+        }
+
+        long step() { return run(1); }
+
+        /* Run across OP_EXIT until the ISA halts, e.g. LOX END,
+           the budget is spent or a policy stops
+        */
+        long
+        runall(long budget)
+        {
+                long done = 0;
+
+                while (done < budget) {
+                        done += run(budget - done);
+                        if (I::halted(vm) || stopped) break;
+                }
+                return done;
+        }
+
+private:
+        static constexpr bool canstop = (P::canstop || ... || false);
+        bool stopped = false;
+
+        template<int Op>
+        inline int
+        exec(typename I::Live &x, long &n)
+        {
+                const Regs at = x.regs(vm);
+                const long left = n;
+                uint addr = 0;
+                uchar old = 0, sclk = I::sclk(vm);
+                int rc;
+
+                (static_cast<P&>(*this).template before<Op>(*this, at), ...);
+
+                if constexpr (I::writes(Op)) {
+                        addr = I::template wraddr<Op>(vm, x);
+                        old = I::mem(vm)[addr];
+                }
+
+                rc = I::template exec<Op>(vm, x, n);
+
+                if constexpr (I::writes(Op))
+                        (static_cast<P&>(*this).template store<Op>(*this, at, addr, old), ...);
+                if constexpr (I::writese(Op)) {
+                        x.spill(vm);
+                        (static_cast<P&>(*this).template edev<Op>(*this), ...);
+                        x.reload(vm);
+                }
+                if constexpr (I::clocking(Op))
+                        if (I::sclk(vm) != sclk) {
+                                x.spill(vm);
+                                (static_cast<P&>(*this).template sclk<Op>(*this), ...);
+                                x.reload(vm);
+                        }
+
+                (static_cast<P&>(*this).template after<Op>(*this, at, 1 + left - n), ...);
+                return rc;
+        }
+};
+
+template<class... P>
+using Engine = BasicEngine<Lox, P...>;
+
+
+/* Machine images, .myst or the raw format of the ISA,
+   return 0 or an MYST_E* code
+*/
+
+template<class I>
+int
+load(typename I::State &vm, uchar *img, long n)
+{
+        uchar regs[I::nregs];
+        int err;
+
+        if (!myst_ismagic(img, n))
+                return I::loadraw(vm, img, n);
+        err = myst_decode(img, n, I::machine, I::mem(vm), I::pgsize, I::npages, regs, I::nregs);
+        if (err) return err;
+        I::setregs(vm, regs);
+        return 0;
+}
+
+template<class I>
+int
+loadfile(typename I::State &vm, char *fname)
+{
+        std::vector<uchar> buf(MYST_MAXSIZE(I::pgsize, I::npages, I::nregs));
+        int fdesc;
+        long n;
+
+        fdesc = open(fname, OREAD);
+        if (fdesc == -1) return MYST_EMAGIC;
+        n = readn(fdesc, buf.data(), buf.size());
+        close(fdesc);
+        return load<I>(vm, buf.data(), n);
+}
+
+template<class I>
+int
+savefile(typename I::State &vm, char *fname)
+{
+        std::vector<uchar> buf(MYST_MAXSIZE(I::pgsize, I::npages, I::nregs));
+        uchar regs[I::nregs];
+        int fdesc;
+        long n;
+
+        I::getregs(vm, regs);
+        n = myst_encode(buf.data(), I::machine, I::mem(vm), I::pgsize, I::npages, regs, I::nregs);
+        fdesc = create(fname, OWRITE, 0666);
+        if (fdesc == -1) return -1;
+        if (write(fdesc, buf.data(), n) != n) {
+                close(fdesc);
+                return -1;
+        }
+        close(fdesc);
+        return 0;
+}
+
+
+/* One line per instruction, disassembled as by lox -r
+*/
+
+struct Trace : Policy
+{
+        int fd = 2;
+
+        template<int Op, class E>
+        void
+        before(E &e, const typename E::Regs &x)
+        {
+                E::Isa::trace(fd, e.vm, x, Op);
+        }
+};
+
+
+/* Execution counts per opcode and per code address
+*/
+
+struct Profile : Policy
+{
+        uvlong ops[256] = {};
+        std::vector<uvlong> addr = std::vector<uvlong>(256*256);
+
+        template<int Op, class E>
+        void
+        after(E&, const typename E::Regs &x, long)
+        {
+                ops[Op]++;
+                addr[x.addr()]++;
+        }
+
+        void
+        report(int fd, int top, const char *(*name)(int))
+        {
+                std::vector<int> k(addr.size());
+                int i;
+
+                for (i=0; i<(int)k.size(); i++) k[i] = i;
+                std::sort(k.begin(), k.begin()+256,
+                        [this](int a, int b) { return ops[a] > ops[b]; });
+                fprint(fd, "Opcodes:\n");
+                for (i=0; i<top && i<256 && ops[k[i]]; i++)
+                        fprint(fd, "%.2X %-4s %12llud\n", k[i], name(k[i]), ops[k[i]]);
+
+                for (i=0; i<(int)k.size(); i++) k[i] = i;
+                std::sort(k.begin(), k.end(),
+                        [this](int a, int b) { return addr[a] > addr[b]; });
+                fprint(fd, "Addresses:\n");
+                for (i=0; i<top && addr[k[i]]; i++)
+                        fprint(fd, "%.4X %12llud\n", k[i], addr[k[i]]);
+        }
+};
+
+
+/* Write watchpoints on RAM bytes, the first hit stops run()
+   unless stopping is off
+*/
+
+struct Watch : Policy
+{
+        static constexpr bool canstop = true;
+
+        struct Hit {
+                uint at;   /*Opcode address*/
+                uint addr;
+                uchar old, val;
+        };
+
+        std::bitset<256*256> watched;
+        std::vector<Hit> hits;
+        bool stopping = true;
+
+        void watch(uint addr) { watched.set(addr); }
+        void unwatch(uint addr) { watched.reset(addr); }
+
+        template<int Op, class E>
+        void
+        store(E &e, const typename E::Regs &x, uint addr, uchar old)
+        {
+                if (!watched.test(addr)) return;
+                hits.push_back(Hit{x.addr(), addr, old, E::Isa::mem(e.vm)[addr]});
+                if (stopping) e.stop();
+        }
+};
+
+
+/* Clock count, by default three clocks per instruction as in
+   the fetch, read and write phases of the Verilog core
+*/
+
+struct ThreePhase
+{
+        static constexpr int clocks(int op) { USED(op); return 3; }
+};
+
+template<class Cost = ThreePhase>
+struct CycleTiming : Policy
+{
+        uvlong clocks = 0;
+
+        template<int Op, class E>
+        void
+        after(E&, const typename E::Regs&, long retired)
+        {
+                constexpr int k = Cost::clocks(Op);
+                clocks += k * retired;
+        }
+
+        double seconds(double hz) const { return clocks / hz; }
+};
+
+
+/* Device callbacks bound at compile time, e.g. edispatch and
+   spibit, instead of the vm.eio and vm.sio pointers
+*/
+
+template<auto Eio, auto Sio = nullptr>
+struct Devices : Policy
+{
+        template<int Op, class E>
+        void
+        edev(E &e)
+        {
+                if constexpr (Eio != nullptr) Eio(&e.vm);
+        }
+
+        template<int Op, class E>
+        void
+        sclk(E &e)
+        {
+                if constexpr (Sio != nullptr) Sio(&e.vm);
+        }
+};
+
+}
+
+#endif
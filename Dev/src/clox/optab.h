@@ -0,0 +1,2505 @@
+/* Generated by mkoptab.go from res/myth_instructions.json, do not edit
+*/
+
+#ifndef __OPTAB_H__
+#define __OPTAB_H__ 1
+
+/* Handlers get the code page and the PC, R and O registers
+   by reference so engines can keep them outside struct myth_vm.
+   n is the instruction budget left, SSO may consume more.
+   OP_EXIT means a scrounge was executed.
+*/
+
+#define OPARGS struct myth_vm *vm, uchar **code, uchar *pc, uchar *r, uchar *o, long *n
+
+#define OP_NEXT 0
+#define OP_EXIT 1
+
+#ifdef __GNUC__
+#define OPINLINE static inline __attribute__((always_inline))
+#else
+#define OPINLINE static
+#endif
+
+
+OPINLINE int
+op00(OPARGS) /*SYS NOP*/
+{
+        return OP_NEXT;
+}
+
+OPINLINE int
+op01(OPARGS) /*SYS SSI: sir=(sir<<1)+miso*/
+{
+        vm->sir = ((vm->sir)<<1) + vm->miso;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op02(OPARGS) /*SYS SSO: mosi=sor&0x80 ? 1:0; sor<<=1*/
+{
+        if (vm->spibyte && *n >= SPIRUN-1) { /*Fused byte transfer*/
+                vm->pc = *pc;
+                if (spirun(vm) && vm->spibyte(vm)) {
+                        *pc += SPIRUN-1;
+                        *n -= SPIRUN-1;
+                        return OP_NEXT;
+                }
+        }
+        vm->mosi = (vm->sor)&0x80 ? 1:0;
+        vm->sor <<= 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op03(OPARGS) /*SYS SCL: sclk=0*/
+{
+        if (vm->sclk) {
+                vm->sclk = 0;
+                if (vm->sio) vm->sio(vm);
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+op04(OPARGS) /*SYS SCH: sclk=1*/
+{
+        if (!vm->sclk) {
+                vm->sclk = 1;
+                if (vm->sio) vm->sio(vm);
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+op05(OPARGS) /*SYS RET: c=L7; pc=i; l++*/
+{
+        vm->c = L7;
+        *pc = vm->i;
+        vm->l++;
+        *code = vm->ram[vm->c];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op06(OPARGS) /*SYS COR: c=r; pc=i*/
+{
+        vm->c = *r;
+        *pc = vm->i;
+        *code = vm->ram[vm->c];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op07(OPARGS) /*SYS OWN: L7=co*/
+{
+        L7 = vm->co;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op08(OPARGS) /*FIX P4: r+=4*/
+{
+        *r += 4;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op09(OPARGS) /*FIX P1: r+=1*/
+{
+        *r += 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op0A(OPARGS) /*FIX P2: r+=2*/
+{
+        *r += 2;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op0B(OPARGS) /*FIX P3: r+=3*/
+{
+        *r += 3;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op0C(OPARGS) /*FIX M4: r-=4*/
+{
+        *r -= 4;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op0D(OPARGS) /*FIX M3: r-=3*/
+{
+        *r -= 3;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op0E(OPARGS) /*FIX M2: r-=2*/
+{
+        *r -= 2;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op0F(OPARGS) /*FIX M1: r-=1*/
+{
+        *r -= 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op10(OPARGS) /*ALU CLR: r=0*/
+{
+        *r = 0;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op11(OPARGS) /*ALU IDO: r=o*/
+{
+        *r = *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op12(OPARGS) /*ALU OCR: r=~r*/
+{
+        *r = ~*r;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op13(OPARGS) /*ALU OCO: r=~o*/
+{
+        *r = ~*o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op14(OPARGS) /*ALU SLR: r=r<<1*/
+{
+        *r = *r << 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op15(OPARGS) /*ALU SLO: r=o<<1*/
+{
+        *r = *o << 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op16(OPARGS) /*ALU SRR: r=r>>1*/
+{
+        *r = *r >> 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op17(OPARGS) /*ALU SRO: r=o>>1*/
+{
+        *r = *o >> 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op18(OPARGS) /*ALU AND: r=r&o*/
+{
+        *r = *r & *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op19(OPARGS) /*ALU IOR: r=r|o*/
+{
+        *r = *r | *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op1A(OPARGS) /*ALU EOR: r=r^o*/
+{
+        *r = *r ^ *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op1B(OPARGS) /*ALU ADD: r=r+o*/
+{
+        *r = *r + *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op1C(OPARGS) /*ALU CAR: if r+o>255 then r=1 else r=0*/
+{
+        *r = (uint) *r + (uint) *o > 255 ? 1 : 0;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op1D(OPARGS) /*ALU RLO: if r<o then r=255 else r=0*/
+{
+        *r = (*r < *o) ? 255 : 0;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op1E(OPARGS) /*ALU REO: if r=o then r=255 else r=0*/
+{
+        *r = (*r == *o) ? 255 : 0;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op1F(OPARGS) /*ALU RGO: if r>o then r=255 else r=0*/
+{
+        *r = (*r > *o) ? 255 : 0;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op20(OPARGS) /*TRAP *0: i=pc; co=c; pc=0; c=0; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 0;
+        vm->l--;
+        *code = vm->ram[0];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op21(OPARGS) /*TRAP *1: i=pc; co=c; pc=0; c=1; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 1;
+        vm->l--;
+        *code = vm->ram[1];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op22(OPARGS) /*TRAP *2: i=pc; co=c; pc=0; c=2; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 2;
+        vm->l--;
+        *code = vm->ram[2];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op23(OPARGS) /*TRAP *3: i=pc; co=c; pc=0; c=3; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 3;
+        vm->l--;
+        *code = vm->ram[3];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op24(OPARGS) /*TRAP *4: i=pc; co=c; pc=0; c=4; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 4;
+        vm->l--;
+        *code = vm->ram[4];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op25(OPARGS) /*TRAP *5: i=pc; co=c; pc=0; c=5; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 5;
+        vm->l--;
+        *code = vm->ram[5];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op26(OPARGS) /*TRAP *6: i=pc; co=c; pc=0; c=6; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 6;
+        vm->l--;
+        *code = vm->ram[6];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op27(OPARGS) /*TRAP *7: i=pc; co=c; pc=0; c=7; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 7;
+        vm->l--;
+        *code = vm->ram[7];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op28(OPARGS) /*TRAP *8: i=pc; co=c; pc=0; c=8; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 8;
+        vm->l--;
+        *code = vm->ram[8];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op29(OPARGS) /*TRAP *9: i=pc; co=c; pc=0; c=9; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 9;
+        vm->l--;
+        *code = vm->ram[9];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op2A(OPARGS) /*TRAP *10: i=pc; co=c; pc=0; c=10; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 10;
+        vm->l--;
+        *code = vm->ram[10];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op2B(OPARGS) /*TRAP *11: i=pc; co=c; pc=0; c=11; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 11;
+        vm->l--;
+        *code = vm->ram[11];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op2C(OPARGS) /*TRAP *12: i=pc; co=c; pc=0; c=12; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 12;
+        vm->l--;
+        *code = vm->ram[12];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op2D(OPARGS) /*TRAP *13: i=pc; co=c; pc=0; c=13; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 13;
+        vm->l--;
+        *code = vm->ram[13];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op2E(OPARGS) /*TRAP *14: i=pc; co=c; pc=0; c=14; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 14;
+        vm->l--;
+        *code = vm->ram[14];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op2F(OPARGS) /*TRAP *15: i=pc; co=c; pc=0; c=15; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 15;
+        vm->l--;
+        *code = vm->ram[15];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op30(OPARGS) /*TRAP *16: i=pc; co=c; pc=0; c=16; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 16;
+        vm->l--;
+        *code = vm->ram[16];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op31(OPARGS) /*TRAP *17: i=pc; co=c; pc=0; c=17; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 17;
+        vm->l--;
+        *code = vm->ram[17];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op32(OPARGS) /*TRAP *18: i=pc; co=c; pc=0; c=18; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 18;
+        vm->l--;
+        *code = vm->ram[18];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op33(OPARGS) /*TRAP *19: i=pc; co=c; pc=0; c=19; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 19;
+        vm->l--;
+        *code = vm->ram[19];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op34(OPARGS) /*TRAP *20: i=pc; co=c; pc=0; c=20; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 20;
+        vm->l--;
+        *code = vm->ram[20];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op35(OPARGS) /*TRAP *21: i=pc; co=c; pc=0; c=21; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 21;
+        vm->l--;
+        *code = vm->ram[21];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op36(OPARGS) /*TRAP *22: i=pc; co=c; pc=0; c=22; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 22;
+        vm->l--;
+        *code = vm->ram[22];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op37(OPARGS) /*TRAP *23: i=pc; co=c; pc=0; c=23; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 23;
+        vm->l--;
+        *code = vm->ram[23];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op38(OPARGS) /*TRAP *24: i=pc; co=c; pc=0; c=24; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 24;
+        vm->l--;
+        *code = vm->ram[24];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op39(OPARGS) /*TRAP *25: i=pc; co=c; pc=0; c=25; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 25;
+        vm->l--;
+        *code = vm->ram[25];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op3A(OPARGS) /*TRAP *26: i=pc; co=c; pc=0; c=26; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 26;
+        vm->l--;
+        *code = vm->ram[26];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op3B(OPARGS) /*TRAP *27: i=pc; co=c; pc=0; c=27; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 27;
+        vm->l--;
+        *code = vm->ram[27];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op3C(OPARGS) /*TRAP *28: i=pc; co=c; pc=0; c=28; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 28;
+        vm->l--;
+        *code = vm->ram[28];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op3D(OPARGS) /*TRAP *29: i=pc; co=c; pc=0; c=29; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 29;
+        vm->l--;
+        *code = vm->ram[29];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op3E(OPARGS) /*TRAP *30: i=pc; co=c; pc=0; c=30; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 30;
+        vm->l--;
+        *code = vm->ram[30];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op3F(OPARGS) /*TRAP *31: i=pc; co=c; pc=0; c=31; l--*/
+{
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = 31;
+        vm->l--;
+        *code = vm->ram[31];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op40(OPARGS) /*GIRO 0g: g=L0*/
+{
+        vm->g = vm->ram[vm->l][GIRO_BASE_OFFSET + 0];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op41(OPARGS) /*GIRO 1g: g=L1*/
+{
+        vm->g = vm->ram[vm->l][GIRO_BASE_OFFSET + 1];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op42(OPARGS) /*GIRO 2g: g=L2*/
+{
+        vm->g = vm->ram[vm->l][GIRO_BASE_OFFSET + 2];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op43(OPARGS) /*GIRO 3g: g=L3*/
+{
+        vm->g = vm->ram[vm->l][GIRO_BASE_OFFSET + 3];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op44(OPARGS) /*GIRO 4g: g=L4*/
+{
+        vm->g = vm->ram[vm->l][GIRO_BASE_OFFSET + 4];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op45(OPARGS) /*GIRO 5g: g=L5*/
+{
+        vm->g = vm->ram[vm->l][GIRO_BASE_OFFSET + 5];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op46(OPARGS) /*GIRO 6g: g=L6*/
+{
+        vm->g = vm->ram[vm->l][GIRO_BASE_OFFSET + 6];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op47(OPARGS) /*GIRO 7g: g=L7*/
+{
+        vm->g = vm->ram[vm->l][GIRO_BASE_OFFSET + 7];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op48(OPARGS) /*GIRO g0: L0=g*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 0] = vm->g;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op49(OPARGS) /*GIRO g1: L1=g*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 1] = vm->g;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op4A(OPARGS) /*GIRO g2: L2=g*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 2] = vm->g;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op4B(OPARGS) /*GIRO g3: L3=g*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 3] = vm->g;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op4C(OPARGS) /*GIRO g4: L4=g*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 4] = vm->g;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op4D(OPARGS) /*GIRO g5: L5=g*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 5] = vm->g;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op4E(OPARGS) /*GIRO g6: L6=g*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 6] = vm->g;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op4F(OPARGS) /*GIRO g7: L7=g*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 7] = vm->g;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op50(OPARGS) /*GIRO 0i: i=L0*/
+{
+        vm->i = vm->ram[vm->l][GIRO_BASE_OFFSET + 0];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op51(OPARGS) /*GIRO 1i: i=L1*/
+{
+        vm->i = vm->ram[vm->l][GIRO_BASE_OFFSET + 1];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op52(OPARGS) /*GIRO 2i: i=L2*/
+{
+        vm->i = vm->ram[vm->l][GIRO_BASE_OFFSET + 2];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op53(OPARGS) /*GIRO 3i: i=L3*/
+{
+        vm->i = vm->ram[vm->l][GIRO_BASE_OFFSET + 3];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op54(OPARGS) /*GIRO 4i: i=L4*/
+{
+        vm->i = vm->ram[vm->l][GIRO_BASE_OFFSET + 4];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op55(OPARGS) /*GIRO 5i: i=L5*/
+{
+        vm->i = vm->ram[vm->l][GIRO_BASE_OFFSET + 5];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op56(OPARGS) /*GIRO 6i: i=L6*/
+{
+        vm->i = vm->ram[vm->l][GIRO_BASE_OFFSET + 6];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op57(OPARGS) /*GIRO 7i: i=L7*/
+{
+        vm->i = vm->ram[vm->l][GIRO_BASE_OFFSET + 7];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op58(OPARGS) /*GIRO i0: L0=i*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 0] = vm->i;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op59(OPARGS) /*GIRO i1: L1=i*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 1] = vm->i;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op5A(OPARGS) /*GIRO i2: L2=i*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 2] = vm->i;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op5B(OPARGS) /*GIRO i3: L3=i*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 3] = vm->i;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op5C(OPARGS) /*GIRO i4: L4=i*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 4] = vm->i;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op5D(OPARGS) /*GIRO i5: L5=i*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 5] = vm->i;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op5E(OPARGS) /*GIRO i6: L6=i*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 6] = vm->i;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op5F(OPARGS) /*GIRO i7: L7=i*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 7] = vm->i;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op60(OPARGS) /*GIRO 0r: r=L0*/
+{
+        *r = vm->ram[vm->l][GIRO_BASE_OFFSET + 0];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op61(OPARGS) /*GIRO 1r: r=L1*/
+{
+        *r = vm->ram[vm->l][GIRO_BASE_OFFSET + 1];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op62(OPARGS) /*GIRO 2r: r=L2*/
+{
+        *r = vm->ram[vm->l][GIRO_BASE_OFFSET + 2];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op63(OPARGS) /*GIRO 3r: r=L3*/
+{
+        *r = vm->ram[vm->l][GIRO_BASE_OFFSET + 3];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op64(OPARGS) /*GIRO 4r: r=L4*/
+{
+        *r = vm->ram[vm->l][GIRO_BASE_OFFSET + 4];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op65(OPARGS) /*GIRO 5r: r=L5*/
+{
+        *r = vm->ram[vm->l][GIRO_BASE_OFFSET + 5];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op66(OPARGS) /*GIRO 6r: r=L6*/
+{
+        *r = vm->ram[vm->l][GIRO_BASE_OFFSET + 6];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op67(OPARGS) /*GIRO 7r: r=L7*/
+{
+        *r = vm->ram[vm->l][GIRO_BASE_OFFSET + 7];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op68(OPARGS) /*GIRO r0: L0=r*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 0] = *r;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op69(OPARGS) /*GIRO r1: L1=r*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 1] = *r;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op6A(OPARGS) /*GIRO r2: L2=r*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 2] = *r;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op6B(OPARGS) /*GIRO r3: L3=r*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 3] = *r;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op6C(OPARGS) /*GIRO r4: L4=r*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 4] = *r;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op6D(OPARGS) /*GIRO r5: L5=r*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 5] = *r;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op6E(OPARGS) /*GIRO r6: L6=r*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 6] = *r;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op6F(OPARGS) /*GIRO r7: L7=r*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 7] = *r;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op70(OPARGS) /*GIRO 0o: o=L0*/
+{
+        *o = vm->ram[vm->l][GIRO_BASE_OFFSET + 0];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op71(OPARGS) /*GIRO 1o: o=L1*/
+{
+        *o = vm->ram[vm->l][GIRO_BASE_OFFSET + 1];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op72(OPARGS) /*GIRO 2o: o=L2*/
+{
+        *o = vm->ram[vm->l][GIRO_BASE_OFFSET + 2];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op73(OPARGS) /*GIRO 3o: o=L3*/
+{
+        *o = vm->ram[vm->l][GIRO_BASE_OFFSET + 3];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op74(OPARGS) /*GIRO 4o: o=L4*/
+{
+        *o = vm->ram[vm->l][GIRO_BASE_OFFSET + 4];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op75(OPARGS) /*GIRO 5o: o=L5*/
+{
+        *o = vm->ram[vm->l][GIRO_BASE_OFFSET + 5];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op76(OPARGS) /*GIRO 6o: o=L6*/
+{
+        *o = vm->ram[vm->l][GIRO_BASE_OFFSET + 6];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op77(OPARGS) /*GIRO 7o: o=L7*/
+{
+        *o = vm->ram[vm->l][GIRO_BASE_OFFSET + 7];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op78(OPARGS) /*GIRO o0: L0=o*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 0] = *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op79(OPARGS) /*GIRO o1: L1=o*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 1] = *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op7A(OPARGS) /*GIRO o2: L2=o*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 2] = *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op7B(OPARGS) /*GIRO o3: L3=o*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 3] = *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op7C(OPARGS) /*GIRO o4: L4=o*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 4] = *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op7D(OPARGS) /*GIRO o5: L5=o*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 5] = *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op7E(OPARGS) /*GIRO o6: L6=o*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 6] = *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op7F(OPARGS) /*GIRO o7: L7=o*/
+{
+        vm->ram[vm->l][GIRO_BASE_OFFSET + 7] = *o;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op80(OPARGS) /*PAIR no: o=ram[c][pc++]*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        *o = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op81(OPARGS) /*PAIR END*/
+{
+        vm->scrounge = 0x81;
+        return OP_EXIT;
+}
+
+OPINLINE int
+op82(OPARGS) /*PAIR SCROUNGE_NL*/
+{
+        vm->scrounge = 0x82;
+        return OP_EXIT;
+}
+
+OPINLINE int
+op83(OPARGS) /*PAIR ng: g=ram[c][pc++]*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        vm->g = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op84(OPARGS) /*PAIR nr: r=ram[c][pc++]*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        *r = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op85(OPARGS) /*PAIR ni: i=ram[c][pc++]*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        vm->i = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op86(OPARGS) /*PAIR ns: sor=ram[c][pc++]*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        vm->sor = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op87(OPARGS) /*PAIR np: por=ram[c][pc++]*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        vm->por = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op88(OPARGS) /*PAIR ne: e=ram[c][pc++]*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        vm->e_old = vm->e_new;
+        vm->e_new = v;
+        if (vm->eio) { /*Devices see the full state*/
+                vm->pc = *pc;
+                vm->r = *r;
+                vm->o = *o;
+                vm->eio(vm);
+                *r = vm->r;
+                *o = vm->o;
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+op89(OPARGS) /*PAIR na: o+=ram[c][pc++]; if carry then g+=1*/
+{
+        uchar v = (*code)[(*pc)++];
+        int temp;
+
+        temp = *o + v;
+        *o = (uchar) (temp & 0xFF);
+        if (temp>255) vm->g += 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op8A(OPARGS) /*PAIR nb: l+=ram[c][pc++]*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        vm->l += v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op8B(OPARGS) /*PAIR nj: v=ram[c][pc++]; pc=v*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op8C(OPARGS) /*PAIR nw: v=ram[c][pc++]; if i!=0 then pc=v; i--*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        if (vm->i) *pc = v;
+        (vm->i)--; /*Post decrement, either case!*/
+        return OP_NEXT;
+}
+
+OPINLINE int
+op8D(OPARGS) /*PAIR nt: v=ram[c][pc++]; if r!=0 then pc=v*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        if (*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op8E(OPARGS) /*PAIR nf: v=ram[c][pc++]; if r==0 then pc=v*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        if (!*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op8F(OPARGS) /*PAIR nc: v=ram[c][pc++]; i=pc; co=c; pc=0; c=v; l--*/
+{
+        uchar v = (*code)[(*pc)++];
+
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = v;
+        vm->l--;
+        *code = vm->ram[v];
+        return OP_NEXT;
+}
+
+OPINLINE int
+op90(OPARGS) /*PAIR mo: o=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        *o = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op91(OPARGS) /*PAIR SCROUNGE_MM*/
+{
+        vm->scrounge = 0x91;
+        return OP_EXIT;
+}
+
+OPINLINE int
+op92(OPARGS) /*PAIR SCROUNGE_ML*/
+{
+        vm->scrounge = 0x92;
+        return OP_EXIT;
+}
+
+OPINLINE int
+op93(OPARGS) /*PAIR mg: g=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        vm->g = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op94(OPARGS) /*PAIR mr: r=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        *r = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op95(OPARGS) /*PAIR mi: i=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        vm->i = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op96(OPARGS) /*PAIR ms: sor=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        vm->sor = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op97(OPARGS) /*PAIR mp: por=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        vm->por = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op98(OPARGS) /*PAIR me: e=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        vm->e_old = vm->e_new;
+        vm->e_new = v;
+        if (vm->eio) { /*Devices see the full state*/
+                vm->pc = *pc;
+                vm->r = *r;
+                vm->o = *o;
+                vm->eio(vm);
+                *r = vm->r;
+                *o = vm->o;
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+op99(OPARGS) /*PAIR ma: o+=ram[g][o]; if carry then g+=1*/
+{
+        uchar v = vm->ram[vm->g][*o];
+        int temp;
+
+        temp = *o + v;
+        *o = (uchar) (temp & 0xFF);
+        if (temp>255) vm->g += 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op9A(OPARGS) /*PAIR mb: l+=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        vm->l += v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op9B(OPARGS) /*PAIR mj: pc=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op9C(OPARGS) /*PAIR mw: if i!=0 then pc=ram[g][o]; i--*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        if (vm->i) *pc = v;
+        (vm->i)--; /*Post decrement, either case!*/
+        return OP_NEXT;
+}
+
+OPINLINE int
+op9D(OPARGS) /*PAIR mt: if r!=0 then pc=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        if (*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op9E(OPARGS) /*PAIR mf: if r==0 then pc=ram[g][o]*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        if (!*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+op9F(OPARGS) /*PAIR mc: i=pc; co=c; pc=0; c=ram[g][o]; l--*/
+{
+        uchar v = vm->ram[vm->g][*o];
+
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = v;
+        vm->l--;
+        *code = vm->ram[v];
+        return OP_NEXT;
+}
+
+OPINLINE int
+opA0(OPARGS) /*PAIR lo: o=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        *o = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opA1(OPARGS) /*PAIR SCROUNGE_LM*/
+{
+        vm->scrounge = 0xA1;
+        return OP_EXIT;
+}
+
+OPINLINE int
+opA2(OPARGS) /*PAIR SCROUNGE_LL*/
+{
+        vm->scrounge = 0xA2;
+        return OP_EXIT;
+}
+
+OPINLINE int
+opA3(OPARGS) /*PAIR lg: g=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        vm->g = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opA4(OPARGS) /*PAIR lr: r=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        *r = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opA5(OPARGS) /*PAIR li: i=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        vm->i = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opA6(OPARGS) /*PAIR ls: sor=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        vm->sor = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opA7(OPARGS) /*PAIR lp: por=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        vm->por = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opA8(OPARGS) /*PAIR le: e=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        vm->e_old = vm->e_new;
+        vm->e_new = v;
+        if (vm->eio) { /*Devices see the full state*/
+                vm->pc = *pc;
+                vm->r = *r;
+                vm->o = *o;
+                vm->eio(vm);
+                *r = vm->r;
+                *o = vm->o;
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+opA9(OPARGS) /*PAIR la: o+=ram[l][o]; if carry then g+=1*/
+{
+        uchar v = vm->ram[vm->l][*o];
+        int temp;
+
+        temp = *o + v;
+        *o = (uchar) (temp & 0xFF);
+        if (temp>255) vm->g += 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opAA(OPARGS) /*PAIR lb: l+=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        vm->l += v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opAB(OPARGS) /*PAIR lj: pc=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opAC(OPARGS) /*PAIR lw: if i!=0 then pc=ram[l][o]; i--*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        if (vm->i) *pc = v;
+        (vm->i)--; /*Post decrement, either case!*/
+        return OP_NEXT;
+}
+
+OPINLINE int
+opAD(OPARGS) /*PAIR lt: if r!=0 then pc=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        if (*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opAE(OPARGS) /*PAIR lf: if r==0 then pc=ram[l][o]*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        if (!*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opAF(OPARGS) /*PAIR lc: i=pc; co=c; pc=0; c=ram[l][o]; l--*/
+{
+        uchar v = vm->ram[vm->l][*o];
+
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = v;
+        vm->l--;
+        *code = vm->ram[v];
+        return OP_NEXT;
+}
+
+OPINLINE int
+opB0(OPARGS) /*PAIR go: o=g*/
+{
+        uchar v = vm->g;
+
+        *o = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opB1(OPARGS) /*PAIR gm: ram[g][o]=g*/
+{
+        uchar v = vm->g;
+
+        vm->ram[vm->g][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opB2(OPARGS) /*PAIR gl: ram[l][o]=g*/
+{
+        uchar v = vm->g;
+
+        vm->ram[vm->l][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opB3(OPARGS) /*PAIR SCROUNGE_GG*/
+{
+        vm->scrounge = 0xB3;
+        return OP_EXIT;
+}
+
+OPINLINE int
+opB4(OPARGS) /*PAIR gr: r=g*/
+{
+        uchar v = vm->g;
+
+        *r = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opB5(OPARGS) /*PAIR gi: i=g*/
+{
+        uchar v = vm->g;
+
+        vm->i = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opB6(OPARGS) /*PAIR gs: sor=g*/
+{
+        uchar v = vm->g;
+
+        vm->sor = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opB7(OPARGS) /*PAIR gp: por=g*/
+{
+        uchar v = vm->g;
+
+        vm->por = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opB8(OPARGS) /*PAIR ge: e=g*/
+{
+        uchar v = vm->g;
+
+        vm->e_old = vm->e_new;
+        vm->e_new = v;
+        if (vm->eio) { /*Devices see the full state*/
+                vm->pc = *pc;
+                vm->r = *r;
+                vm->o = *o;
+                vm->eio(vm);
+                *r = vm->r;
+                *o = vm->o;
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+opB9(OPARGS) /*PAIR ga: o+=g; if carry then g+=1*/
+{
+        uchar v = vm->g;
+        int temp;
+
+        temp = *o + v;
+        *o = (uchar) (temp & 0xFF);
+        if (temp>255) vm->g += 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opBA(OPARGS) /*PAIR gb: l+=g*/
+{
+        uchar v = vm->g;
+
+        vm->l += v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opBB(OPARGS) /*PAIR gj: pc=g*/
+{
+        uchar v = vm->g;
+
+        *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opBC(OPARGS) /*PAIR gw: if i!=0 then pc=g; i--*/
+{
+        uchar v = vm->g;
+
+        if (vm->i) *pc = v;
+        (vm->i)--; /*Post decrement, either case!*/
+        return OP_NEXT;
+}
+
+OPINLINE int
+opBD(OPARGS) /*PAIR gt: if r!=0 then pc=g*/
+{
+        uchar v = vm->g;
+
+        if (*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opBE(OPARGS) /*PAIR gf: if r==0 then pc=g*/
+{
+        uchar v = vm->g;
+
+        if (!*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opBF(OPARGS) /*PAIR gc: i=pc; co=c; pc=0; c=g; l--*/
+{
+        uchar v = vm->g;
+
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = v;
+        vm->l--;
+        *code = vm->ram[v];
+        return OP_NEXT;
+}
+
+OPINLINE int
+opC0(OPARGS) /*PAIR ro: o=r*/
+{
+        uchar v = *r;
+
+        *o = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opC1(OPARGS) /*PAIR rm: ram[g][o]=r*/
+{
+        uchar v = *r;
+
+        vm->ram[vm->g][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opC2(OPARGS) /*PAIR rl: ram[l][o]=r*/
+{
+        uchar v = *r;
+
+        vm->ram[vm->l][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opC3(OPARGS) /*PAIR rg: g=r*/
+{
+        uchar v = *r;
+
+        vm->g = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opC4(OPARGS) /*PAIR SCROUNGE_RR*/
+{
+        vm->scrounge = 0xC4;
+        return OP_EXIT;
+}
+
+OPINLINE int
+opC5(OPARGS) /*PAIR ri: i=r*/
+{
+        uchar v = *r;
+
+        vm->i = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opC6(OPARGS) /*PAIR rs: sor=r*/
+{
+        uchar v = *r;
+
+        vm->sor = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opC7(OPARGS) /*PAIR rp: por=r*/
+{
+        uchar v = *r;
+
+        vm->por = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opC8(OPARGS) /*PAIR re: e=r*/
+{
+        uchar v = *r;
+
+        vm->e_old = vm->e_new;
+        vm->e_new = v;
+        if (vm->eio) { /*Devices see the full state*/
+                vm->pc = *pc;
+                vm->r = *r;
+                vm->o = *o;
+                vm->eio(vm);
+                *r = vm->r;
+                *o = vm->o;
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+opC9(OPARGS) /*PAIR ra: o+=r; if carry then g+=1*/
+{
+        uchar v = *r;
+        int temp;
+
+        temp = *o + v;
+        *o = (uchar) (temp & 0xFF);
+        if (temp>255) vm->g += 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opCA(OPARGS) /*PAIR rb: l+=r*/
+{
+        uchar v = *r;
+
+        vm->l += v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opCB(OPARGS) /*PAIR rj: pc=r*/
+{
+        uchar v = *r;
+
+        *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opCC(OPARGS) /*PAIR rw: if i!=0 then pc=r; i--*/
+{
+        uchar v = *r;
+
+        if (vm->i) *pc = v;
+        (vm->i)--; /*Post decrement, either case!*/
+        return OP_NEXT;
+}
+
+OPINLINE int
+opCD(OPARGS) /*PAIR rt: if r!=0 then pc=r*/
+{
+        uchar v = *r;
+
+        if (*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opCE(OPARGS) /*PAIR rf: if r==0 then pc=r*/
+{
+        uchar v = *r;
+
+        if (!*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opCF(OPARGS) /*PAIR rc: i=pc; co=c; pc=0; c=r; l--*/
+{
+        uchar v = *r;
+
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = v;
+        vm->l--;
+        *code = vm->ram[v];
+        return OP_NEXT;
+}
+
+OPINLINE int
+opD0(OPARGS) /*PAIR io: o=i*/
+{
+        uchar v = vm->i;
+
+        *o = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opD1(OPARGS) /*PAIR im: ram[g][o]=i*/
+{
+        uchar v = vm->i;
+
+        vm->ram[vm->g][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opD2(OPARGS) /*PAIR il: ram[l][o]=i*/
+{
+        uchar v = vm->i;
+
+        vm->ram[vm->l][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opD3(OPARGS) /*PAIR ig: g=i*/
+{
+        uchar v = vm->i;
+
+        vm->g = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opD4(OPARGS) /*PAIR ir: r=i*/
+{
+        uchar v = vm->i;
+
+        *r = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opD5(OPARGS) /*PAIR SCROUNGE_II*/
+{
+        vm->scrounge = 0xD5;
+        return OP_EXIT;
+}
+
+OPINLINE int
+opD6(OPARGS) /*PAIR is: sor=i*/
+{
+        uchar v = vm->i;
+
+        vm->sor = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opD7(OPARGS) /*PAIR ip: por=i*/
+{
+        uchar v = vm->i;
+
+        vm->por = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opD8(OPARGS) /*PAIR ie: e=i*/
+{
+        uchar v = vm->i;
+
+        vm->e_old = vm->e_new;
+        vm->e_new = v;
+        if (vm->eio) { /*Devices see the full state*/
+                vm->pc = *pc;
+                vm->r = *r;
+                vm->o = *o;
+                vm->eio(vm);
+                *r = vm->r;
+                *o = vm->o;
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+opD9(OPARGS) /*PAIR ia: o+=i; if carry then g+=1*/
+{
+        uchar v = vm->i;
+        int temp;
+
+        temp = *o + v;
+        *o = (uchar) (temp & 0xFF);
+        if (temp>255) vm->g += 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opDA(OPARGS) /*PAIR ib: l+=i*/
+{
+        uchar v = vm->i;
+
+        vm->l += v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opDB(OPARGS) /*PAIR ij: pc=i*/
+{
+        uchar v = vm->i;
+
+        *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opDC(OPARGS) /*PAIR iw: if i!=0 then pc=i; i--*/
+{
+        uchar v = vm->i;
+
+        if (vm->i) *pc = v;
+        (vm->i)--; /*Post decrement, either case!*/
+        return OP_NEXT;
+}
+
+OPINLINE int
+opDD(OPARGS) /*PAIR it: if r!=0 then pc=i*/
+{
+        uchar v = vm->i;
+
+        if (*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opDE(OPARGS) /*PAIR if: if r==0 then pc=i*/
+{
+        uchar v = vm->i;
+
+        if (!*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opDF(OPARGS) /*PAIR ic: v=i; i=pc; co=c; pc=0; c=v; l--*/
+{
+        uchar v = vm->i;
+
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = v;
+        vm->l--;
+        *code = vm->ram[v];
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE0(OPARGS) /*PAIR so: o=sir*/
+{
+        uchar v = vm->sir;
+
+        *o = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE1(OPARGS) /*PAIR sm: ram[g][o]=sir*/
+{
+        uchar v = vm->sir;
+
+        vm->ram[vm->g][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE2(OPARGS) /*PAIR sl: ram[l][o]=sir*/
+{
+        uchar v = vm->sir;
+
+        vm->ram[vm->l][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE3(OPARGS) /*PAIR sg: g=sir*/
+{
+        uchar v = vm->sir;
+
+        vm->g = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE4(OPARGS) /*PAIR sr: r=sir*/
+{
+        uchar v = vm->sir;
+
+        *r = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE5(OPARGS) /*PAIR si: i=sir*/
+{
+        uchar v = vm->sir;
+
+        vm->i = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE6(OPARGS) /*PAIR ss: sor=sir*/
+{
+        uchar v = vm->sir;
+
+        vm->sor = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE7(OPARGS) /*PAIR sp: por=sir*/
+{
+        uchar v = vm->sir;
+
+        vm->por = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE8(OPARGS) /*PAIR se: e=sir*/
+{
+        uchar v = vm->sir;
+
+        vm->e_old = vm->e_new;
+        vm->e_new = v;
+        if (vm->eio) { /*Devices see the full state*/
+                vm->pc = *pc;
+                vm->r = *r;
+                vm->o = *o;
+                vm->eio(vm);
+                *r = vm->r;
+                *o = vm->o;
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+opE9(OPARGS) /*PAIR sa: o+=sir; if carry then g+=1*/
+{
+        uchar v = vm->sir;
+        int temp;
+
+        temp = *o + v;
+        *o = (uchar) (temp & 0xFF);
+        if (temp>255) vm->g += 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opEA(OPARGS) /*PAIR sb: l+=sir*/
+{
+        uchar v = vm->sir;
+
+        vm->l += v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opEB(OPARGS) /*PAIR sj: pc=sir*/
+{
+        uchar v = vm->sir;
+
+        *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opEC(OPARGS) /*PAIR sw: if i!=0 then pc=sir; i--*/
+{
+        uchar v = vm->sir;
+
+        if (vm->i) *pc = v;
+        (vm->i)--; /*Post decrement, either case!*/
+        return OP_NEXT;
+}
+
+OPINLINE int
+opED(OPARGS) /*PAIR st: if r!=0 then pc=sir*/
+{
+        uchar v = vm->sir;
+
+        if (*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opEE(OPARGS) /*PAIR sf: if r==0 then pc=sir*/
+{
+        uchar v = vm->sir;
+
+        if (!*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opEF(OPARGS) /*PAIR sc: i=pc; co=c; pc=0; c=sir; l--*/
+{
+        uchar v = vm->sir;
+
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = v;
+        vm->l--;
+        *code = vm->ram[v];
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF0(OPARGS) /*PAIR po: o=pir*/
+{
+        uchar v = vm->pir;
+
+        *o = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF1(OPARGS) /*PAIR pm: ram[g][o]=pir*/
+{
+        uchar v = vm->pir;
+
+        vm->ram[vm->g][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF2(OPARGS) /*PAIR pl: ram[l][o]=pir*/
+{
+        uchar v = vm->pir;
+
+        vm->ram[vm->l][*o] = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF3(OPARGS) /*PAIR pg: g=pir*/
+{
+        uchar v = vm->pir;
+
+        vm->g = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF4(OPARGS) /*PAIR pr: r=pir*/
+{
+        uchar v = vm->pir;
+
+        *r = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF5(OPARGS) /*PAIR pi: i=pir*/
+{
+        uchar v = vm->pir;
+
+        vm->i = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF6(OPARGS) /*PAIR ps: sor=pir*/
+{
+        uchar v = vm->pir;
+
+        vm->sor = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF7(OPARGS) /*PAIR pp: por=pir*/
+{
+        uchar v = vm->pir;
+
+        vm->por = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF8(OPARGS) /*PAIR pe: e=pir*/
+{
+        uchar v = vm->pir;
+
+        vm->e_old = vm->e_new;
+        vm->e_new = v;
+        if (vm->eio) { /*Devices see the full state*/
+                vm->pc = *pc;
+                vm->r = *r;
+                vm->o = *o;
+                vm->eio(vm);
+                *r = vm->r;
+                *o = vm->o;
+        }
+        return OP_NEXT;
+}
+
+OPINLINE int
+opF9(OPARGS) /*PAIR pa: o+=pir; if carry then g+=1*/
+{
+        uchar v = vm->pir;
+        int temp;
+
+        temp = *o + v;
+        *o = (uchar) (temp & 0xFF);
+        if (temp>255) vm->g += 1;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opFA(OPARGS) /*PAIR pb: l+=pir*/
+{
+        uchar v = vm->pir;
+
+        vm->l += v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opFB(OPARGS) /*PAIR pj: pc=pir*/
+{
+        uchar v = vm->pir;
+
+        *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opFC(OPARGS) /*PAIR pw: if i!=0 then pc=pir; i--*/
+{
+        uchar v = vm->pir;
+
+        if (vm->i) *pc = v;
+        (vm->i)--; /*Post decrement, either case!*/
+        return OP_NEXT;
+}
+
+OPINLINE int
+opFD(OPARGS) /*PAIR pt: if r!=0 then pc=pir*/
+{
+        uchar v = vm->pir;
+
+        if (*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opFE(OPARGS) /*PAIR pf: if r==0 then pc=pir*/
+{
+        uchar v = vm->pir;
+
+        if (!*r) *pc = v;
+        return OP_NEXT;
+}
+
+OPINLINE int
+opFF(OPARGS) /*PAIR pc: i=pc; co=c; pc=0; c=pir; l--*/
+{
+        uchar v = vm->pir;
+
+        vm->i = *pc;
+        vm->co = vm->c;
+        *pc = 0;
+        vm->c = v;
+        vm->l--;
+        *code = vm->ram[v];
+        return OP_NEXT;
+}
+
+
+/* X(op) for every opcode op in hex
+*/
+
+#define MYTH_OPLIST(X) \
+        X(00) X(01) X(02) X(03) X(04) X(05) X(06) X(07) X(08) X(09) X(0A) X(0B) X(0C) X(0D) X(0E) X(0F) \
+        X(10) X(11) X(12) X(13) X(14) X(15) X(16) X(17) X(18) X(19) X(1A) X(1B) X(1C) X(1D) X(1E) X(1F) \
+        X(20) X(21) X(22) X(23) X(24) X(25) X(26) X(27) X(28) X(29) X(2A) X(2B) X(2C) X(2D) X(2E) X(2F) \
+        X(30) X(31) X(32) X(33) X(34) X(35) X(36) X(37) X(38) X(39) X(3A) X(3B) X(3C) X(3D) X(3E) X(3F) \
+        X(40) X(41) X(42) X(43) X(44) X(45) X(46) X(47) X(48) X(49) X(4A) X(4B) X(4C) X(4D) X(4E) X(4F) \
+        X(50) X(51) X(52) X(53) X(54) X(55) X(56) X(57) X(58) X(59) X(5A) X(5B) X(5C) X(5D) X(5E) X(5F) \
+        X(60) X(61) X(62) X(63) X(64) X(65) X(66) X(67) X(68) X(69) X(6A) X(6B) X(6C) X(6D) X(6E) X(6F) \
+        X(70) X(71) X(72) X(73) X(74) X(75) X(76) X(77) X(78) X(79) X(7A) X(7B) X(7C) X(7D) X(7E) X(7F) \
+        X(80) X(81) X(82) X(83) X(84) X(85) X(86) X(87) X(88) X(89) X(8A) X(8B) X(8C) X(8D) X(8E) X(8F) \
+        X(90) X(91) X(92) X(93) X(94) X(95) X(96) X(97) X(98) X(99) X(9A) X(9B) X(9C) X(9D) X(9E) X(9F) \
+        X(A0) X(A1) X(A2) X(A3) X(A4) X(A5) X(A6) X(A7) X(A8) X(A9) X(AA) X(AB) X(AC) X(AD) X(AE) X(AF) \
+        X(B0) X(B1) X(B2) X(B3) X(B4) X(B5) X(B6) X(B7) X(B8) X(B9) X(BA) X(BB) X(BC) X(BD) X(BE) X(BF) \
+        X(C0) X(C1) X(C2) X(C3) X(C4) X(C5) X(C6) X(C7) X(C8) X(C9) X(CA) X(CB) X(CC) X(CD) X(CE) X(CF) \
+        X(D0) X(D1) X(D2) X(D3) X(D4) X(D5) X(D6) X(D7) X(D8) X(D9) X(DA) X(DB) X(DC) X(DD) X(DE) X(DF) \
+        X(E0) X(E1) X(E2) X(E3) X(E4) X(E5) X(E6) X(E7) X(E8) X(E9) X(EA) X(EB) X(EC) X(ED) X(EE) X(EF) \
+        X(F0) X(F1) X(F2) X(F3) X(F4) X(F5) X(F6) X(F7) X(F8) X(F9) X(FA) X(FB) X(FC) X(FD) X(FE) X(FF)
+
+static int (*myth_optab[256])(OPARGS) = {
+        op00, op01, op02, op03, op04, op05, op06, op07,
+        op08, op09, op0A, op0B, op0C, op0D, op0E, op0F,
+        op10, op11, op12, op13, op14, op15, op16, op17,
+        op18, op19, op1A, op1B, op1C, op1D, op1E, op1F,
+        op20, op21, op22, op23, op24, op25, op26, op27,
+        op28, op29, op2A, op2B, op2C, op2D, op2E, op2F,
+        op30, op31, op32, op33, op34, op35, op36, op37,
+        op38, op39, op3A, op3B, op3C, op3D, op3E, op3F,
+        op40, op41, op42, op43, op44, op45, op46, op47,
+        op48, op49, op4A, op4B, op4C, op4D, op4E, op4F,
+        op50, op51, op52, op53, op54, op55, op56, op57,
+        op58, op59, op5A, op5B, op5C, op5D, op5E, op5F,
+        op60, op61, op62, op63, op64, op65, op66, op67,
+        op68, op69, op6A, op6B, op6C, op6D, op6E, op6F,
+        op70, op71, op72, op73, op74, op75, op76, op77,
+        op78, op79, op7A, op7B, op7C, op7D, op7E, op7F,
+        op80, op81, op82, op83, op84, op85, op86, op87,
+        op88, op89, op8A, op8B, op8C, op8D, op8E, op8F,
+        op90, op91, op92, op93, op94, op95, op96, op97,
+        op98, op99, op9A, op9B, op9C, op9D, op9E, op9F,
+        opA0, opA1, opA2, opA3, opA4, opA5, opA6, opA7,
+        opA8, opA9, opAA, opAB, opAC, opAD, opAE, opAF,
+        opB0, opB1, opB2, opB3, opB4, opB5, opB6, opB7,
+        opB8, opB9, opBA, opBB, opBC, opBD, opBE, opBF,
+        opC0, opC1, opC2, opC3, opC4, opC5, opC6, opC7,
+        opC8, opC9, opCA, opCB, opCC, opCD, opCE, opCF,
+        opD0, opD1, opD2, opD3, opD4, opD5, opD6, opD7,
+        opD8, opD9, opDA, opDB, opDC, opDD, opDE, opDF,
+        opE0, opE1, opE2, opE3, opE4, opE5, opE6, opE7,
+        opE8, opE9, opEA, opEB, opEC, opED, opEE, opEF,
+        opF0, opF1, opF2, opF3, opF4, opF5, opF6, opF7,
+        opF8, opF9, opFA, opFB, opFC, opFD, opFE, opFF,
+};
+
+/* Disassembler: mnemonic and length in bytes,
+   inline so that units without one stay warning free
+*/
+
+OPINLINE const char*
+myth_opname(int op)
+{
+        static const char *name[256] = {
+                "NOP", "SSI", "SSO", "SCL", "SCH", "RET", "COR", "OWN",
+                "P4", "P1", "P2", "P3", "M4", "M3", "M2", "M1",
+                "CLR", "IDO", "OCR", "OCO", "SLR", "SLO", "SRR", "SRO",
+                "AND", "IOR", "EOR", "ADD", "CAR", "RLO", "REO", "RGO",
+                "*0", "*1", "*2", "*3", "*4", "*5", "*6", "*7",
+                "*8", "*9", "*10", "*11", "*12", "*13", "*14", "*15",
+                "*16", "*17", "*18", "*19", "*20", "*21", "*22", "*23",
+                "*24", "*25", "*26", "*27", "*28", "*29", "*30", "*31",
+                "0g", "1g", "2g", "3g", "4g", "5g", "6g", "7g",
+                "g0", "g1", "g2", "g3", "g4", "g5", "g6", "g7",
+                "0i", "1i", "2i", "3i", "4i", "5i", "6i", "7i",
+                "i0", "i1", "i2", "i3", "i4", "i5", "i6", "i7",
+                "0r", "1r", "2r", "3r", "4r", "5r", "6r", "7r",
+                "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+                "0o", "1o", "2o", "3o", "4o", "5o", "6o", "7o",
+                "o0", "o1", "o2", "o3", "o4", "o5", "o6", "o7",
+                "no", "END", "SCROUNGE_NL", "ng", "nr", "ni", "ns", "np",
+                "ne", "na", "nb", "nj", "nw", "nt", "nf", "nc",
+                "mo", "SCROUNGE_MM", "SCROUNGE_ML", "mg", "mr", "mi", "ms", "mp",
+                "me", "ma", "mb", "mj", "mw", "mt", "mf", "mc",
+                "lo", "SCROUNGE_LM", "SCROUNGE_LL", "lg", "lr", "li", "ls", "lp",
+                "le", "la", "lb", "lj", "lw", "lt", "lf", "lc",
+                "go", "gm", "gl", "SCROUNGE_GG", "gr", "gi", "gs", "gp",
+                "ge", "ga", "gb", "gj", "gw", "gt", "gf", "gc",
+                "ro", "rm", "rl", "rg", "SCROUNGE_RR", "ri", "rs", "rp",
+                "re", "ra", "rb", "rj", "rw", "rt", "rf", "rc",
+                "io", "im", "il", "ig", "ir", "SCROUNGE_II", "is", "ip",
+                "ie", "ia", "ib", "ij", "iw", "it", "if", "ic",
+                "so", "sm", "sl", "sg", "sr", "si", "ss", "sp",
+                "se", "sa", "sb", "sj", "sw", "st", "sf", "sc",
+                "po", "pm", "pl", "pg", "pr", "pi", "ps", "pp",
+                "pe", "pa", "pb", "pj", "pw", "pt", "pf", "pc",
+        };
+
+        return name[op];
+}
+
+OPINLINE int
+myth_oplen(int op)
+{
+        static uchar len[256] = {
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+                1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        };
+
+        return len[op];
+}
+
+#endif
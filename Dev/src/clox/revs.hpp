@@ -0,0 +1,606 @@
+#ifndef __REVS_HPP__
+#define __REVS_HPP__ 1
+
+/* ISA descriptors of the older Sonne 8 revisions for myth.hpp
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+   myth::Verilog    Rev. Myth as in Prototype/verilog/mythlib.c:
+                    256 pages of 128 bytes, A/B/xMx addressing,
+                    GET-PUT at the end of the G and L pages
+   myth::Abuladdin  Prototype board as in Prototype/sonne_run.c:
+                    64K flat, A/B accumulators, alu_op register,
+                    optionally with the ALU read from its ROM image
+
+   Semantics follow those emulators opcode for opcode, including
+   their quirks, so images run unchanged. Both engines keep all
+   registers in the state struct.
+*/
+
+#include "myth.hpp"
+
+namespace myth {
+
+struct VerilogVm /*Register file and RAM of mythlib.c*/
+{
+        uchar reg_G, reg_D, reg_O, reg_R, reg_I, reg_A, reg_B, reg_BIO;
+        uchar reg_C, reg_L, reg_E, reg_SIR, reg_SOR, reg_PIR, reg_POR;
+        uchar reg_PC, reg_xMx;
+        uchar par_ready, ser_clock;
+
+        uchar quit; /*Set by NOP and P writes (quitf)*/
+        uchar ram[0x8000];
+};
+
+struct Verilog
+{
+        typedef VerilogVm State;
+
+        enum { LHS_N, LHS_M, LHS_D, LHS_O, LHS_R, LHS_I, LHS_S, LHS_P };
+        enum { RHS_G, RHS_M, RHS_D, RHS_O, RHS_R, RHS_I, RHS_S, RHS_P,
+               RHS_E, RHS_X, RHS_J, RHS_T, RHS_F, RHS_C, RHS_A, RHS_B };
+
+        struct Regs {
+                uchar c, g, pc;
+                uint addr() const { return 128 * (pc&128 ? g : c) + (pc&127); }
+        };
+
+        static uchar
+        fetch(State &vm) /*myth_fetch()*/
+        {
+                uchar t = vm.reg_PC++;
+                return vm.ram[128 * (t&128 ? vm.reg_G : vm.reg_C) + (t&127)];
+        }
+
+        struct Live {
+                Live(State&) {}
+                uchar fetch(State &vm) { return Verilog::fetch(vm); }
+                Regs regs(State &vm) const { return Regs{vm.reg_C, vm.reg_G, (uchar) (vm.reg_PC-1)}; }
+                void spill(State&) const {}
+                void reload(State&) {}
+        };
+
+        static constexpr int machine = MYST_VERILOG;
+        static constexpr int pgsize = 128;
+        static constexpr int npages = 256;
+        static constexpr int nregs = 19;
+        static constexpr long legacysize = 19 + 256 + 0x8000 + 16; /*Raw sasm dump*/
+
+        static constexpr uchar State::*regtab[nregs] = { /*Order of myth_regs()*/
+                &State::reg_G, &State::reg_D, &State::reg_O, &State::reg_R, &State::reg_I,
+                &State::reg_A, &State::reg_B, &State::reg_BIO, &State::reg_C, &State::reg_L,
+                &State::reg_E, &State::reg_SIR, &State::reg_SOR, &State::reg_PIR, &State::reg_POR,
+                &State::reg_PC, &State::reg_xMx, &State::par_ready, &State::ser_clock
+        };
+
+        static uchar *mem(State &vm) { return vm.ram; }
+
+        static void
+        getregs(State &vm, uchar *regs)
+        {
+                for (int k=0; k<nregs; k++) regs[k] = vm.*regtab[k];
+        }
+
+        static void
+        setregs(State &vm, uchar *regs)
+        {
+                for (int k=0; k<nregs; k++) vm.*regtab[k] = regs[k];
+        }
+
+        static int
+        loadraw(State &vm, uchar *img, long n)
+        {
+                if (n < legacysize) return MYST_EMAGIC;
+                setregs(vm, img);
+                memmove(vm.ram, img + nregs + 256, sizeof vm.ram);
+                return 0;
+        }
+
+        static void
+        boot(State &vm) /*myth_reset_warm()*/
+        {
+                vm.reg_L = 255;
+                vm.reg_G = 255;
+                vm.ser_clock = 0;
+                vm.par_ready = 1;
+                vm.reg_C = 0;
+                vm.reg_PC = 0;
+        }
+
+        static void begin(State &vm) { vm.quit = 0; }
+        static bool halted(State &vm) { return vm.quit; }
+
+        static uint
+        maddr(State &vm) /*M operand*/
+        {
+                uchar t = vm.reg_xMx;
+                return 128 * (t&128 ? vm.reg_L : vm.reg_D) + (t&127);
+        }
+
+        static void
+        jump(State &vm, uchar val)
+        {
+                vm.reg_BIO = vm.reg_PC;
+                vm.reg_PC = val;
+        }
+
+        static void
+        trap(State &vm, uchar addr)
+        {
+                vm.reg_O = vm.reg_PC;
+                vm.reg_PC = 0;
+                vm.reg_D = vm.reg_C;
+                vm.reg_C = addr;
+        }
+
+        template<int Src>
+        static inline uchar
+        get(State &vm)
+        {
+                if constexpr (Src == LHS_N) return fetch(vm);
+                if constexpr (Src == LHS_M) return vm.ram[maddr(vm)];
+                if constexpr (Src == LHS_D) return vm.reg_D;
+                if constexpr (Src == LHS_O) return vm.reg_O;
+                if constexpr (Src == LHS_R) return vm.reg_R;
+                if constexpr (Src == LHS_I) return vm.reg_I;
+                if constexpr (Src == LHS_S) {
+                        vm.par_ready = 1;
+                        return vm.reg_SIR;
+                }
+                if constexpr (Src == LHS_P) return vm.reg_PIR;
+        }
+
+        template<int Dst>
+        static inline int
+        put(State &vm, uchar val)
+        {
+                if constexpr (Dst == RHS_G) vm.reg_G = val;
+                if constexpr (Dst == RHS_M) vm.ram[maddr(vm)] = val;
+                if constexpr (Dst == RHS_D) vm.reg_D = val;
+                if constexpr (Dst == RHS_O) vm.reg_O = val;
+                if constexpr (Dst == RHS_R) vm.reg_R = val;
+                if constexpr (Dst == RHS_I) vm.reg_I = val;
+                if constexpr (Dst == RHS_S) vm.reg_SOR = val;
+                if constexpr (Dst == RHS_P) { /*myth_parallel_out()*/
+                        vm.reg_POR = val;
+                        vm.par_ready = 1;
+                        vm.quit = 1;
+                        return OP_EXIT;
+                }
+                if constexpr (Dst == RHS_E) vm.reg_E = val;
+                if constexpr (Dst == RHS_X) {
+                        vm.reg_I--;
+                        if (vm.reg_I) jump(vm, val);
+                }
+                if constexpr (Dst == RHS_J) jump(vm, val);
+                if constexpr (Dst == RHS_T) if (vm.reg_R) jump(vm, val);
+                if constexpr (Dst == RHS_F) if (!vm.reg_R) jump(vm, val);
+                if constexpr (Dst == RHS_C) trap(vm, val);
+                if constexpr (Dst == RHS_A) vm.reg_A = vm.reg_xMx = val;
+                if constexpr (Dst == RHS_B) vm.reg_B = vm.reg_xMx = val;
+                return OP_NEXT;
+        }
+
+        template<int Op>
+        static inline int
+        exec(State &vm, Live&, long&)
+        {
+                constexpr int src = Op>>4 & 7, dst = Op & 15;
+
+                if constexpr (Op & 0x80) { /*PAIR and its scrounges*/
+                        if constexpr (src == LHS_N && dst == RHS_M) { /*RET*/
+                                vm.reg_PC = vm.reg_O;
+                                vm.reg_C = vm.reg_D;
+                        }
+                        else if constexpr (src == LHS_M && dst == RHS_M) vm.reg_L = 255;
+                        else if constexpr (src == LHS_O && dst == RHS_C) vm.reg_R = vm.reg_C;
+                        else if constexpr (src == LHS_D && dst == RHS_C) vm.reg_R = vm.reg_BIO;
+                        else if constexpr (src != 0 && src == dst) ;
+                        else return put<dst>(vm, get<src>(vm));
+                        return OP_NEXT;
+                }
+                else if constexpr (Op & 0x40) { /*GETPUT*/
+                        constexpr int guide = Op & 3, offs = Op>>4 & 3;
+                        uint addr = 128 * ((Op & 4 ? vm.reg_L : vm.reg_G) + 1) - 4 + offs;
+                        uchar *reg = guide == 0 ? &vm.reg_A : guide == 1 ? &vm.reg_B
+                                : guide == 2 ? &vm.reg_R : &vm.reg_I;
+
+                        if constexpr (Op & 8) vm.ram[addr] = *reg;
+                        else {
+                                *reg = vm.ram[addr];
+                                if constexpr (guide < 2) vm.reg_xMx = *reg;
+                        }
+                }
+                else if constexpr (Op & 0x20) trap(vm, Op & 31);
+                else if constexpr (Op & 0x10) {
+                        uchar a = vm.reg_A, b = vm.reg_B;
+
+                        switch (Op & 15) {
+                        case 0: vm.reg_R = a; break;
+                        case 1: vm.reg_R = b; break;
+                        case 2: vm.reg_R = ~a; break;
+                        case 3: vm.reg_R = ~b; break;
+                        case 4: vm.reg_R = a << 1; break;
+                        case 5: vm.reg_R = b << 1; break;
+                        case 6: vm.reg_R = a >> 1; break;
+                        case 7: vm.reg_R = b >> 1; break;
+                        case 8: vm.reg_R = a & b; break;
+                        case 9: vm.reg_R = a | b; break;
+                        case 10: vm.reg_R = a ^ b; break;
+                        case 11: vm.reg_R = a + b; break;
+                        case 12: vm.reg_R = (int) a + (int) b > 255 ? 1 : 0; break;
+                        case 13: vm.reg_R = a < b ? 255 : 0; break;
+                        case 14: vm.reg_R = a == b ? 255 : 0; break;
+                        case 15: vm.reg_R = a > b ? 255 : 0; break;
+                        }
+                }
+                else if constexpr (Op & 0x08) {
+                        constexpr uchar addend[8] = {4, 1, 2, 3, 0xFC, 0xFD, 0xFE, 0xFF};
+                        vm.reg_R += addend[Op & 7];
+                }
+                else {
+                        switch (Op & 7) {
+                        case 0: vm.quit = 1; return OP_EXIT; /*NOP*/
+                        case 1: vm.reg_SIR = vm.reg_SIR << 1 | 1; break; /*SSI*/
+                        case 2: vm.reg_SOR <<= 1; break; /*SSO*/
+                        case 3: vm.ser_clock = 0; break;
+                        case 4: vm.ser_clock = 1; break;
+                        case 5: vm.par_ready = 1; break; /*RDY*/
+                        case 6: vm.reg_L -= 1; break; /*NEW*/
+                        case 7: vm.reg_L += 1; break; /*OLD*/
+                        }
+                }
+                return OP_NEXT;
+        }
+
+        static constexpr bool
+        writes(int op)
+        {
+                return ((op & 0x80) && (op & 15) == RHS_M && (op>>4 & 7) > LHS_M)
+                        || (op & 0xC8) == 0x48;
+        }
+
+        template<int Op>
+        static inline uint
+        wraddr(State &vm, Live&)
+        {
+                if constexpr (Op & 0x80) return maddr(vm);
+                else return 128 * ((Op & 4 ? vm.reg_L : vm.reg_G) + 1) - 4 + (Op>>4 & 3);
+        }
+
+        static constexpr bool writese(int op) { return (op & 0x80) && (op & 15) == RHS_E; }
+        static constexpr bool clocking(int op) { return op == 3 || op == 4; }
+        static uchar sclk(State &vm) { return vm.ser_clock; }
+
+        static const char *
+        name(int op)
+        {
+                static const char *tab[256] = {
+                        "NOP", "SSI", "SSO", "SCL", "SCH", "RDY", "NEW", "OLD",
+                        "P4", "P1", "P2", "P3", "M4", "M3", "M2", "M1",
+                        "IDA", "IDB", "OCA", "OCB", "SLA", "SLB", "SRA", "SRB",
+                        "AND", "IOR", "EOR", "ADD", "CAR", "ALB", "AEB", "AGB",
+                        "*0", "*1", "*2", "*3", "*4", "*5", "*6", "*7",
+                        "*8", "*9", "*10", "*11", "*12", "*13", "*14", "*15",
+                        "*16", "*17", "*18", "*19", "*20", "*21", "*22", "*23",
+                        "*24", "*25", "*26", "*27", "*28", "*29", "*30", "*31",
+                        "G0a", "G0b", "G0r", "G0i", "L0a", "L0b", "L0r", "L0i",
+                        "aG0", "bG0", "rG0", "iG0", "aL0", "bL0", "rL0", "iL0",
+                        "G1a", "G1b", "G1r", "G1i", "L1a", "L1b", "L1r", "L1i",
+                        "aG1", "bG1", "rG1", "iG1", "aL1", "bL1", "rL1", "iL1",
+                        "G2a", "G2b", "G2r", "G2i", "L2a", "L2b", "L2r", "L2i",
+                        "aG2", "bG2", "rG2", "iG2", "aL2", "bL2", "rL2", "iL2",
+                        "G3a", "G3b", "G3r", "G3i", "L3a", "L3b", "L3r", "L3i",
+                        "aG3", "bG3", "rG3", "iG3", "aL3", "bL3", "rL3", "iL3",
+                        "NG", "RET", "ND", "NO", "NR", "NI", "NS", "NP",
+                        "NE", "NX", "NJ", "NT", "NF", "NC", "NA", "NB",
+                        "MG", "CLR", "MD", "MO", "MR", "MI", "MS", "MP",
+                        "ME", "MX", "MJ", "MT", "MF", "MC", "MA", "MB",
+                        "DG", "DM", "DD", "DO", "DR", "DI", "DS", "DP",
+                        "DE", "DX", "DJ", "DT", "DF", "BIO", "DA", "DB",
+                        "OG", "OM", "OD", "OO", "OR", "OI", "OS", "OP",
+                        "OE", "OX", "OJ", "OT", "OF", "OC", "OA", "OB",
+                        "RG", "RM", "RD", "RO", "RR", "RI", "RS", "RP",
+                        "RE", "RX", "RJ", "RT", "RF", "CPI", "RA", "RB",
+                        "IG", "IM", "ID", "IO", "IR", "II", "IS", "IP",
+                        "IE", "IX", "IJ", "IT", "IF", "IC", "IA", "IB",
+                        "SG", "SM", "SD", "SO", "SR", "SI", "SS", "SP",
+                        "SE", "SX", "SJ", "ST", "SF", "SC", "SA", "SB",
+                        "PG", "PM", "PD", "PO", "PR", "PI", "PS", "PP",
+                        "PE", "PX", "PJ", "PT", "PF", "PC", "PA", "PB"
+                };
+                return tab[op];
+        }
+
+        static int oplen(int op) { return (op & 0xF0) == 0x80 && op != 0x81 ? 2 : 1; }
+
+        static void
+        trace(int fd, State &vm, const Regs &x, int op)
+        {
+                fprint(fd, "%.2X.%.2X: %-4s", x.c, x.pc, name(op));
+                if (oplen(op) == 2) {
+                        Regs lit = {x.c, x.g, (uchar) (x.pc+1)};
+                        fprint(fd, " %.2X", vm.ram[lit.addr()]);
+                }
+                else
+                        fprint(fd, "   ");
+                fprint(fd, "  A:%.2X B:%.2X R:%.2X O:%.2X D:%.2X I:%.2X L:%.2X\n",
+                        vm.reg_A, vm.reg_B, vm.reg_R, vm.reg_O, vm.reg_D, vm.reg_I, vm.reg_L);
+        }
+};
+
+
+struct AbuladdinVm /*Globals of sonne_run.c*/
+{
+        uchar pc_low, pc_low_copy, pc_high, pc_high_copy;
+        uchar rreg, dreg, greg, aacc, bacc;
+        uchar wsel; /*wptr: 0 aacc, 1 bacc*/
+        uchar sptr, tristate, sclock, serial_in_byte, serial_out_byte;
+        uchar zflag, alu_op, alu_copy, alu_lock;
+        uchar halt; /*Set by the HALT scrounge R->R*/
+
+        uchar memory[256*256];
+};
+
+struct Abuladdin
+{
+        typedef AbuladdinVm State;
+
+        struct Regs {
+                uchar hi, lo;
+                uint addr() const { return hi<<8 | lo; }
+        };
+
+        struct Live {
+                Live(State&) {}
+                uchar fetch(State &vm) { return vm.memory[256*vm.pc_high + vm.pc_low++]; }
+                Regs regs(State &vm) const { return Regs{vm.pc_high, (uchar) (vm.pc_low-1)}; }
+                void spill(State&) const {}
+                void reload(State&) {}
+        };
+
+        static constexpr int machine = MYST_ABULADDIN;
+        static constexpr int pgsize = 256;
+        static constexpr int npages = 256;
+        static constexpr int nregs = 19;
+
+        static constexpr uchar State::*regtab[nregs] = {
+                &State::pc_low, &State::pc_low_copy, &State::pc_high, &State::pc_high_copy,
+                &State::rreg, &State::dreg, &State::greg, &State::aacc, &State::bacc,
+                &State::wsel, &State::sptr, &State::tristate, &State::sclock,
+                &State::serial_in_byte, &State::serial_out_byte,
+                &State::zflag, &State::alu_op, &State::alu_copy, &State::alu_lock
+        };
+
+        static inline uchar *blur; /*ALU look-up ROM (blur3.obj) if set*/
+
+        static uchar *mem(State &vm) { return vm.memory; }
+
+        static void
+        getregs(State &vm, uchar *regs)
+        {
+                for (int k=0; k<nregs; k++) regs[k] = vm.*regtab[k];
+        }
+
+        static void
+        setregs(State &vm, uchar *regs)
+        {
+                for (int k=0; k<nregs; k++) vm.*regtab[k] = regs[k];
+        }
+
+        static int
+        loadraw(State &vm, uchar *img, long n) /*"daffodil" memory dump*/
+        {
+                memset(&vm, 0, sizeof vm);
+                memmove(vm.memory, img, n < (long) sizeof vm.memory ? n : sizeof vm.memory);
+                vm.tristate = 1; /*reset_cpu()*/
+                return 0;
+        }
+
+        static void boot(State&) {}
+        static void begin(State &vm) { vm.halt = 0; }
+        static bool halted(State &vm) { return vm.halt; }
+
+        static uchar
+        alu_result(State &vm)
+        {
+                uchar offs, a = vm.aacc, b = vm.bacc;
+
+                if (vm.alu_lock) return vm.alu_copy;
+                offs = vm.alu_op >> 4;
+                if (offs > 7) offs += 15<<4; /*Sign extend*/
+                if (blur) vm.alu_copy = blur[(vm.alu_op & 15)<<16 | b<<8 | a];
+                else switch (vm.alu_op & 15) {
+                case 0: vm.alu_copy = a; break;
+                case 1: vm.alu_copy = b; break;
+                case 2: vm.alu_copy = ~a; break;
+                case 3: vm.alu_copy = ~b; break;
+                case 4: vm.alu_copy = a << 1; break;
+                case 5: vm.alu_copy = b << 1; break;
+                case 6: vm.alu_copy = a >> 1; break;
+                case 7: vm.alu_copy = b >> 1; break;
+                case 8: vm.alu_copy = a & b; break;
+                case 9: vm.alu_copy = a | b; break;
+                case 10: vm.alu_copy = a ^ b; break;
+                case 11: vm.alu_copy = a + b; break;
+                case 12: vm.alu_copy = (int) a + (int) b > 255 ? 1 : 0; break;
+                case 13: vm.alu_copy = a < b ? 255 : 0; break;
+                case 14: vm.alu_copy = a == b ? 255 : 0; break;
+                case 15: vm.alu_copy = a > b ? 255 : 0; break;
+                }
+                vm.alu_copy += offs;
+                vm.zflag = vm.alu_copy == 0;
+                return vm.alu_copy;
+        }
+
+        static uint
+        effective(State &vm)
+        {
+                uchar w = vm.wsel ? vm.bacc : vm.aacc, page;
+
+                if (w < 128) page = vm.rreg;
+                else if (w < 192) page = vm.greg;
+                else page = vm.sptr;
+                return 256*page + w;
+        }
+
+        static void
+        trap(State &vm, uchar addr)
+        {
+                vm.pc_low_copy = vm.pc_low;
+                vm.pc_low = 0;
+                vm.pc_high_copy = vm.pc_high;
+                vm.pc_high = addr;
+        }
+
+        template<int Src>
+        static inline uchar
+        get(State &vm)
+        {
+                if constexpr (Src == 0) return vm.memory[256*vm.pc_high + vm.pc_low++]; /*L*/
+                if constexpr (Src == 1) return vm.rreg;
+                if constexpr (Src == 2) return vm.memory[effective(vm)];
+                if constexpr (Src == 3) return vm.pc_low_copy; /*X*/
+                if constexpr (Src == 4) return vm.pc_high_copy; /*Y*/
+                if constexpr (Src == 5) return vm.serial_in_byte;
+                if constexpr (Src == 6) return 0; /*par_in()*/
+                if constexpr (Src == 7) return alu_result(vm); /*F*/
+        }
+
+        template<int Dst>
+        static inline void
+        put(State &vm, uchar v)
+        {
+                if constexpr (Dst == 1) vm.rreg = v;
+                if constexpr (Dst == 2) vm.memory[effective(vm)] = v;
+                if constexpr (Dst == 3) vm.pc_low_copy = v;
+                if constexpr (Dst == 4) vm.pc_high_copy = v;
+                if constexpr (Dst == 5) vm.serial_out_byte = v;
+                if constexpr (Dst == 6) vm.tristate = 0; /*par_out()*/
+                if constexpr (Dst == 7) {
+                        vm.alu_op = v;
+                        vm.alu_lock = 0;
+                }
+                if constexpr (Dst == 8) vm.dreg = v;
+                if constexpr (Dst == 9) vm.greg = v;
+                if constexpr (Dst == 10) { /*J*/
+                        vm.pc_high = v;
+                        vm.pc_low = 0;
+                }
+                if constexpr (Dst == 11) { /*T*/
+                        alu_result(vm);
+                        if (!vm.zflag) vm.pc_high = v;
+                        vm.pc_low = 0;
+                }
+                if constexpr (Dst == 12) { /*E*/
+                        alu_result(vm);
+                        if (vm.zflag) vm.pc_high = v;
+                        vm.pc_low = 0;
+                }
+                if constexpr (Dst == 13) trap(vm, v);
+                if constexpr (Dst == 14 || Dst == 15) {
+                        (Dst == 14 ? vm.aacc : vm.bacc) = v;
+                        vm.wsel = Dst == 15;
+                        vm.alu_lock = 1;
+                }
+        }
+
+        template<int Op>
+        static inline int
+        exec(State &vm, Live&, long&)
+        {
+                constexpr int src = Op>>4 & 7, dst = Op & 15;
+
+                if constexpr (!(Op & 0x80)) { /*SIGNAL*/
+                        if constexpr (dst == 0) {
+                                switch (src) {
+                                case 1: vm.serial_in_byte = vm.serial_in_byte << 1 | 1; break;
+                                case 2: vm.serial_out_byte <<= 1; break;
+                                case 3: vm.sclock = 0; break;
+                                case 4: vm.sclock = 1; break;
+                                case 5: vm.tristate = 1; break; /*OFF*/
+                                case 6: vm.sptr++; break; /*LEAVE*/
+                                case 7: vm.sptr--; break; /*ENTER*/
+                                }
+                        }
+                        else if constexpr (src == 0 && dst == 2) { /*RET*/
+                                vm.pc_low = vm.pc_low_copy;
+                                vm.pc_high = vm.pc_high_copy;
+                        }
+                        else if constexpr (src == 2 && dst == 2) { /*LID*/
+                                vm.pc_high++;
+                                vm.pc_low = 0;
+                        }
+                        else if constexpr (src == 1 && dst == 1) { /*HALT*/
+                                vm.halt = 1;
+                                return OP_EXIT;
+                        }
+                        else put<dst>(vm, get<src>(vm));
+                }
+                else if constexpr (Op & 0x40) { /*GETPUT*/
+                        uint addr = Op & 16 ? vm.sptr*256 + 192 + (Op & 7) : vm.greg*256 + 128 + (Op & 7);
+                        uchar &acc = Op & 32 ? vm.bacc : vm.aacc;
+
+                        if constexpr (Op & 8) vm.memory[addr] = acc;
+                        else acc = vm.memory[addr];
+                }
+                else trap(vm, Op & 63);
+                return OP_NEXT;
+        }
+
+        static constexpr bool
+        writes(int op)
+        {
+                return (!(op & 0x80) && (op & 15) == 2 && (op>>4 & 7) != 0 && (op>>4 & 7) != 2)
+                        || (op & 0xC8) == 0xC8;
+        }
+
+        template<int Op>
+        static inline uint
+        wraddr(State &vm, Live&)
+        {
+                if constexpr (!(Op & 0x80)) return effective(vm);
+                else return Op & 16 ? vm.sptr*256 + 192 + (Op & 7) : vm.greg*256 + 128 + (Op & 7);
+        }
+
+        static constexpr bool writese(int) { return false; } /*Devices select via D*/
+        static constexpr bool clocking(int op) { return op == 0x30 || op == 0x40; }
+        static uchar sclk(State &vm) { return vm.sclock; }
+
+        static const char *
+        name(int op)
+        {
+                static char tab[256][8];
+                static const char *sys[8] = {"NOP", "SCI", "SCO", "SCL", "SCH", "OFF", "LEAVE", "ENTER"};
+                int k;
+
+                if (tab[0][0] == 0)
+                        for (k=0; k<256; k++) {
+                                if (k == 0x02) snprint(tab[k], 8, "RET");
+                                else if (k == 0x22) snprint(tab[k], 8, "LID");
+                                else if (k < 0x80 && (k & 15) == 0) snprint(tab[k], 8, "%s", sys[k>>4]);
+                                else if (k < 0x80) snprint(tab[k], 8, "%c%c", "LRMXYSPF"[k>>4], "-RMXYSPFDGJTECAB"[k&15]);
+                                else if (k < 0xC0) snprint(tab[k], 8, "*%d", k & 63);
+                                else if (k & 8) snprint(tab[k], 8, "%c%c%d", k & 32 ? 'b' : 'a', k & 16 ? 'L' : 'G', k & 7);
+                                else snprint(tab[k], 8, "%c%d%c", k & 16 ? 'L' : 'G', k & 7, k & 32 ? 'b' : 'a');
+                        }
+                return tab[op];
+        }
+
+        static int oplen(int op) { return op < 0x10 && op != 0 && op != 0x02 ? 2 : 1; }
+
+        static void
+        trace(int fd, State &vm, const Regs &x, int op)
+        {
+                fprint(fd, "%.2X.%.2X: %-5s", x.hi, x.lo, name(op));
+                if (oplen(op) == 2)
+                        fprint(fd, " %.2X", vm.memory[x.hi<<8 | (uchar) (x.lo+1)]);
+                else
+                        fprint(fd, "   ");
+                fprint(fd, "  A:%.2X B:%.2X R:%.2X D:%.2X G:%.2X S:%.2X F:%.2X\n",
+                        vm.aacc, vm.bacc, vm.rreg, vm.dreg, vm.greg, vm.sptr, vm.alu_op);
+        }
+};
+
+}
+
+#endif
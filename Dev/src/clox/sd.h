@@ -0,0 +1,317 @@
+#ifndef __SD_H__
+#define __SD_H__ 1
+
+/* SD card (SPI mode, SDHC block addressing) for Sonne 8 Rev. Myth/LOX
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+   Backed by the host image file "sdcard.myth", attached only if
+   present (make one with e.g. truncate -s 32M sdcard.myth).
+   Blocks go through an LRU cache with write-back, and
+   sequential CMD17 reads trigger read-ahead.
+
+   Supported: CMD0, CMD8, CMD55/ACMD41, CMD58, CMD16, CMD17, CMD24
+*/
+
+#include <u.h>
+#include <libc.h>
+#include "myth.h"
+#include "io.h"
+#include "spi.h"
+
+#define SDBLK 512
+#define SDCACHE 64  /*Cached blocks*/
+#define SDAHEAD 8   /*Blocks read ahead on sequential CMD17*/
+
+#define R1_IDLE 0x01
+#define R1_ILLEGAL 0x04
+#define R1_ADDRESS 0x20
+#define R1_PARAM 0x40
+
+#define SD_TOKEN 0xFE /*Start block token*/
+
+enum { SDCMD, SDWTOKEN, SDWDATA };
+
+struct sdblk {
+        vlong n;     /*Block number, -1 if unused*/
+        ulong used;  /*LRU stamp*/
+        int dirty;
+        uchar data[SDBLK];
+};
+
+struct sdcard {
+        int fd;      /*-1 if no image is open*/
+        vlong nblk;  /*Image size in blocks*/
+        int idle;    /*In idle state until ACMD41*/
+        int app;     /*Next command is an ACMD*/
+        int state;
+
+        uchar cmd[6]; /*Command frame being received*/
+        int ncmd;
+
+        uchar out[SDBLK+8]; /*Queued response bytes*/
+        int nout, pout;
+
+        uchar wbuf[SDBLK+2]; /*Write data and CRC*/
+        int nw;
+        vlong wblk;
+
+        vlong lastrd; /*Block of previous CMD17*/
+        ulong clock;
+        struct sdblk cache[SDCACHE];
+
+        ulong hits, misses;
+};
+
+struct sdblk*
+sd_lookup(struct sdcard *sd, vlong n)
+{
+        int k;
+
+        for (k=0; k<SDCACHE; k++)
+                if (sd->cache[k].n == n) {
+                        sd->cache[k].used = ++sd->clock;
+                        return &sd->cache[k];
+                }
+        return nil;
+}
+
+void
+sd_writeback(struct sdcard *sd, struct sdblk *b)
+{
+        if (b->dirty && b->n >= 0)
+                pwrite(sd->fd, b->data, SDBLK, b->n * SDBLK);
+        b->dirty = 0;
+}
+
+struct sdblk*
+sd_victim(struct sdcard *sd) /*Least recently used slot, written back*/
+{
+        struct sdblk *b;
+        int k;
+
+        b = &sd->cache[0];
+        for (k=1; k<SDCACHE; k++)
+                if (sd->cache[k].used < b->used) b = &sd->cache[k];
+        sd_writeback(sd, b);
+        b->n = -1;
+        b->used = ++sd->clock;
+        return b;
+}
+
+void
+sd_readahead(struct sdcard *sd, vlong n)
+{
+        static uchar buf[SDAHEAD*SDBLK];
+        struct sdblk *b;
+        long got;
+        int k;
+
+        if (n >= sd->nblk) return;
+        got = pread(sd->fd, buf, sizeof buf, n * SDBLK) / SDBLK;
+        for (k=0; k<got && n+k < sd->nblk; k++) {
+                if (sd_lookup(sd, n+k)) continue;
+                b = sd_victim(sd);
+                b->n = n+k;
+                memmove(b->data, buf + k*SDBLK, SDBLK);
+        }
+}
+
+struct sdblk*
+sd_block(struct sdcard *sd, vlong n)
+{
+        struct sdblk *b;
+
+        if ((b = sd_lookup(sd, n)) != nil) {
+                sd->hits++;
+                return b;
+        }
+        sd->misses++;
+        b = sd_victim(sd);
+        b->n = n;
+        if (pread(sd->fd, b->data, SDBLK, n * SDBLK) != SDBLK)
+                memset(b->data, 0, SDBLK); /*Hole or short image*/
+        return b;
+}
+
+void
+sd_flush(struct sdcard *sd)
+{
+        int k;
+
+        for (k=0; k<SDCACHE; k++)
+                sd_writeback(sd, &sd->cache[k]);
+}
+
+
+void
+sd_queue(struct sdcard *sd, uchar b)
+{
+        sd->out[sd->nout++] = b;
+}
+
+void
+sd_command(struct sdcard *sd)
+{
+        uchar cmd = sd->cmd[0] & 0x3F;
+        ulong arg = sd->cmd[1]<<24 | sd->cmd[2]<<16 | sd->cmd[3]<<8 | sd->cmd[4];
+        uchar r1 = sd->idle ? R1_IDLE : 0;
+        int app = sd->app;
+        struct sdblk *b;
+
+        sd->nout = sd->pout = 0;
+        sd->app = 0;
+        sd_queue(sd, 0xFF); /*NCR, one byte before the response*/
+
+        if (app && cmd == 41) { /*ACMD41: leave idle state*/
+                sd->idle = 0;
+                sd_queue(sd, 0);
+                return;
+        }
+        switch(cmd){
+        case 0:
+                sd->idle = 1;
+                sd_queue(sd, R1_IDLE);
+                break;
+        case 8: /*R7, echo voltage and check pattern*/
+                sd_queue(sd, r1);
+                sd_queue(sd, 0); sd_queue(sd, 0);
+                sd_queue(sd, sd->cmd[3] & 0x0F);
+                sd_queue(sd, sd->cmd[4]);
+                break;
+        case 55:
+                sd->app = 1;
+                sd_queue(sd, r1);
+                break;
+        case 58: /*R3, OCR: powered up, CCS (block addressing)*/
+                sd_queue(sd, r1);
+                sd_queue(sd, sd->idle ? 0x40 : 0xC0);
+                sd_queue(sd, 0xFF); sd_queue(sd, 0x80); sd_queue(sd, 0);
+                break;
+        case 16:
+                sd_queue(sd, arg == SDBLK ? r1 : r1 | R1_PARAM);
+                break;
+        case 17:
+                if (sd->idle || arg >= sd->nblk) {
+                        sd_queue(sd, sd->idle ? R1_ILLEGAL|R1_IDLE : R1_ADDRESS);
+                        break;
+                }
+                b = sd_block(sd, arg);
+                sd_queue(sd, 0);
+                sd_queue(sd, 0xFF); /*Access time*/
+                sd_queue(sd, SD_TOKEN);
+                memmove(sd->out + sd->nout, b->data, SDBLK);
+                sd->nout += SDBLK;
+                sd_queue(sd, 0xFF); sd_queue(sd, 0xFF); /*CRC, unchecked*/
+                if (arg == sd->lastrd + 1 && !sd_lookup(sd, arg+1))
+                        sd_readahead(sd, arg+1);
+                sd->lastrd = arg;
+                break;
+        case 24:
+                if (sd->idle || arg >= sd->nblk) {
+                        sd_queue(sd, sd->idle ? R1_ILLEGAL|R1_IDLE : R1_ADDRESS);
+                        break;
+                }
+                sd_queue(sd, 0);
+                sd->wblk = arg;
+                sd->state = SDWTOKEN;
+                break;
+        default:
+                sd_queue(sd, r1 | R1_ILLEGAL);
+        }
+}
+
+uchar
+sd_xfer(struct spislave *s, uchar in)
+{
+        struct sdcard *sd = s->priv;
+        struct sdblk *b;
+
+        switch(sd->state){
+        case SDCMD:
+                if (sd->ncmd || (in & 0xC0) == 0x40) {
+                        sd->cmd[sd->ncmd++] = in;
+                        if (sd->ncmd == 6) {
+                                sd->ncmd = 0;
+                                sd_command(sd);
+                        }
+                }
+                break;
+        case SDWTOKEN:
+                if (in == SD_TOKEN) {
+                        sd->state = SDWDATA;
+                        sd->nw = 0;
+                }
+                break;
+        case SDWDATA:
+                sd->wbuf[sd->nw++] = in;
+                if (sd->nw < SDBLK+2) break;
+                if ((b = sd_lookup(sd, sd->wblk)) == nil) {
+                        b = sd_victim(sd);
+                        b->n = sd->wblk;
+                }
+                memmove(b->data, sd->wbuf, SDBLK);
+                b->dirty = 1;
+                sd->state = SDCMD;
+                sd->nout = sd->pout = 0;
+                sd_queue(sd, 0x05); /*Data accepted*/
+                sd_queue(sd, 0); /*Busy*/
+                break;
+        }
+        return sd->pout < sd->nout ? sd->out[sd->pout++] : 0xFF;
+}
+
+void
+sd_select(struct spislave *s, int on)
+{
+        struct sdcard *sd = s->priv;
+
+        sd->ncmd = 0;
+        sd->nout = sd->pout = 0;
+        if (sd->state == SDWDATA) sd->state = SDCMD; /*Aborted write*/
+}
+
+struct sdcard sdcard = {-1};
+struct spislave sdspi = {"sdcard", sd_xfer, sd_select, &sdcard};
+struct device sdcs = {"sdcs", cs_enable, cs_disable, nil, &sdspi};
+
+int
+sdopen(char *fname)
+{
+        Dir *d;
+        int k;
+
+        sdcard.fd = open(fname, ORDWR);
+        if (sdcard.fd == -1) return -1;
+        d = dirfstat(sdcard.fd);
+        if (d == nil) {
+                close(sdcard.fd);
+                sdcard.fd = -1;
+                return -1;
+        }
+        sdcard.nblk = d->length / SDBLK;
+        free(d);
+
+        sdcard.idle = 1;
+        sdcard.lastrd = -2;
+        for (k=0; k<SDCACHE; k++) sdcard.cache[k].n = -1;
+        return 0;
+}
+
+void
+sdclose(void)
+{
+        if (sdcard.fd == -1) return; /*Not attached*/
+        sd_flush(&sdcard);
+        close(sdcard.fd);
+        sdcard.fd = -1;
+}
+
+void
+sdinit(struct myth_vm *vm) /*Attach SD card, see lox.h*/
+{
+        USED(vm);
+        if (sdopen("sdcard.myth") == 0)
+                devattach(SL5_SDCS, &sdcs);
+}
+
+#endif
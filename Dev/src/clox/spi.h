@@ -0,0 +1,236 @@
+#ifndef __SPI_H__
+#define __SPI_H__ 1
+
+/* SPI bus and slave models for Sonne 8 micro-controller Rev. Myth/LOX
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+   Mode 0: the slave samples MOSI on the rising SCLK edge and
+   presents its next MISO bit after the falling edge. Slaves
+   only implement byte exchange; spibit() adapts them to
+   bit-banged clocking, spibyte() is the core's fast path.
+   Both produce identical register and line states.
+*/
+
+#include <u.h>
+#include <libc.h>
+#include "myth.h"
+#include "io.h"
+
+struct spislave {
+        char *name;
+        uchar (*xfer)(struct spislave*, uchar); /*Byte in, next byte out*/
+        void (*select)(struct spislave*, int);  /*Chip select asserted/released*/
+        void *priv;
+
+        uchar rx;   /*Bits received so far*/
+        uchar tx;   /*Byte being shifted out, MSB on MISO*/
+        uchar nbit; /*Bit position within byte*/
+};
+
+struct spislave *spisel; /*Currently selected slave, or nil*/
+
+
+void
+spibit(struct myth_vm *vm) /*SCLK edge, bit-level adapter*/
+{
+        struct spislave *s = spisel;
+
+        if (s == nil) return;
+        if (vm->sclk) {
+                s->rx = (s->rx << 1) | vm->mosi;
+                return;
+        }
+        s->tx <<= 1;
+        if (++s->nbit == 8) {
+                s->nbit = 0;
+                s->tx = s->xfer(s, s->rx);
+        }
+        vm->miso = s->tx >> 7;
+}
+
+int
+spibyte(struct myth_vm *vm) /*Complete a canonical byte run at once*/
+{
+        struct spislave *s = spisel;
+        uchar in;
+
+        if (s == nil || s->nbit) return 0;
+        in = s->tx;
+        s->rx = vm->sor;
+        s->tx = s->xfer(s, vm->sor);
+
+        vm->sir = in;
+        vm->mosi = vm->sor & 1;
+        vm->sor = 0;
+        vm->miso = s->tx >> 7;
+        return 1;
+}
+
+void
+spiselect(struct myth_vm *vm, struct spislave *s)
+{
+        if (spisel && spisel->select) spisel->select(spisel, 0);
+        spisel = s;
+        if (s == nil) return;
+        s->rx = 0;
+        s->nbit = 0;
+        s->tx = 0xFF; /*Idle MISO until the first byte is clocked*/
+        if (s->select) s->select(s, 1);
+        vm->miso = 1;
+}
+
+
+/* Chip select devices on the SL lines, priv is the slave
+*/
+
+void
+cs_enable(struct myth_vm *vm, struct device *d)
+{
+        spiselect(vm, d->priv);
+}
+
+void
+cs_disable(struct myth_vm *vm, struct device *d)
+{
+        if (spisel == d->priv) spiselect(vm, nil);
+}
+
+
+/* 25LC256 serial EEPROM, 32KB with 64 byte write pages
+*/
+
+#define EESIZE 0x8000
+#define EEPAGE 64
+
+#define EE_WRSR 0x01
+#define EE_WRITE 0x02
+#define EE_READ 0x03
+#define EE_WRDI 0x04
+#define EE_RDSR 0x05
+#define EE_WREN 0x06
+
+#define EE_WEL 0x02 /*Status: write enable latch*/
+
+enum { EECMD, EEADRH, EEADRL, EEDATA, EESTAT, EEWRSR, EEIDLE };
+
+struct eeprom {
+        uchar mem[EESIZE];
+        uchar status;
+        uchar cmd;
+        int state;
+        int addr;
+        int written; /*Write cycle pending until deselect*/
+        int dirty;   /*Needs saving to host file*/
+        char *fname;
+};
+
+uchar
+ee_xfer(struct spislave *s, uchar b)
+{
+        struct eeprom *ee = s->priv;
+
+        switch(ee->state){
+        case EECMD:
+                ee->cmd = b;
+                switch(b){
+                case EE_READ:
+                case EE_WRITE: ee->state = EEADRH; break;
+                case EE_WREN: ee->status |= EE_WEL; ee->state = EEIDLE; break;
+                case EE_WRDI: ee->status &= ~EE_WEL; ee->state = EEIDLE; break;
+                case EE_RDSR: ee->state = EESTAT; return ee->status;
+                case EE_WRSR: ee->state = EEWRSR; break;
+                default: ee->state = EEIDLE;
+                }
+                return 0xFF;
+        case EEADRH:
+                ee->addr = b << 8;
+                ee->state = EEADRL;
+                return 0xFF;
+        case EEADRL:
+                ee->addr = (ee->addr | b) & (EESIZE-1);
+                if (ee->cmd == EE_WRITE) {
+                        ee->state = ee->status & EE_WEL ? EEDATA : EEIDLE;
+                        return 0xFF;
+                }
+                ee->state = EEDATA;
+                return ee->mem[ee->addr];
+        case EEDATA:
+                if (ee->cmd == EE_READ) { /*Sequential read wraps around*/
+                        ee->addr = (ee->addr + 1) & (EESIZE-1);
+                        return ee->mem[ee->addr];
+                }
+                if (ee->mem[ee->addr] != b) {
+                        ee->mem[ee->addr] = b;
+                        ee->dirty = 1;
+                }
+                ee->written = 1;
+                /*Page write wraps within the page*/
+                ee->addr = (ee->addr & ~(EEPAGE-1)) | ((ee->addr+1) & (EEPAGE-1));
+                return 0xFF;
+        case EESTAT:
+                return ee->status;
+        case EEWRSR:
+                if (ee->status & EE_WEL)
+                        ee->status = (ee->status & EE_WEL) | (b & 0x8C);
+                ee->state = EEIDLE;
+                return 0xFF;
+        }
+        return 0xFF;
+}
+
+void
+ee_select(struct spislave *s, int on)
+{
+        struct eeprom *ee = s->priv;
+
+        ee->state = EECMD;
+        if (!on && ee->written) { /*Write cycle completes, WEL resets*/
+                ee->written = 0;
+                ee->status &= ~EE_WEL;
+        }
+}
+
+struct eeprom eeprom;
+struct spislave eespi = {"25lc256", ee_xfer, ee_select, &eeprom};
+struct device eecs = {"eecs", cs_enable, cs_disable, nil, &eespi};
+
+void
+eeload(char *fname)
+{
+        int fdesc;
+
+        eeprom.fname = fname;
+        memset(eeprom.mem, 0xFF, EESIZE); /*Erased*/
+        fdesc = open(fname, OREAD);
+        if (fdesc != -1) {
+                readn(fdesc, eeprom.mem, EESIZE);
+                close(fdesc);
+        }
+}
+
+void
+eesave(void)
+{
+        int fdesc;
+
+        if (!eeprom.dirty) return;
+        fdesc = create(eeprom.fname, OWRITE, 0666);
+        if (fdesc != -1) {
+                write(fdesc, eeprom.mem, EESIZE);
+                close(fdesc);
+                eeprom.dirty = 0;
+        }
+        else print("EEPROM write error\n");
+}
+
+
+void
+spiinit(struct myth_vm *vm) /*Attach SPI slaves, see lox.h*/
+{
+        eeload("eeprom.myth");
+        devattach(SL4_EECS, &eecs);
+        vm->sio = spibit;
+        vm->spibyte = spibyte;
+}
+
+#endif
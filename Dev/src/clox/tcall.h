@@ -0,0 +1,101 @@
+#ifndef __TCALL_H__
+#define __TCALL_H__ 1
+
+/* Tail-call threaded engine for Sonne 8 micro-controller Rev. Myth/LOX
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+   Every opcode has a handler function of its own, which ends
+   by calling the handler of the next opcode through tcall_table[].
+   PC, R and O travel as arguments so they stay in host registers,
+   the rest of the machine state lives in struct myth_vm.
+
+   Compilers with guaranteed tail calls (clang, GCC 15) turn each
+   of these calls into a jump. Others rely on sibling call
+   optimisation (-O2), and tcall_run() then runs the budget in
+   slices of TCALL_CHUNK so the stack stays bounded regardless.
+
+   The opcode handlers of optab.h are shared with myth.h,
+   including the eio, sio and spibyte hooks, but the engine returns to the caller after any
+   scrounge opcode (vm->scrounge set) or when the budget is spent.
+*/
+
+#include <u.h>
+#include <libc.h>
+#include "myth.h"
+
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 15)
+#define MUSTTAIL __attribute__((musttail))
+#else
+#define MUSTTAIL
+#define TCALL_CHUNK 4096 /*Instructions per slice, bounds call depth*/
+#endif
+
+/* n is the budget left after the running instruction
+*/
+#define TCARGS struct myth_vm *vm, uchar *code, uchar pc, uchar r, uchar o, long n
+
+typedef long tcall_fn(TCARGS);
+static tcall_fn *tcall_table[256];
+
+long tcall_run(struct myth_vm *vm, long budget);
+
+
+static long
+tc_exit(TCARGS) /*Spill argument registers, unwind*/
+{
+        USED(code);
+        vm->pc = pc;
+        vm->r = r;
+        vm->o = o;
+        return n;
+}
+
+
+/* One handler per opcode: execute, then dispatch the next
+   opcode with a tail call
+*/
+
+#define TCOP(x) \
+static long \
+tc##x(TCARGS) \
+{ \
+        if (op##x(vm, &code, &pc, &r, &o, &n) == OP_EXIT || n <= 0) { \
+                MUSTTAIL return tc_exit(vm, code, pc, r, o, n); \
+        } \
+        MUSTTAIL return tcall_table[code[pc]](vm, code, pc+1, r, o, n-1); \
+}
+
+MYTH_OPLIST(TCOP)
+
+#define TCENT(x) tc##x,
+
+static tcall_fn *tcall_table[256] = {
+        MYTH_OPLIST(TCENT)
+};
+
+
+/* Execute up to 'budget' instructions, returns the number
+   retired (counted as by myth_step())
+*/
+
+long
+tcall_run(struct myth_vm *vm, long budget)
+{
+        long left, n;
+        uchar *code;
+
+        vm->scrounge = 0;
+        left = budget;
+        while (left > 0 && !vm->scrounge) {
+                n = left;
+#ifdef TCALL_CHUNK
+                if (n > TCALL_CHUNK) n = TCALL_CHUNK;
+#endif
+                code = vm->ram[vm->c];
+                left -= n - tcall_table[code[vm->pc]](vm, code,
+                        vm->pc+1, vm->r, vm->o, n-1);
+        }
+        return budget - left;
+}
+
+#endif
@@ -7,14 +7,18 @@
   The code uses a dispatch/computed jump table.
   Compile with GCC which has the required && operator
   for dereferencing LABELs as void*
+
+  vtable_run() executes at most n instructions on RAM[][] and
+  the register file reg[] (order as declared below, E to L).
+  Returns the unspent budget once END (scrounge NM) executes,
+  or -1 if the budget runs out first. Used by bench.c.
 */
 
 #include <stdint.h>
 
-int
-main()
+long
+vtable_run(uint8_t RAM[256][256], uint8_t reg[16], long n)
 {
-    uint8_t RAM[256][256] __attribute__((aligned(8)));
     uint8_t E, SCLK, MISO, MOSI, SIR, SOR, PIR, POR;
     uint8_t R, O, I, PC, CO, C, G, L;
 
@@ -155,20 +159,28 @@ main()
         &&PAIR_PW, &&PAIR_PT, &&PAIR_PF, &&PAIR_PC,
     };
 
-    C = PC = 0;
-
-    /*
-      To do: Load a program into RAM[][] here!
-    */
+    E = reg[0]; SCLK = reg[1]; MISO = reg[2]; MOSI = reg[3];
+    SIR = reg[4]; SOR = reg[5]; PIR = reg[6]; POR = reg[7];
+    R = reg[8]; O = reg[9]; I = reg[10]; PC = reg[11];
+    CO = reg[12]; C = reg[13]; G = reg[14]; L = reg[15];
 
     /*
       Instruction pump loop:
       Fetch an opcode, run it, repeat.
+      PC points behind the opcode while it runs,
+      literals are fetched with PC++.
     */
 
-    NEXT: PC++;
-    EXEC: goto *dispatch_table[RAM[C][PC]];
-    END: return 0; /* Route one of the SCROUNGES here for example */
+    NEXT:
+    EXEC: if (n-- == 0) goto END;
+          goto *dispatch_table[RAM[C][PC++]];
+
+    END: /* Budget spent, or scrounge NM routed here */
+    reg[0] = E; reg[1] = SCLK; reg[2] = MISO; reg[3] = MOSI;
+    reg[4] = SIR; reg[5] = SOR; reg[6] = PIR; reg[7] = POR;
+    reg[8] = R; reg[9] = O; reg[10] = I; reg[11] = PC;
+    reg[12] = CO; reg[13] = C; reg[14] = G; reg[15] = L;
+    return n;
 
     /*
       The remaining lines define 256 instruction routines
@@ -328,22 +340,22 @@ main()
 
     /* PAIR */
 
-    /*80h*/   PAIR_NO: O = RAM[C][PC]; goto NEXT;
-    /*81h*/   SCROUNGE_NM: goto NEXT;
+    /*80h*/   PAIR_NO: O = RAM[C][PC++]; goto NEXT;
+    /*81h*/   SCROUNGE_NM: goto END; /*LOX END*/
     /*82h*/   SCROUNGE_NL: goto NEXT;
-    /*83h*/   PAIR_NG: G = RAM[C][PC]; goto NEXT;
-    /*84h*/   PAIR_NR: R = RAM[C][PC]; goto NEXT;
-    /*85h*/   PAIR_NI: I = RAM[C][PC]; goto NEXT;
-    /*86h*/   PAIR_NS: SOR = RAM[C][PC]; goto NEXT;
-    /*87h*/   PAIR_NP: POR = RAM[C][PC]; goto NEXT;
-    /*88h*/   PAIR_NE: E = RAM[C][PC]; goto NEXT;
-    /*89h*/   PAIR_NA: TEMP = O + RAM[C][PC]; O = (uint8_t)(TEMP & 0xFF); if (TEMP>0xFF) G++; goto NEXT;
-    /*8Ah*/   PAIR_NB: L += RAM[C][PC]; goto EXEC;
+    /*83h*/   PAIR_NG: G = RAM[C][PC++]; goto NEXT;
+    /*84h*/   PAIR_NR: R = RAM[C][PC++]; goto NEXT;
+    /*85h*/   PAIR_NI: I = RAM[C][PC++]; goto NEXT;
+    /*86h*/   PAIR_NS: SOR = RAM[C][PC++]; goto NEXT;
+    /*87h*/   PAIR_NP: POR = RAM[C][PC++]; goto NEXT;
+    /*88h*/   PAIR_NE: E = RAM[C][PC++]; goto NEXT;
+    /*89h*/   PAIR_NA: TEMP = O + RAM[C][PC++]; O = (uint8_t)(TEMP & 0xFF); if (TEMP>0xFF) G++; goto NEXT;
+    /*8Ah*/   PAIR_NB: L += RAM[C][PC++]; goto NEXT;
     /*8Bh*/   PAIR_NJ: PC = RAM[C][PC]; goto EXEC;
-    /*8Ch*/   PAIR_NW: if (I--) {PC = RAM[C][PC]; goto EXEC;} else goto NEXT;
-    /*8Dh*/   PAIR_NT: if (R) {PC = RAM[C][PC]; goto EXEC;} else goto NEXT;
-    /*8Eh*/   PAIR_NF: if (!R) {PC = RAM[C][PC]; goto EXEC;} else goto NEXT;
-    /*8Fh*/   PAIR_NC: I = PC; CO = C; L--; PC = 0; C = RAM[C][PC]; goto EXEC;
+    /*8Ch*/   PAIR_NW: TEMP = RAM[C][PC++]; if (I--) PC = TEMP; goto EXEC;
+    /*8Dh*/   PAIR_NT: TEMP = RAM[C][PC++]; if (R) PC = TEMP; goto EXEC;
+    /*8Eh*/   PAIR_NF: TEMP = RAM[C][PC++]; if (!R) PC = TEMP; goto EXEC;
+    /*8Fh*/   PAIR_NC: TEMP = RAM[C][PC++]; I = PC; CO = C; L--; PC = 0; C = TEMP; goto EXEC;
 
     /*90h*/   PAIR_MO: O = RAM[G][O]; goto NEXT;
     /*91h*/   SCROUNGE_MM: goto NEXT;
@@ -377,7 +389,7 @@ main()
     /*ACh*/   PAIR_LW: if (I--) {PC = RAM[L][O]; goto EXEC;} else goto NEXT;
     /*ADh*/   PAIR_LT: if (R) {PC = RAM[L][O]; goto EXEC;} else goto NEXT;
     /*AEh*/   PAIR_LF: if (!R) {PC = RAM[L][O]; goto EXEC;} else goto NEXT;
-    /*AFh*/   PAIR_LC: I = PC; CO = C; L--; PC = 0; C = RAM[L][O]; goto EXEC;
+    /*AFh*/   PAIR_LC: TEMP = RAM[L][O]; I = PC; CO = C; L--; PC = 0; C = TEMP; goto EXEC;
 
     /*B0h*/   PAIR_GO: O = G; goto NEXT;
     /*B1h*/   PAIR_GM: RAM[G][O] = G; goto NEXT;
@@ -425,10 +437,10 @@ main()
     /*D9h*/   PAIR_IA: TEMP = O + I; O = (uint8_t)(TEMP & 0xFF); if (TEMP>0xFF) G++; goto NEXT;
     /*DAh*/   PAIR_IB: L += I; goto EXEC;
     /*DBh*/   PAIR_IJ: PC = I; goto EXEC;
-    /*DCh*/   PAIR_IW: if (I--) {PC = I; goto EXEC;} else goto NEXT;
+    /*DCh*/   PAIR_IW: TEMP = I; if (I--) {PC = TEMP; goto EXEC;} else goto NEXT;
     /*DDh*/   PAIR_IT: if (R) {PC = I; goto EXEC;} else goto NEXT;
     /*DEh*/   PAIR_IF: if (!R) {PC = I; goto EXEC;} else goto NEXT;
-    /*DFh*/   PAIR_IC: I = PC; CO = C; L--; PC = 0; C = I; goto EXEC;
+    /*DFh*/   PAIR_IC: TEMP = I; I = PC; CO = C; L--; PC = 0; C = TEMP; goto EXEC;
 
     /*E0h*/   PAIR_SO: O = SIR; goto NEXT;
     /*E1h*/   PAIR_SM: RAM[G][O] = SIR; goto NEXT;
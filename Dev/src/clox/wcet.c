@@ -0,0 +1,708 @@
+/*
+    Static timing of the routines in a Myth/LOX image, from the
+    image and the concordance goldie writes next to it.
+
+    Each routine is decoded from its entry at offset 0 by
+    following the code, into basic blocks split at the targets
+    of nj, nw, nt and nf with a literal (xJUMP, xJITD, xJRT,
+    xJRF). Calls (nc with a literal, traps) add the time of the
+    page called. A loop is bounded if its only way back is an
+    nw and nothing else in the loop writes I: nw jumps back as
+    often as the ni before the loop says, or 255 times at most
+    if I comes from elsewhere. Other loops need -l, given the
+    address of the jump back and how often it is taken at most;
+    without it the routine has no worst case. Computed jumps
+    and calls, and recursion, are not followed either.
+
+    A loop counts with all its iterations plus the longest way
+    out, so nested and multi-exit loops are overestimated, not
+    missed.
+
+    Pages are listed if the concordance names them with P[...]
+    and their first line is an instruction, and so are the
+    pages they call.
+
+    Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+    Build using:
+    9c wcet.c
+    9l wcet.o
+
+    Run:
+    ./a.out [-f MHz] [-a] [-l PP.OO=n]... [image [listing]]
+    -f clock for the times in us, default 8
+    -a lists every instruction of each routine with its clocks
+*/
+
+#include <u.h>
+#include <libc.h>
+#include "myth.h"
+#include "lox.h"
+#include "myst.h"
+
+#define UNBOUNDED ((vlong)1 << 60)
+#define NONE (-1) /*No path*/
+#define MAXBOUND 64
+
+struct myth_vm vm;
+uchar imgbuf[MYST_MAXSIZE(256, 256, NREGS)];
+char lst[4<<20];
+
+char *src[256][256];     /*Source text at each address, from the listing*/
+char name[256][32];
+uchar code[256];         /*Listed with an instruction at offset 0*/
+
+struct bound {
+        int at;          /*Page<<8 | offset of the jump back*/
+        int n;
+} bound[MAXBOUND];
+int nbound;
+
+struct rout {
+        int state;       /*0 not done, 1 in progress, 2 done*/
+        vlong min, max;  /*Clocks*/
+        char why[80];    /*If not bounded*/
+} rout[256];
+
+int annotate;
+struct cfg *kept[256]; /*For -a*/
+
+
+/* Clocks per instruction. The Verilog core (Prototype/verilog/
+   myth_core.c) takes three for every instruction, fetch, read
+   and write; the literal of a 2 byte instruction is fetched in
+   the read phase.
+*/
+int
+clocks(uchar op)
+{
+        USED(op);
+        return 3;
+}
+
+int
+ispair(uchar op, int dst)
+{
+        return (op & 0x80) && (op & 15) == dst;
+}
+
+int
+istrap(uchar op)
+{
+        return (op & 0xE0) == 0x20;
+}
+
+/* Writes I, other than nw itself
+*/
+int
+writesi(uchar op)
+{
+        if (istrap(op) || ispair(op, xCALL)) return 1;
+        if ((op & 0xF8) == 0x50) return 1; /*GIRO get into i*/
+        return (op & 0x80) && (op & 15) == 5 && (op >> 4 & 7) != 5;
+}
+
+vlong
+add(vlong a, vlong b)
+{
+        if (a == NONE || b == NONE) return NONE;
+        if (a >= UNBOUNDED || b >= UNBOUNDED) return UNBOUNDED;
+        return a + b;
+}
+
+vlong
+mul(vlong a, vlong n)
+{
+        if (a == NONE) return NONE;
+        if (a >= UNBOUNDED) return n ? UNBOUNDED : 0;
+        return a * n;
+}
+
+
+/* One routine under analysis
+*/
+
+enum { MAXBLK = 256 };
+
+struct blk {
+        int first, last; /*Offsets of its first and last instruction*/
+        vlong min, max;
+        int alive;       /*Not yet folded into a loop*/
+        int times;       /*Loop header: jumps back at most, -1 unknown*/
+};
+
+struct cfg {
+        int pg;
+        uchar insn[256]; /*Instruction starts*/
+        int blkof[256];  /*Block starting at an offset, else -1*/
+        struct blk b[MAXBLK];
+        int nb;
+        uchar edge[MAXBLK][MAXBLK];
+        uchar back[MAXBLK][MAXBLK];
+        char *why;
+};
+
+void
+unbounded(struct cfg *g, char *fmt, int off)
+{
+        if (*g->why == 0) snprint(g->why, 80, fmt, g->pg, off);
+}
+
+int
+target(struct cfg *g, int off, int *t)
+{
+        uchar op = vm.ram[g->pg][off];
+
+        if (!(op & 0x80) || (op & 15) < xJUMP || (op & 15) > xJRF) return 0;
+        if (op >> 4 & 7) {
+                unbounded(g, "computed jump at %.2X.%.2X", off);
+                return 0;
+        }
+        *t = vm.ram[g->pg][(off + 1) & 255];
+        return 1;
+}
+
+int
+ends(uchar op)
+{
+        return op == 0x81 || op == RET || op == COR || ispair(op, xJUMP);
+}
+
+void analyse(int pg);
+
+/* Clocks of one instruction, calls included
+*/
+void
+cost(struct cfg *g, int off, vlong *min, vlong *max)
+{
+        uchar op = vm.ram[g->pg][off];
+        int callee;
+
+        *min = *max = clocks(op);
+        if (istrap(op)) callee = op & 31;
+        else if (ispair(op, xCALL)) {
+                if (op >> 4 & 7) {
+                        unbounded(g, "computed call at %.2X.%.2X", off);
+                        *max = UNBOUNDED;
+                        return;
+                }
+                callee = vm.ram[g->pg][(off + 1) & 255];
+        }
+        else return;
+
+        analyse(callee);
+        if (rout[callee].state == 1) {
+                unbounded(g, "recursion at %.2X.%.2X", off);
+                *max = UNBOUNDED;
+                return;
+        }
+        if (rout[callee].max >= UNBOUNDED)
+                unbounded(g, "call at %.2X.%.2X", off);
+        *min = add(*min, rout[callee].min);
+        *max = add(*max, rout[callee].max);
+}
+
+void
+decode(struct cfg *g)
+{
+        int work[256], nwork, off, t, k;
+        uchar lead[256], op;
+
+        memset(lead, 0, sizeof lead);
+        lead[0] = 1;
+        work[0] = 0;
+        nwork = 1;
+        while (nwork > 0) {
+                off = work[--nwork];
+                for (;;) {
+                        if (g->insn[off]) break;
+                        g->insn[off] = 1;
+                        op = vm.ram[g->pg][off];
+                        if (target(g, off, &t)) {
+                                lead[t] = 1;
+                                if (!g->insn[t]) work[nwork++] = t;
+                        }
+                        if (ends(op)) break;
+                        off = (off + myth_oplen(op)) & 255;
+                        if ((op & 0x80) && (op & 15) >= xJITD && (op & 15) <= xJRF)
+                                lead[off] = 1;
+                }
+        }
+
+        /*Blocks in address order*/
+        g->nb = 0;
+        for (off=0; off<256; off++) {
+                g->blkof[off] = -1;
+                if (!g->insn[off] || !lead[off]) continue;
+                g->blkof[off] = g->nb;
+                g->b[g->nb].first = off;
+                g->b[g->nb].alive = 1;
+                g->b[g->nb].times = -2;
+                g->nb++;
+        }
+        for (k=0; k<g->nb; k++) {
+                struct blk *b = &g->b[k];
+                vlong mn, mx;
+
+                b->min = b->max = 0;
+                off = b->first;
+                for (;;) {
+                        op = vm.ram[g->pg][off];
+                        cost(g, off, &mn, &mx);
+                        b->min = add(b->min, mn);
+                        b->max = add(b->max, mx);
+                        b->last = off;
+                        if (target(g, off, &t)) g->edge[k][g->blkof[t]] = 1;
+                        if (ends(op)) break;
+                        off = (off + myth_oplen(op)) & 255;
+                        if (g->blkof[off] != -1) {
+                                g->edge[k][g->blkof[off]] = 1;
+                                break;
+                        }
+                }
+        }
+}
+
+void
+findback(struct cfg *g, int b, uchar *color)
+{
+        int s;
+
+        color[b] = 1;
+        for (s=0; s<g->nb; s++) {
+                if (!g->edge[b][s]) continue;
+                if (color[s] == 1) g->back[b][s] = 1;
+                else if (color[s] == 0) findback(g, s, color);
+        }
+        color[b] = 2;
+}
+
+
+/* Longest or shortest way from block b within the blocks in
+   'in', to a jump back to h (iter) or else out of 'in' or the
+   routine. NONE if there is none, UNBOUNDED on a cycle left in
+   the graph.
+*/
+
+struct walk {
+        uchar *in;
+        int h, iter, worst;
+        vlong memo[MAXBLK];
+        uchar state[MAXBLK];
+};
+
+vlong
+way(struct cfg *g, struct walk *w, int b)
+{
+        vlong best, v;
+        int s, out;
+
+        if (w->state[b] == 2) return w->memo[b];
+        if (w->state[b] == 1) return w->worst ? UNBOUNDED : NONE;
+        w->state[b] = 1;
+        best = NONE;
+        out = 1;
+        for (s=0; s<g->nb; s++) {
+                if (!g->edge[b][s]) continue;
+                out = 0;
+                if (s == w->h) v = w->iter ? 0 : NONE;
+                else if (!w->in[s]) v = w->iter ? NONE : 0;
+                else v = way(g, w, s);
+                if (v == NONE) continue;
+                if (best == NONE || (w->worst ? v > best : v < best)) best = v;
+        }
+        if (out && !w->iter) best = 0; /*RET, END, COR*/
+        v = add(w->worst ? g->b[b].max : g->b[b].min, best);
+        w->state[b] = 2;
+        w->memo[b] = v;
+        return v;
+}
+
+vlong
+walk(struct cfg *g, uchar *in, int from, int h, int iter, int worst)
+{
+        static struct walk w;
+
+        memset(&w, 0, sizeof w);
+        w.in = in;
+        w.h = h;
+        w.iter = iter;
+        w.worst = worst;
+        return way(g, &w, from);
+}
+
+/* The literal of the ni that sets I for the loop at h, through
+   blocks with a single way in, -1 if there is none
+*/
+int
+niabove(struct cfg *g, int h, uchar *in)
+{
+        static uchar none[MAXBLK];
+        int b, s, pre, k, n;
+        uchar op;
+
+        b = h;
+        for (n=0; n<16; n++) {
+                pre = -1;
+                for (s=0; s<g->nb; s++)
+                        if (g->edge[s][b] && !in[s]) {
+                                if (pre != -1) return -1;
+                                pre = s;
+                        }
+                if (pre == -1) return -1;
+                for (k=g->b[pre].last; k>=g->b[pre].first; k--) {
+                        if (!g->insn[k]) continue;
+                        op = vm.ram[g->pg][k];
+                        if (op == (0x80 | 5)) return vm.ram[g->pg][(k + 1) & 255]; /*ni*/
+                        if (writesi(op) || op == (0x80 | xJITD)) return -1;
+                }
+                b = pre;
+                in = none;
+        }
+        return -1;
+}
+
+/* How often the jump back to h is taken at most, -1 if not
+   known. *exact is set if that is also the least. An nw loop
+   that leaves I alone jumps back 255 times at most.
+*/
+int
+loopbound(struct cfg *g, int h, uchar *in, int *exact)
+{
+        int b, s, latch, k, off, n;
+        uchar op;
+
+        latch = -1;
+        for (b=0; b<g->nb; b++)
+                if (g->back[b][h]) {
+                        if (latch != -1) return -1;
+                        latch = b;
+                }
+        off = g->b[latch].last;
+        *exact = 0;
+        for (k=0; k<nbound; k++)
+                if (bound[k].at == (g->pg << 8 | off)) return bound[k].n;
+
+        if (vm.ram[g->pg][off] != (0x80 | xJITD)) return -1;
+        for (b=0; b<g->nb; b++) /*Nothing else in the loop writes I*/
+                if (in[b])
+                        for (k=g->b[b].first; k<=g->b[b].last; k++) {
+                                if (!g->insn[k] || k == off) continue;
+                                op = vm.ram[g->pg][k];
+                                if (writesi(op) || op == (0x80 | xJITD)) return -1;
+                        }
+        n = niabove(g, h, in);
+        if (n < 0) return 255;
+        *exact = 1; /*Unless there is another way out*/
+        for (s=0; s<g->nb; s++)
+                for (b=0; b<g->nb; b++)
+                        if (in[s] && s != latch && g->edge[s][b] && !in[b]) *exact = 0;
+        return n;
+}
+
+/* Fold each loop into its header, inner ones first
+*/
+void
+fold(struct cfg *g)
+{
+        static uchar in[MAXBLK][MAXBLK];
+        int size[MAXBLK], order[MAXBLK], no, h, b, s, k, n, exact, changed;
+        vlong itmax, itmin, exmax, exmin;
+
+        memset(in, 0, sizeof in);
+        no = 0;
+        for (h=0; h<g->nb; h++) {
+                for (b=0; b<g->nb; b++)
+                        if (g->back[b][h]) in[h][b] = 1;
+                if (!memchr(in[h], 1, (uint) g->nb)) continue;
+                do { /*Natural loop: reaches a jump back without passing h*/
+                        changed = 0;
+                        for (b=0; b<g->nb; b++)
+                                if (in[h][b] && b != h)
+                                        for (s=0; s<g->nb; s++)
+                                                if (g->edge[s][b] && !in[h][s] && s != h) {
+                                                        in[h][s] = 1;
+                                                        changed = 1;
+                                                }
+                } while (changed);
+                in[h][h] = 1;
+                size[h] = 0;
+                for (b=0; b<g->nb; b++) size[h] += in[h][b];
+                order[no++] = h;
+        }
+        for (k=1; k<no; k++) /*Smallest first*/
+                for (b=k; b>0 && size[order[b]] < size[order[b-1]]; b--) {
+                        s = order[b]; order[b] = order[b-1]; order[b-1] = s;
+                }
+
+        for (k=0; k<no; k++) {
+                h = order[k];
+                n = loopbound(g, h, in[h], &exact);
+                g->b[h].times = n;
+                for (b=0; b<g->nb; b++)
+                        if (!g->b[b].alive) in[h][b] = 0;
+                itmax = walk(g, in[h], h, h, 1, 1);
+                itmin = walk(g, in[h], h, h, 1, 0);
+                exmax = walk(g, in[h], h, h, 0, 1);
+                exmin = walk(g, in[h], h, h, 0, 0);
+
+                if (n < 0) {
+                        unbounded(g, "loop at %.2X.%.2X", g->b[h].first);
+                        g->b[h].max = UNBOUNDED;
+                        g->b[h].min = exmin;
+                } else {
+                        g->b[h].max = add(mul(itmax, n), exmax);
+                        g->b[h].min = exact ? add(mul(itmin, n), exmin) : exmin;
+                }
+
+                /*The header stands for the loop, with its ways in and out*/
+                for (b=0; b<g->nb; b++) {
+                        if (!in[h][b] || b == h) continue;
+                        for (s=0; s<g->nb; s++) {
+                                if (g->edge[b][s] && !in[h][s]) g->edge[h][s] = 1;
+                                if (g->edge[s][b] && !in[h][s]) g->edge[s][h] = 1;
+                                g->edge[b][s] = g->edge[s][b] = 0;
+                        }
+                        g->b[b].alive = 0;
+                }
+                for (s=0; s<g->nb; s++)
+                        if (in[h][s]) g->edge[h][s] = 0;
+        }
+}
+
+void
+analyse(int pg)
+{
+        static uchar all[MAXBLK];
+        uchar color[MAXBLK];
+        struct cfg *g;
+        int b;
+
+        if (rout[pg].state) return;
+        rout[pg].state = 1;
+        if (!code[pg]) {
+                snprint(rout[pg].why, sizeof rout[pg].why, "no code at %.2X.00", pg);
+                rout[pg].max = UNBOUNDED;
+                rout[pg].state = 2;
+                return;
+        }
+        g = mallocz(sizeof *g, 1);
+        if (g == nil) sysfatal("out of memory");
+        g->pg = pg;
+        g->why = rout[pg].why;
+
+        decode(g);
+        memset(color, 0, sizeof color);
+        findback(g, 0, color);
+        fold(g);
+        for (b=0; b<g->nb; b++) all[b] = g->b[b].alive;
+        rout[pg].max = walk(g, all, 0, -1, 0, 1);
+        rout[pg].min = walk(g, all, 0, -1, 0, 0);
+        if (rout[pg].max >= UNBOUNDED && !*g->why) unbounded(g, "cycle at %.2X.%.2X", 0);
+        if (annotate) kept[pg] = g;
+        else free(g);
+        rout[pg].state = 2;
+}
+
+void
+listing(struct cfg *g)
+{
+        int off, b, callee;
+        uchar op;
+
+        print("%.2Xh %s\n", g->pg, name[g->pg]);
+        for (off=0; off<256; off++) {
+                if (!g->insn[off]) continue;
+                b = g->blkof[off];
+                if (b != -1 && g->b[b].times == -1) print("        loop, not bounded\n");
+                else if (b != -1 && g->b[b].times >= 0)
+                        print("        loop, jumps back at most %d times\n", g->b[b].times);
+
+                op = vm.ram[g->pg][off];
+                print("  %.2X.%.2X: %-4s", g->pg, off, myth_opname(op));
+                if (myth_oplen(op) == 2) print(" %.2X", vm.ram[g->pg][(off + 1) & 255]);
+                else print("   ");
+                print(" %2d", clocks(op));
+                callee = -1;
+                if (istrap(op)) callee = op & 31;
+                else if (ispair(op, xCALL) && !(op >> 4 & 7)) callee = vm.ram[g->pg][(off + 1) & 255];
+                if (callee == -1) print("        ");
+                else if (rout[callee].max >= UNBOUNDED) print(" +?     ");
+                else print(" +%-6lld", rout[callee].max);
+                if (src[g->pg][off]) print("  %s", src[g->pg][off]);
+                print("\n");
+        }
+        print("\n");
+}
+
+
+int
+hexbyte(char *s)
+{
+        int k, v, d;
+
+        v = 0;
+        for (k=0; k<2; k++) {
+                d = s[k];
+                if (d >= '0' && d <= '9') d -= '0';
+                else if (d >= 'A' && d <= 'F') d -= 'A' - 10;
+                else if (d >= 'a' && d <= 'f') d -= 'a' - 10;
+                else return -1;
+                v = v << 4 | d;
+        }
+        return v;
+}
+
+/* PP.OO as goldie prints addresses, -1 if not one
+*/
+int
+address(char *s)
+{
+        int p, o;
+
+        if (strlen(s) < 5 || s[2] != '.') return -1;
+        p = hexbyte(s);
+        o = hexbyte(s + 3);
+        if (p < 0 || o < 0) return -1;
+        return p << 8 | o;
+}
+
+/* First word of a source line is an instruction, O[...] skipped
+*/
+int
+isinsn(char *text)
+{
+        char word[16];
+        int k, n;
+
+        for (;;) {
+                while (*text == ' ' || *text == '\t') text++;
+                if (strncmp(text, "O[", 2)) break;
+                while (*text && *text != ' ' && *text != '\t') text++;
+        }
+        for (n=0; n<15 && text[n] && !strchr(" \t,", text[n]); n++)
+                word[n] = text[n];
+        word[n] = 0;
+        if (word[0] == '*') return 1;
+        for (k=0; k<256; k++)
+                if (!strcmp(word, myth_opname(k))) return 1;
+        return 0;
+}
+
+/* Source text per address and page names from the concordance.
+   Source text starts in column 43, after the address, up to 8
+   bytes of code per line, the lid and the line number.
+*/
+void
+readlisting(char *fname)
+{
+        int fdesc, at, pend, k;
+        long n;
+        char *line, *next, *text, *p, pname[32];
+
+        fdesc = open(fname, OREAD);
+        if (fdesc == -1) sysfatal("cannot open listing");
+        n = readn(fdesc, lst, sizeof lst - 1);
+        close(fdesc);
+        if (n < 0) sysfatal("cannot read listing");
+        lst[n] = 0;
+
+        pend = -1;
+        pname[0] = 0;
+        for (line=lst; *line; line=next) {
+                next = strchr(line, '\n');
+                if (next) *next++ = 0;
+                else next = line + strlen(line);
+
+                at = address(line);
+                if (at != -1) pend = at;
+                if (strlen(line) < 43 || line[36] != ' ' || line[33] < '0' || line[33] > '9')
+                        continue;
+                text = line + 43;
+
+                for (p=text; *p == ' ' || *p == '\t'; p++)
+                        ;
+                if (!strncmp(p, "P[", 2)) {
+                        for (k=0; k<31 && p[k+2] && p[k+2] != ']'; k++)
+                                pname[k] = p[k+2];
+                        pname[k] = 0;
+                }
+                if (pend == -1) continue;
+                if (pname[0] && !name[pend >> 8][0]) strcpy(name[pend >> 8], pname);
+                pname[0] = 0;
+                src[pend >> 8][pend & 255] = text;
+                if ((pend & 255) == 0 && isinsn(text)) code[pend >> 8] = 1;
+                pend = -1;
+        }
+}
+
+void
+load(char *fname)
+{
+        int fdesc, err;
+        long n;
+        uchar regs[NREGS];
+
+        fdesc = open(fname, OREAD);
+        if (fdesc == -1) sysfatal("cannot open image");
+        n = readn(fdesc, imgbuf, sizeof imgbuf);
+        close(fdesc);
+        err = myst_decode(imgbuf, n, MYST_LOX, &vm.ram[0][0], 256, 256, regs, NREGS);
+        if (err) sysfatal("unusable image");
+        unpackregs(&vm, regs);
+}
+
+void
+usage(void)
+{
+        print("Usage: wcet [-f MHz] [-a] [-l PP.OO=n]... [image [listing]]\n");
+        exits("usage");
+}
+
+
+void
+main(int argc, char *argv[])
+{
+        char *image, *lstname;
+        double mhz;
+        int pg, at;
+
+        mhz = 8;
+        for (argc--, argv++; argc > 0 && argv[0][0] == '-'; argc--, argv++) {
+                if (!strcmp(argv[0], "-a")) annotate = 1;
+                else if (!strcmp(argv[0], "-f") && argc > 1) {
+                        mhz = atof(argv[1]);
+                        if (mhz <= 0) usage();
+                        argc--, argv++;
+                }
+                else if (!strcmp(argv[0], "-l") && argc > 1 && nbound < MAXBOUND) {
+                        at = address(argv[1]);
+                        if (at == -1 || argv[1][5] != '=') usage();
+                        bound[nbound].at = at;
+                        bound[nbound++].n = atoi(argv[1] + 6);
+                        argc--, argv++;
+                }
+                else usage();
+        }
+        if (argc > 2) usage();
+        image = argc > 0 ? argv[0] : "corestate.myst";
+        lstname = argc > 1 ? argv[1] : "lox_debug.txt";
+
+        load(image);
+        readlisting(lstname);
+        for (pg=0; pg<256; pg++)
+                if (code[pg] && name[pg][0]) analyse(pg);
+
+        if (annotate)
+                for (pg=0; pg<256; pg++)
+                        if (kept[pg]) listing(kept[pg]);
+
+        print("Page Routine              Best    Worst clocks  Worst us at %g MHz\n", mhz);
+        for (pg=0; pg<256; pg++) {
+                if (rout[pg].state != 2) continue;
+                print("%.2Xh  %-16s %8lld", pg, name[pg], rout[pg].min);
+                if (rout[pg].max >= UNBOUNDED) print(" %8s         %s\n", "-", rout[pg].why);
+                else print(" %8lld  %10.1f\n", rout[pg].max, rout[pg].max / mhz);
+        }
+        exits(nil);
+}
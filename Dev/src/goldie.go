@@ -13,6 +13,8 @@ package main
 import (
 	"bufio"
 	"encoding/binary"
+	"encoding/gob"
+	"flag"
 	"fmt"
 	"log"
 	"os"
@@ -28,7 +30,9 @@ type symbol struct {
 	str string
 }
 
-var symTab = []symbol{
+// Number and character literals, mnemonics are in optab.go
+// (generated by mkoptab.go)
+var litTab = []symbol{
 	{0x00, "0"},
 	{0x01, "1"}, {0x02, "2"}, {0x03, "3"},
 	{0x04, "4"}, {0x05, "5"}, {0x06, "6"},
@@ -372,50 +376,10 @@ var symTab = []symbol{
 	{0x7A, "'z'"}, {0x7B, "'{'"}, {0x7C, "'|'"},
 	{0x7D, "'}'"}, {0x7E, "'~'"}, {0x00, "'NUL'"},
 	{0x0D, "'CR'"}, {0x0A, "'LF'"},
-	/*SYS*/
-	{0x00, "NOP"},
-	{0x01, "SSI"}, {0x02, "SSO"}, {0x03, "SCL"}, {0x04, "SCH"},
-	{0x05, "RET"}, {0x06, "COR"}, {0x07, "OWN"},
-	/*FIX*/
-	{0x08, "P4"},
-	{0x09, "P1"}, {0x0A, "P2"}, {0x0B, "P3"}, {0x0C, "M4"},
-	{0x0D, "M3"}, {0x0E, "M2"}, {0x0F, "M1"},
-	/*ALU*/
-	{0x10, "CLR"},
-	{0x11, "IDO"}, {0x12, "OCR"}, {0x13, "OCO"}, {0x14, "SLR"},
-	{0x15, "SLO"}, {0x16, "SRR"}, {0x17, "SRO"}, {0x18, "AND"},
-	{0x19, "IOR"}, {0x1A, "EOR"}, {0x1B, "ADD"}, {0x1C, "CAR"},
-	{0x1D, "RLO"}, {0x1E, "REO"}, {0x1F, "RGO"},
-	/*TRAP*/
-	{0x20, "*0"},
-	{0x21, "*1"}, {0x22, "*2"}, {0x23, "*3"}, {0x24, "*4"},
-	{0x25, "*5"}, {0x26, "*6"}, {0x27, "*7"}, {0x28, "*8"},
-	{0x29, "*9"}, {0x2A, "*10"}, {0x2B, "*11"}, {0x2C, "*12"},
-	{0x2D, "*13"}, {0x2E, "*14"}, {0x2F, "*15"}, {0x30, "*16"},
-	{0x31, "*17"}, {0x32, "*18"}, {0x33, "*19"}, {0x34, "*20"},
-	{0x35, "*21"}, {0x36, "*22"}, {0x37, "*23"}, {0x38, "*24"},
-	{0x39, "*25"}, {0x3A, "*26"}, {0x3B, "*27"}, {0x3C, "*28"},
-	{0x3D, "*29"}, {0x3E, "*30"}, {0x3F, "*31"},
-	/*GIRO*/
-	{0x40, "0g"}, {0x41, "1g"}, {0x42, "2g"}, {0x43, "3g"}, {0x44, "4g"}, {0x45, "5g"}, {0x46, "6g"}, {0x47, "7g"},
-	{0x48, "g0"}, {0x49, "g1"}, {0x4A, "g2"}, {0x4B, "g3"}, {0x4C, "g4"}, {0x4D, "g5"}, {0x4E, "g6"}, {0x4F, "g7"},
-	{0x50, "0i"}, {0x51, "1i"}, {0x52, "2i"}, {0x53, "3i"}, {0x54, "4i"}, {0x55, "5i"}, {0x56, "6i"}, {0x57, "7i"},
-	{0x58, "i0"}, {0x59, "i1"}, {0x5A, "i2"}, {0x5B, "i3"}, {0x5C, "i4"}, {0x5D, "i5"}, {0x5E, "i6"}, {0x5F, "i7"},
-	{0x60, "0r"}, {0x61, "1r"}, {0x62, "2r"}, {0x63, "3r"}, {0x64, "4r"}, {0x65, "5r"}, {0x66, "6r"}, {0x67, "7r"},
-	{0x68, "r0"}, {0x69, "r1"}, {0x6A, "r2"}, {0x6B, "r3"}, {0x6C, "r4"}, {0x6D, "r5"}, {0x6E, "r6"}, {0x6F, "r7"},
-	{0x70, "0o"}, {0x71, "1o"}, {0x72, "2o"}, {0x73, "3o"}, {0x74, "4o"}, {0x75, "5o"}, {0x76, "6o"}, {0x77, "7o"},
-	{0x78, "o0"}, {0x79, "o1"}, {0x7A, "o2"}, {0x7B, "o3"}, {0x7C, "o4"}, {0x7D, "o5"}, {0x7E, "o6"}, {0x7F, "o7"},
-	/*PAIR*/
-	{0x80, "no"}, {0x81, "END"}, {0x82, "SCROUNGE_NL"}, {0x83, "ng"}, {0x84, "nr"}, {0x85, "ni"}, {0x86, "ns"}, {0x87, "np"}, {0x88, "ne"}, {0x89, "na"}, {0x8A, "nb"}, {0x8B, "nj"}, {0x8C, "nw"}, {0x8D, "nt"}, {0x8E, "nf"}, {0x8F, "nc"},
-	{0x90, "mo"}, {0x91, "SCROUNGE_MM"}, {0x92, "SCROUNGE_ML"}, {0x93, "mg"}, {0x94, "mr"}, {0x95, "mi"}, {0x96, "ms"}, {0x97, "mp"}, {0x98, "me"}, {0x99, "ma"}, {0x9A, "mb"}, {0x9B, "mj"}, {0x9C, "mw"}, {0x9D, "mt"}, {0x9E, "mf"}, {0x9F, "mc"},
-	{0xA0, "lo"}, {0xA1, "SCROUNGE_LM"}, {0xA2, "SCROUNGE_LL"}, {0xA3, "lg"}, {0xA4, "lr"}, {0xA5, "li"}, {0xA6, "ls"}, {0xA7, "lp"}, {0xA8, "le"}, {0xA9, "la"}, {0xAA, "lb"}, {0xAB, "lj"}, {0xAC, "lw"}, {0xAD, "lt"}, {0xAE, "lf"}, {0xAF, "lc"},
-	{0xB0, "go"}, {0xB1, "gm"}, {0xB2, "gl"}, {0xB3, "SCROUNGE_GG"}, {0xB4, "gr"}, {0xB5, "gi"}, {0xB6, "gs"}, {0xB7, "gp"}, {0xB8, "ge"}, {0xB9, "ga"}, {0xBA, "gb"}, {0xBB, "gj"}, {0xBC, "gw"}, {0xBD, "gt"}, {0xBE, "gf"}, {0xBF, "gc"},
-	{0xC0, "ro"}, {0xC1, "rm"}, {0xC2, "rl"}, {0xC3, "rg"}, {0xC4, "SCROUNGE_RR"}, {0xC5, "ri"}, {0xC6, "rs"}, {0xC7, "rp"}, {0xC8, "re"}, {0xC9, "ra"}, {0xCA, "rb"}, {0xCB, "rj"}, {0xCC, "rw"}, {0xCD, "rt"}, {0xCE, "rf"}, {0xCF, "rc"},
-	{0xD0, "io"}, {0xD1, "im"}, {0xD2, "il"}, {0xD3, "ig"}, {0xD4, "ir"}, {0xD5, "SCROUNGE_II"}, {0xD6, "is"}, {0xD7, "ip"}, {0xD8, "ie"}, {0xD9, "ia"}, {0xDA, "ib"}, {0xDB, "ij"}, {0xDC, "iw"}, {0xDD, "it"}, {0xDE, "if"}, {0xDF, "ic"},
-	{0xE0, "so"}, {0xE1, "sm"}, {0xE2, "sl"}, {0xE3, "sg"}, {0xE4, "sr"}, {0xE5, "si"}, {0xE6, "ss"}, {0xE7, "sp"}, {0xE8, "se"}, {0xE9, "sa"}, {0xEA, "sb"}, {0xEB, "sj"}, {0xEC, "sw"}, {0xED, "st"}, {0xEE, "sf"}, {0xEF, "sc"},
-	{0xF0, "po"}, {0xF1, "pm"}, {0xF2, "pl"}, {0xF3, "pg"}, {0xF4, "pr"}, {0xF5, "pi"}, {0xF6, "ps"}, {0xF7, "pp"}, {0xF8, "pe"}, {0xF9, "pa"}, {0xFA, "pb"}, {0xFB, "pj"}, {0xFC, "pw"}, {0xFD, "pt"}, {0xFE, "pf"}, {0xFF, "pc"},
 }
 
+var symTab = append(litTab, opTab...)
+
 type myth_vm struct /*Complete machine state including all ram*/
 {
 	ram [256][256]byte /*MemoryByte[page][offset]*/
@@ -492,12 +456,24 @@ func wrDebugTxt() {
 	var overline bool
 	var lid0 byte
 
+	// Where each line's code starts, for pages placed out of
+	// source order (-L)
+	first := map[int]int{}
+	for a := 255*256 + 255; a >= 0; a-- {
+		if l := blameLine[a>>8][a&255]; l != 0 {
+			first[l] = a
+		}
+	}
+
 	for line := 1; line <= len(srcLine); line++ {
 		//fmt.Fprintf(w, "---------------------------------------\n")
 
 		fill = 0
 		pos = 0
 		overline = false
+		if a, ok := first[line]; ok && line != blameLine[i][j] {
+			i, j = byte(a>>8), byte(a)
+		}
 		if line == blameLine[i][j] {
 			lid0 = lid[i]
 			fmt.Fprintf(w, "%.02X.%.02X:  ", i, j)
@@ -550,13 +526,96 @@ func wrDebugTxt() {
 	}
 }
 
-func wrVM() {
-	f, e := os.Create("corestate.myst")
+// Machine image container, see clox/myst.h for the layout.
+// The register block follows the field order of myth_vm.
+
+const mystVersion = 1
+const mystLOX = 1
+
+func adler32(b []byte) uint32 {
+	var a, s uint32 = 1, 0
+	for _, c := range b {
+		a = (a + uint32(c)) % 65521
+		s = (s + a) % 65521
+	}
+	return s<<16 | a
+}
+
+func mystRegs(vm *myth_vm) []*byte {
+	return []*byte{&vm.e_old, &vm.e_new, &vm.sclk, &vm.miso, &vm.mosi,
+		&vm.sir, &vm.sor, &vm.pir, &vm.por, &vm.r, &vm.o, &vm.i, &vm.pc,
+		&vm.co, &vm.c, &vm.g, &vm.l, &vm.scrounge}
+}
+
+func mystEncode(vm *myth_vm) []byte {
+	regs := mystRegs(vm)
+
+	out := []byte{'M', 'Y', 'S', 'T', mystVersion, mystLOX,
+		0, 1, 0, 1, byte(len(regs)), 0} // 256 pages of 256 bytes
+	for _, r := range regs {
+		out = append(out, *r)
+	}
+
+	bmp := len(out)
+	out = append(out, make([]byte, 256/8)...)
+	for pg := 0; pg < 256; pg++ {
+		for _, b := range vm.ram[pg] {
+			if b != 0 {
+				out[bmp+pg/8] |= 1 << (pg & 7)
+				out = append(out, vm.ram[pg][:]...)
+				break
+			}
+		}
+	}
+	return binary.LittleEndian.AppendUint32(out, adler32(out))
+}
+
+// Inverse of mystEncode(), for images written by goldie or lox
+
+func mystDecode(in []byte, vm *myth_vm) string {
+	regs := mystRegs(vm)
+	n := len(in)
+	if n < 4 || string(in[:4]) != "MYST" {
+		return "not a .myst image"
+	}
+	if n < 12+len(regs)+256/8+4 || in[4] != mystVersion || in[5] != mystLOX ||
+		in[6] != 0 || in[7] != 1 || in[8] != 0 || in[9] != 1 || int(in[10]) != len(regs) {
+		return "not a LOX image of this version"
+	}
+	if binary.LittleEndian.Uint32(in[n-4:]) != adler32(in[:n-4]) {
+		return "checksum mismatch"
+	}
+	for k, r := range regs {
+		*r = in[12+k]
+	}
+	bmp := 12 + len(regs)
+	at := bmp + 256/8
+	for pg := 0; pg < 256; pg++ {
+		if in[bmp+pg/8]&(1<<(pg&7)) != 0 {
+			if at+256 > n-4 {
+				return "image truncated"
+			}
+			copy(vm.ram[pg][:], in[at:at+256])
+			at += 256
+		}
+	}
+	return ""
+}
+
+func rdVM(vm *myth_vm) bool {
+	in, e := os.ReadFile("corestate.myst")
 	if e != nil {
-		log.Fatal("Could not create output file")
+		return false
 	}
-	defer f.Close()
-	e = binary.Write(f, binary.NativeEndian, vm)
+	if msg := mystDecode(in, vm); msg != "" {
+		fmt.Printf("corestate.myst: %s\n", msg)
+		return false
+	}
+	return true
+}
+
+func wrVM() {
+	e := os.WriteFile("corestate.myst", mystEncode(&vm), 0666)
 	if e != nil {
 		log.Fatal("Could not write output file")
 	}
@@ -567,6 +626,13 @@ func wrVM() {
 // Go to next page once current page is full
 
 func putCode(b byte) {
+	if dryRun {
+		dryByte = b
+		return
+	}
+	if curUnit != nil {
+		curUnit.Wrote = append(curUnit.Wrote, uint16(page)<<8|uint16(offs))
+	}
 	blameLine[page][offs] = lineNum
 	vm.ram[page][offs] = b
 	if offs == 255 {
@@ -577,6 +643,192 @@ func putCode(b byte) {
 	offs++
 }
 
+// Incremental assembly (goldie -i)
+//
+// The source is cut into units at each P[...], plus the text before
+// the first one. Pass 1 always runs over the whole source, it only
+// lays out code, and one word never assembles to a different number
+// of bytes in pass 2. Pass 2 runs per unit. corestate.cache keeps
+// for each unit what it was assembled from and what it wrote, so -i
+// can skip pass 2 for units whose words, placement and imports are
+// unchanged, and patch only the bytes of the others into the
+// existing corestate.myst. Registers and all other memory stay as
+// the machine left them.
+
+const cacheFile = "corestate.cache"
+
+type srcPos struct{ line, word int }
+
+// Word resolved through the tables filled in pass 1, or unknown
+type impRec struct {
+	Word       string
+	Page, Offs byte // Where its object byte went
+	Val        byte
+	Known      bool
+}
+
+type unit struct {
+	Key        string   // Label of its P[...], "#n" appended if repeated
+	Hash       uint32   // Adler-32 of its words
+	Page, Offs byte     // Placement after its P[...]
+	Imports    []impRec // Pass 2
+	Wrote      []uint16 // Pass 2, page<<8 | offset of each object byte
+	at         srcPos   // Of the P[...] word
+	text       []byte   // Words, pass 1, up to the next P[...]
+	inComment  bool     // Parser state after the P[...]
+	inString   bool
+	dirty      bool
+}
+
+var units []unit
+var curUnit *unit // Unit assembled in pass 2, nil in pass 1
+var dryRun bool   // putCode() only notes the byte, see importsChanged()
+var dryByte byte
+
+// Begin a new unit after the P[...] in 'word' (pass 1)
+
+func beginUnit(word string, at srcPos) {
+	_, label, _ := extractLabel(word)
+	key := label
+	for n := 2; findUnit(key) != nil; n++ {
+		key = fmt.Sprintf("%s#%d", label, n)
+	}
+	units = append(units, unit{Key: key, Page: page, Offs: offs, at: at,
+		text: []byte(word + " "), inComment: insideComment, inString: insideString})
+}
+
+func findUnit(key string) *unit {
+	for i := range units {
+		if units[i].Key == key {
+			return &units[i]
+		}
+	}
+	return nil
+}
+
+func nextWord(p srcPos) srcPos {
+	return srcPos{p.line, p.word + 1}
+}
+
+func unitEnd(i int) srcPos {
+	if i+1 < len(units) {
+		return units[i+1].at
+	}
+	return srcPos{len(srcLine), 0}
+}
+
+// Pass 2 over one unit, from where pass 1 left it
+
+func assembleUnit(i int) {
+	u := &units[i]
+	u.Imports, u.Wrote = nil, nil
+	page, offs = u.Page, u.Offs
+	insideComment, insideString = u.inComment, u.inString
+	curUnit = u
+	parse(2, nextWord(u.at), unitEnd(i))
+	curUnit = nil
+}
+
+func noteImport(word string, p byte, o byte, known bool) {
+	if curUnit != nil {
+		curUnit.Imports = append(curUnit.Imports, impRec{word, p, o, vm.ram[p][o], known})
+	}
+}
+
+// Resolve the imports of a cached unit again, as parse() would
+
+func importsChanged(u *unit) bool {
+	dryRun = true
+	defer func() { dryRun = false }()
+
+	for _, im := range u.Imports {
+		page, offs = im.Page, im.Offs
+		dryByte = 0
+		known := tryOffsLabelRef(im.Word) || tryConstDefined(im.Word) ||
+			tryPageLabelRef(im.Word) || tryTrapCall(im.Word)
+		if known != im.Known || dryByte != im.Val {
+			return true
+		}
+	}
+	return false
+}
+
+func rdCache(old *[]unit) bool {
+	f, e := os.Open(cacheFile)
+	if e != nil {
+		return false
+	}
+	defer f.Close()
+	return gob.NewDecoder(f).Decode(old) == nil
+}
+
+func wrCache() {
+	f, e := os.Create(cacheFile)
+	if e != nil {
+		log.Fatal("Could not write cache file")
+	}
+	defer f.Close()
+	if gob.NewEncoder(f).Encode(units) != nil {
+		log.Fatal("Could not write cache file")
+	}
+}
+
+// Pass 2 over changed units only, into the image loaded from
+// corestate.myst. Bytes a changed or deleted unit wrote last time
+// are cleared first unless an unchanged unit owns them.
+// Returns false if there is no image or cache to patch.
+
+func patchUnits() bool {
+	var img myth_vm
+	var old []unit
+
+	if !rdCache(&old) || !rdVM(&img) {
+		return false
+	}
+	cached := map[string]*unit{}
+	for i := range old {
+		cached[old[i].Key] = &old[i]
+	}
+
+	keep := map[uint16]bool{}
+	current := map[string]*unit{}
+	n := 0
+	for i := range units {
+		u := &units[i]
+		current[u.Key] = u
+		c := cached[u.Key]
+		if c != nil && c.Hash == u.Hash && c.Page == u.Page && c.Offs == u.Offs && !importsChanged(c) {
+			u.Imports, u.Wrote = c.Imports, c.Wrote
+			for _, a := range u.Wrote {
+				keep[a] = true
+			}
+		} else {
+			u.dirty = true
+			n++
+		}
+	}
+
+	vm = img
+	for i := range old {
+		if u := current[old[i].Key]; u == nil || u.dirty {
+			for _, a := range old[i].Wrote {
+				if !keep[a] {
+					vm.ram[a>>8][a&255] = 0
+				}
+			}
+		}
+	}
+
+	fmt.Printf("Pass 2, %d of %d units changed\n", n, len(units))
+	for i := range units {
+		if units[i].dirty {
+			fmt.Printf("  %s\n", units[i].Key)
+			assembleUnit(i)
+		}
+	}
+	return true
+}
+
 // Helper function to POC (Page label, Offset label, Constant label)
 // Argument 'word' was checked to start with 'P[', 'O[', or 'C['
 // Format is either x[label]value, or no value
@@ -875,7 +1127,7 @@ func tryTrapCall(word string) bool {
 	if len(word) > 0 && word[0] == '*' { //Trap call
 		for i := 0; i < 32; i++ {
 			if pageLabel[i] == word[1:] {
-				putCode(byte(i) & 0x40)
+				putCode(0x20 | byte(i))
 				return true
 			}
 		}
@@ -884,17 +1136,24 @@ func tryTrapCall(word string) bool {
 }
 
 var hasVal bool // Silence "unused" warning/err if I put this inside the function!?
-func parse(pass byte) {
 
-	var wordIndex int
+// Assemble the words from 'from' up to 'to' (exclusive)
 
-	fmt.Printf("Pass %d\n", pass)
+func parse(pass byte, from srcPos, to srcPos) {
 
-	for lineNum = 1; lineNum < len(srcLine); lineNum++ {
+	var wordIndex int
+
+	for lineNum = from.line; lineNum < len(srcLine); lineNum++ {
 		wordsInLine := strings.Fields(srcLine[lineNum-1])
 
 		wordIndex = 0
+		if lineNum == from.line {
+			wordIndex = from.word
+		}
 		for wordIndex < len(wordsInLine) {
+			if lineNum > to.line || lineNum == to.line && wordIndex >= to.word {
+				return
+			}
 			word := wordsInLine[wordIndex]
 			if len(word) == 0 {
 				continue // Empty source line!
@@ -903,47 +1162,68 @@ func parse(pass byte) {
 					break
 				}
 			}
+			if pass == 1 {
+				u := &units[len(units)-1]
+				u.text = append(append(u.text, word...), ' ')
+			}
 
 			if word[len(word)-1] == ',' {
 				word = word[:len(word)-1] // Chop
 			}
 
+			at := srcPos{lineNum, wordIndex}
 			if tryCommentRelated(word) {
+				noteWord(at, word, wkComment)
 				wordIndex++
 				continue
 			}
 
+			p, o := page, offs // Where a symbol's byte goes
 			if tryOffsLabelRef(word) {
+				noteImport(word, p, o, true)
+				noteWord(at, word, wkOffsRef)
 				wordIndex++
 				continue
 			}
 
 			if tryPOC(word) {
+				if pass == 1 && strings.Contains(word, "P[") {
+					beginUnit(word, at)
+				}
+				noteWord(at, word, wkPOC)
 				wordIndex++
 				continue
 			}
 
 			if tryPredefined(word) {
+				noteWord(at, word, wkPredef)
 				wordIndex++
 				continue
 			}
 
 			if tryConstDefined(word) {
+				noteImport(word, p, o, true)
+				noteWord(at, word, wkConst)
 				wordIndex++
 				continue
 			}
 
 			if tryPageLabelRef(word) {
+				noteImport(word, p, o, true)
+				noteWord(at, word, wkPageRef)
 				wordIndex++
 				continue
 			}
 
 			if tryTrapCall(word) {
+				noteImport(word, p, o, true)
+				noteWord(at, word, wkTrap)
 				wordIndex++
 				continue
 			}
 
 			if tryStringRelated(word) {
+				noteWord(at, word, wkString)
 				wordIndex++
 				continue
 			}
@@ -952,16 +1232,38 @@ func parse(pass byte) {
 			if pass == 2 {
 				fmt.Printf("Line %d: Using 0 for unknown literal '%s'\n", lineNum, word)
 			}
+			noteImport(word, p, o, false)
+			noteWord(at, word, wkUnknown)
 			putCode(0)
 			continue
 		}
 	}
 }
 
+// Pass 1 over the whole source, from scratch
+
+func pass1() {
+	vm = myth_vm{}
+	pageLabel = [256]string{}
+	offsLabel = [256][256]string{}
+	blameLine = [256][256]int{}
+	lid = [256]byte{}
+	constTopIndex = 0
+	page, offs = 0, 0
+	insideComment, insideString = false, false
+	units = []unit{{at: srcPos{1, -1}}} // Text before the first P[...]
+	optWords = nil
+	parse(1, srcPos{1, 0}, srcPos{len(srcLine), 0})
+}
+
 func main() {
 
-	if len(os.Args[1:]) < 1 {
-		fmt.Println("Missing input file arguments <asmsrc>")
+	incremental := flag.Bool("i", false, "patch changed units into corestate.myst")
+	opt := flag.Bool("O", false, "optimize instruction streams, see peephole.go")
+	place := flag.Bool("L", false, "place P[...]+ routines, call hot ones by TRAP, see link.go")
+	flag.Parse()
+	if flag.NArg() < 1 {
+		fmt.Println("Missing input file arguments [-i] [-O] [-L] <asmsrc>")
 		os.Exit(1)
 	}
 
@@ -969,18 +1271,49 @@ func main() {
 
 	vm = myth_vm{}
 
-	srcText := ldSrc(os.Args[1:][0])
+	srcText := ldSrc(flag.Arg(0))
 	srcTextStr := string(srcText)
 	srcLine = strings.Split(srcTextStr, "\n")
 	fmt.Printf("Source file has %d lines\n", len(srcLine))
 
-	parse(1)
+	fmt.Printf("Pass 1\n")
+	optimizing = *opt || *place
+	pass1()
+	if *opt && optimize() {
+		fmt.Printf("Pass 1 over the optimized source\n")
+		pass1()
+	}
+	if *place && link() {
+		fmt.Printf("Pass 1 over the linked source\n")
+		pass1()
+	}
+	optimizing = false
+	for i := range units {
+		units[i].Hash = adler32(units[i].text)
+	}
+	lid1 := lid
 	for i := 0; i < 256; i++ {
 		lid[i] = 0
 	}
-	parse(2) // Second Pass to resolve forward refs
+
+	// Second Pass to resolve forward refs
+	if !*incremental || !patchUnits() {
+		if *incremental {
+			fmt.Printf("Nothing to patch, assembling all\n")
+		}
+		fmt.Printf("Pass 2\n")
+		vm = myth_vm{}
+		for i := range units {
+			assembleUnit(i)
+		}
+	}
+	lid = lid1 // Same layout, but pass 2 may have skipped units
 
 	wrVM()
+	wrCache()
 	wrDebugTxt()
+	if *place {
+		pageReport()
+	}
 	fmt.Println("Goldie/LOX finished")
 }
@@ -0,0 +1,203 @@
+/*
+   Page placement for goldie (-L)
+
+   *Myth* Project
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+*/
+
+package main
+
+import (
+	"fmt"
+	"sort"
+)
+
+// Calls and traps enter a page at offset 0, so routines cannot share
+// a page: each keeps its own, or a run of them if its code spills
+// over. What the linker picks is the page. After pass 1 the P[...]+
+// units that decodeUnit accepts are given the lowest free pages, the
+// most called first, so that the hot ones land on pages 1-31. Calls
+// to those are rewritten from nc label (2 bytes) to *label (1 byte
+// TRAP), in the units decodeUnit accepts. Every other P[...]+ unit
+// gets the page pass 1 gave it written out, P[...]value units stay
+// where they are. Pass 1 then runs again, as for -O.
+
+type routine struct {
+	label   string
+	at      srcPos // Of the P[...] word
+	page    int    // Pass 1, then as placed
+	span    int    // Pages
+	calls   int    // Call sites
+	plus    bool   // P[...]+
+	movable bool
+}
+
+// Place the routines, rewrite srcLine, true if anything changed
+
+func link() bool {
+	byUnit := unitWords()
+
+	cus := map[int]*codeUnit{}
+	calls := map[string]int{}
+	trapped := map[string]bool{}
+	for u := 1; u < len(units); u++ {
+		cu, ok := decodeUnit(byUnit[u])
+		if !ok {
+			continue
+		}
+		cus[u] = cu
+		for _, in := range cu.ins {
+			if in.op == opNC {
+				calls[optWords[in.arg].word]++
+			}
+		}
+	}
+	for _, wr := range optWords {
+		if (wr.kind == wkTrap || wr.kind == wkUnknown) && len(wr.word) > 1 && wr.word[0] == '*' {
+			calls[wr.word[1:]]++
+			trapped[wr.word[1:]] = true
+		}
+	}
+
+	var rts []*routine
+	for u := 1; u < len(units); u++ {
+		ws := byUnit[u]
+		if len(ws) == 0 {
+			continue
+		}
+		p := optWords[ws[0]]
+		hasVal, label, _ := extractLabel(p.word)
+		last := optWords[ws[len(ws)-1]]
+		end := int(last.page)
+		if last.offs == 0 && end > int(p.page) {
+			end-- // Ended with the page
+		}
+		if end < int(p.page) {
+			end = int(p.page)
+		}
+		plus := !hasVal && p.word[len(p.word)-1] == '+'
+		if !hasVal && !plus && len(rts) > 0 { // Continues the page before
+			rt := rts[len(rts)-1]
+			rt.movable = false
+			if end-rt.page+1 > rt.span {
+				rt.span = end - rt.page + 1
+			}
+			continue
+		}
+		_, ok := cus[u]
+		rts = append(rts, &routine{label, p.at, int(p.page), end - int(p.page) + 1,
+			calls[label], plus, plus && ok})
+	}
+
+	var used [256]bool
+	used[0] = true // RESET
+	var moving []*routine
+	for _, rt := range rts {
+		if !rt.movable {
+			for k := 0; k < rt.span; k++ {
+				used[(rt.page+k)&255] = true
+			}
+		} else {
+			moving = append(moving, rt)
+		}
+	}
+	sort.SliceStable(moving, func(a, b int) bool {
+		ta, tb := trapped[moving[a].label], trapped[moving[b].label]
+		if ta != tb {
+			return ta
+		}
+		return moving[a].calls > moving[b].calls
+	})
+
+	moved := 0
+	for _, rt := range moving {
+		p := 1
+		for ; p+rt.span <= 256; p++ {
+			k := 0
+			for k < rt.span && !used[p+k] {
+				k++
+			}
+			if k == rt.span {
+				break
+			}
+		}
+		if p+rt.span > 256 {
+			panic("No free pages for P[" + rt.label + "]")
+		}
+		for k := 0; k < rt.span; k++ {
+			used[p+k] = true
+		}
+		if p != rt.page {
+			moved++
+		}
+		rt.page = p
+	}
+
+	edits := map[srcPos]string{}
+	pageOf := map[string]int{}
+	for _, rt := range rts {
+		pageOf[rt.label] = rt.page
+		if rt.plus {
+			edits[rt.at] = fmt.Sprintf("P[%s]%02Xh", rt.label, rt.page)
+		}
+	}
+	traps := 0
+	for _, cu := range cus {
+		for _, in := range cu.ins {
+			if in.op != opNC {
+				continue
+			}
+			label := optWords[in.arg].word
+			if p, ok := pageOf[label]; ok && p < 32 {
+				edits[optWords[in.mn].at] = ""
+				edits[optWords[in.arg].at] = "*" + label
+				traps++
+			}
+		}
+	}
+	fmt.Printf("Linker: %d routines moved, %d calls made TRAPs\n", moved, traps)
+	if moved+traps == 0 {
+		return false
+	}
+	editSource(edits)
+	return true
+}
+
+// Bytes assembled per page, pages without a label of their own
+// counted with the one before
+
+func pageReport() {
+	var pages, bytes, free int
+
+	fmt.Printf("Page usage:\n")
+	for p := 0; p < 256; {
+		q, n := p, 0
+		for q == p || q < 256 && pageLabel[q] == "" && lid[q] != 0 {
+			for o := 0; o < 256; o++ {
+				if blameLine[q][o] != 0 {
+					n++
+				}
+			}
+			q++
+		}
+		if n == 0 && pageLabel[p] == "" {
+			if p > 0 && p < 32 {
+				free++
+			}
+			p = q
+			continue
+		}
+		span := fmt.Sprintf("%02Xh", p)
+		if q-p > 1 {
+			span += fmt.Sprintf("-%02Xh", q-1)
+		}
+		fmt.Printf("  %-7s %-16s %5d bytes %3d%%\n", span, pageLabel[p], n, n*100/((q-p)*256))
+		pages += q - p
+		bytes += n
+		p = q
+	}
+	if pages > 0 {
+		fmt.Printf("%d pages, %d bytes, %d%% used, %d trap pages free\n",
+			pages, bytes, bytes*100/(pages*256), free)
+	}
+}
@@ -0,0 +1,449 @@
+//go:build ignore
+
+/*
+   mkoptab
+   Generates the opcode tables of the LOX tool chain from
+   ../res/myth_instructions.json:
+
+     clox/optab.h  one handler per opcode with its fields folded
+                   into constants, the dispatch table and the
+                   disassembler names, for myth.h and tcall.h
+     optab.go      mnemonic table for goldie
+
+   Handler code is derived from the opcode encoding, names and
+   descriptions come from the JSON file, which is checked against
+   the encoding: every description has to state what the
+   generated handler does.
+
+   *Myth* Project
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+
+   Run in Dev/src: go run mkoptab.go
+*/
+
+package main
+
+import (
+	"bufio"
+	"encoding/json"
+	"fmt"
+	"log"
+	"os"
+	"strings"
+)
+
+type instr struct {
+	Val   int    `json:"val"`
+	Name  string `json:"name"`
+	Group string `json:"group"`
+	Desc  string `json:"desc"`
+}
+
+const srcNames = "nmlgrisp"         // PAIR bits 4-6
+const dstNames = "omlgrispeabjwtfc" // PAIR bits 0-3
+const giroRegs = "giro"             // GIRO bits 4-5
+
+// C expressions, see myth.h for the register model
+var srcExpr = []string{
+	"(*code)[(*pc)++]", "vm->ram[vm->g][*o]", "vm->ram[vm->l][*o]", "vm->g",
+	"*r", "vm->i", "vm->sir", "vm->pir",
+}
+var giroExpr = []string{"vm->g", "vm->i", "*r", "*o"}
+var aluExpr = []string{
+	"0", "*o", "~*r", "~*o",
+	"*r << 1", "*o << 1", "*r >> 1", "*o >> 1",
+	"*r & *o", "*r | *o", "*r ^ *o", "*r + *o",
+	"(uint) *r + (uint) *o > 255 ? 1 : 0", "(*r < *o) ? 255 : 0",
+	"(*r == *o) ? 255 : 0", "(*r > *o) ? 255 : 0",
+}
+var fixStmt = []string{
+	"*r += 4;", "*r += 1;", "*r += 2;", "*r += 3;",
+	"*r -= 4;", "*r -= 3;", "*r -= 2;", "*r -= 1;",
+}
+
+// The same in the notation of the JSON descriptions, see encDesc()
+var srcDesc = []string{"ram[c][pc++]", "ram[g][o]", "ram[l][o]", "g", "r", "i", "sir", "pir"}
+var dstDesc = []string{
+	"o=%s", "ram[g][o]=%s", "ram[l][o]=%s", "g=%s",
+	"r=%s", "i=%s", "sor=%s", "por=%s",
+	"e=%s", "o+=%s; if carry then g+=1", "l+=%s", "pc=%s",
+	"if i!=0 then pc=%s; i--", "if r!=0 then pc=%s", "if r==0 then pc=%s",
+	"i=pc; co=c; pc=0; c=%s; l--",
+}
+var aluDesc = []string{
+	"r=0", "r=o", "r=~r", "r=~o",
+	"r=r<<1", "r=o<<1", "r=r>>1", "r=o>>1",
+	"r=r&o", "r=r|o", "r=r^o", "r=r+o",
+	"if r+o>255 then r=1 else r=0", "if r<o then r=255 else r=0",
+	"if r=o then r=255 else r=0", "if r>o then r=255 else r=0",
+}
+var fixDesc = []string{"r+=4", "r+=1", "r+=2", "r+=3", "r-=4", "r-=3", "r-=2", "r-=1"}
+var sysDesc = []string{
+	"", "sir=(sir<<1)+miso", "mosi=sor&0x80 ? 1:0; sor<<=1", "sclk=0",
+	"sclk=1", "c=L7; pc=i; l++", "c=r; pc=i", "L7=co",
+}
+
+func group(op int) string {
+	switch {
+	case op&0x80 != 0:
+		return "PAIR"
+	case op&0x40 != 0:
+		return "GIRO"
+	case op&0x20 != 0:
+		return "TRAP"
+	case op&0x10 != 0:
+		return "ALU"
+	case op&0x08 != 0:
+		return "FIX"
+	}
+	return "SYS"
+}
+
+// Memory to memory moves and register self-moves are scrounged,
+// see myth.h
+func isScrounge(op int) bool {
+	src, dst := (op>>4)&7, op&15
+	if op&0x80 == 0 {
+		return false
+	}
+	if src <= 2 && (dst == 1 || dst == 2) {
+		return true
+	}
+	return src == dst && src >= 3 && src <= 5
+}
+
+// Name implied by the encoding, empty if free (SYS, ALU, FIX, scrounges)
+func encName(op int) string {
+	switch group(op) {
+	case "PAIR":
+		if isScrounge(op) {
+			return ""
+		}
+		return string(srcNames[(op>>4)&7]) + string(dstNames[op&15])
+	case "GIRO":
+		reg, k := string(giroRegs[(op>>4)&3]), fmt.Sprint(op&7)
+		if op&8 != 0 {
+			return reg + k
+		}
+		return k + reg
+	case "TRAP":
+		return fmt.Sprintf("*%d", op&31)
+	}
+	return ""
+}
+
+// What body(op) does, as the JSON file has to describe it
+func encDesc(op int) string {
+	src, dst := (op>>4)&7, op&15
+
+	switch group(op) {
+	case "PAIR":
+		if isScrounge(op) {
+			return strings.ToUpper(string(srcNames[src])+string(dstNames[dst])) + " scrounge"
+		}
+		// The handler reads the source first, say so where the
+		// statements before the write would change it
+		if src == 0 && dst >= 11 || src == 5 && dst == 15 {
+			return "v=" + srcDesc[src] + "; " + fmt.Sprintf(dstDesc[dst], "v")
+		}
+		return fmt.Sprintf(dstDesc[dst], srcDesc[src])
+	case "GIRO":
+		reg, m := string(giroRegs[(op>>4)&3]), fmt.Sprintf("L%d", op&7)
+		if op&8 != 0 {
+			return m + "=" + reg
+		}
+		return reg + "=" + m
+	case "TRAP":
+		return fmt.Sprintf(dstDesc[15], fmt.Sprint(op&31))
+	case "ALU":
+		return aluDesc[op&15]
+	case "FIX":
+		return fixDesc[op&7]
+	}
+	return sysDesc[op&7]
+}
+
+func pairBody(op int) []string {
+	src, dst := (op>>4)&7, op&15
+
+	if isScrounge(op) {
+		return []string{fmt.Sprintf("vm->scrounge = 0x%.02X;", op), "return OP_EXIT;"}
+	}
+	b := []string{"uchar v = " + srcExpr[src] + ";"}
+	if dst == 9 {
+		b = append(b, "int temp;")
+	}
+	b = append(b, "")
+	switch dst {
+	case 0:
+		b = append(b, "*o = v;")
+	case 1:
+		b = append(b, "vm->ram[vm->g][*o] = v;")
+	case 2:
+		b = append(b, "vm->ram[vm->l][*o] = v;")
+	case 3:
+		b = append(b, "vm->g = v;")
+	case 4:
+		b = append(b, "*r = v;")
+	case 5:
+		b = append(b, "vm->i = v;")
+	case 6:
+		b = append(b, "vm->sor = v;")
+	case 7:
+		b = append(b, "vm->por = v;")
+	case 8:
+		b = append(b, "vm->e_old = vm->e_new;", "vm->e_new = v;",
+			"if (vm->eio) { /*Devices see the full state*/",
+			"        vm->pc = *pc;", "        vm->r = *r;", "        vm->o = *o;",
+			"        vm->eio(vm);",
+			"        *r = vm->r;", "        *o = vm->o;", "}")
+	case 9:
+		b = append(b, "temp = *o + v;", "*o = (uchar) (temp & 0xFF);",
+			"if (temp>255) vm->g += 1;")
+	case 10:
+		b = append(b, "vm->l += v;")
+	case 11:
+		b = append(b, "*pc = v;")
+	case 12:
+		b = append(b, "if (vm->i) *pc = v;", "(vm->i)--; /*Post decrement, either case!*/")
+	case 13:
+		b = append(b, "if (*r) *pc = v;")
+	case 14:
+		b = append(b, "if (!*r) *pc = v;")
+	case 15:
+		b = append(b, "vm->i = *pc;", "vm->co = vm->c;", "*pc = 0;",
+			"vm->c = v;", "vm->l--;", "*code = vm->ram[v];")
+	}
+	return b
+}
+
+func sysBody(op int) []string {
+	switch op & 7 {
+	case 1: /*SSI*/
+		return []string{"vm->sir = ((vm->sir)<<1) + vm->miso;"}
+	case 2: /*SSO*/
+		return []string{
+			"if (vm->spibyte && *n >= SPIRUN-1) { /*Fused byte transfer*/",
+			"        vm->pc = *pc;",
+			"        if (spirun(vm) && vm->spibyte(vm)) {",
+			"                *pc += SPIRUN-1;",
+			"                *n -= SPIRUN-1;",
+			"                return OP_NEXT;",
+			"        }",
+			"}",
+			"vm->mosi = (vm->sor)&0x80 ? 1:0;",
+			"vm->sor <<= 1;"}
+	case 3: /*SCL*/
+		return []string{"if (vm->sclk) {", "        vm->sclk = 0;",
+			"        if (vm->sio) vm->sio(vm);", "}"}
+	case 4: /*SCH*/
+		return []string{"if (!vm->sclk) {", "        vm->sclk = 1;",
+			"        if (vm->sio) vm->sio(vm);", "}"}
+	case 5: /*RET*/
+		return []string{"vm->c = L7;", "*pc = vm->i;", "vm->l++;",
+			"*code = vm->ram[vm->c];"}
+	case 6: /*COR*/
+		return []string{"vm->c = *r;", "*pc = vm->i;", "*code = vm->ram[vm->c];"}
+	case 7: /*OWN*/
+		return []string{"L7 = vm->co;"}
+	}
+	return nil /*NOP*/
+}
+
+func body(op int) []string {
+	var b []string
+
+	switch group(op) {
+	case "PAIR":
+		b = pairBody(op)
+		if isScrounge(op) {
+			return b
+		}
+	case "GIRO":
+		m := fmt.Sprintf("vm->ram[vm->l][GIRO_BASE_OFFSET + %d]", op&7)
+		if op&8 != 0 {
+			b = []string{m + " = " + giroExpr[(op>>4)&3] + ";"}
+		} else {
+			b = []string{giroExpr[(op>>4)&3] + " = " + m + ";"}
+		}
+	case "TRAP":
+		b = []string{"vm->i = *pc;", "vm->co = vm->c;", "*pc = 0;",
+			fmt.Sprintf("vm->c = %d;", op&31), "vm->l--;",
+			fmt.Sprintf("*code = vm->ram[%d];", op&31)}
+	case "ALU":
+		b = []string{"*r = " + aluExpr[op&15] + ";"}
+	case "FIX":
+		b = []string{fixStmt[op&7]}
+	default:
+		b = sysBody(op)
+	}
+	return append(b, "return OP_NEXT;")
+}
+
+func check(tab []instr) {
+	if len(tab) != 256 {
+		log.Fatalf("%d instructions, want 256", len(tab))
+	}
+	seen := map[string]int{}
+	for op, in := range tab {
+		if in.Val != op {
+			log.Fatalf("entry %d has val %d", op, in.Val)
+		}
+		if in.Group != group(op) {
+			log.Fatalf("%.02X %s: group %s, encoding says %s", op, in.Name, in.Group, group(op))
+		}
+		if n := encName(op); n != "" && n != in.Name {
+			log.Fatalf("%.02X: name %s, encoding says %s", op, in.Name, n)
+		}
+		if d := encDesc(op); in.Desc != d {
+			log.Fatalf("%.02X %s: desc %q, handler does %q", op, in.Name, in.Desc, d)
+		}
+		if prev, dup := seen[in.Name]; dup {
+			log.Fatalf("%.02X: name %s already used by %.02X", op, in.Name, prev)
+		}
+		seen[in.Name] = op
+	}
+}
+
+func oplen(op int) int {
+	if group(op) == "PAIR" && (op>>4)&7 == 0 && !isScrounge(op) {
+		return 2 /*Literal follows*/
+	}
+	return 1
+}
+
+func wrC(tab []instr, fname string) {
+	f, e := os.Create(fname)
+	if e != nil {
+		log.Fatal("Could not create ", fname)
+	}
+	defer f.Close()
+	w := bufio.NewWriter(f)
+	defer w.Flush()
+
+	fmt.Fprintf(w, "/* Generated by mkoptab.go from res/myth_instructions.json, do not edit\n")
+	fmt.Fprintf(w, "*/\n\n#ifndef __OPTAB_H__\n#define __OPTAB_H__ 1\n\n")
+	fmt.Fprintf(w, "/* Handlers get the code page and the PC, R and O registers\n")
+	fmt.Fprintf(w, "   by reference so engines can keep them outside struct myth_vm.\n")
+	fmt.Fprintf(w, "   n is the instruction budget left, SSO may consume more.\n")
+	fmt.Fprintf(w, "   OP_EXIT means a scrounge was executed.\n*/\n\n")
+	fmt.Fprintf(w, "#define OPARGS struct myth_vm *vm, uchar **code, uchar *pc, uchar *r, uchar *o, long *n\n\n")
+	fmt.Fprintf(w, "#define OP_NEXT 0\n#define OP_EXIT 1\n\n")
+	fmt.Fprintf(w, "#ifdef __GNUC__\n#define OPINLINE static inline __attribute__((always_inline))\n")
+	fmt.Fprintf(w, "#else\n#define OPINLINE static\n#endif\n\n")
+
+	for op, in := range tab {
+		fmt.Fprintf(w, "\nOPINLINE int\nop%.02X(OPARGS) /*%s %s", op, in.Group, in.Name)
+		if in.Desc != "" && !isScrounge(op) {
+			fmt.Fprintf(w, ": %s", in.Desc)
+		}
+		fmt.Fprintf(w, "*/\n{\n")
+		for _, l := range body(op) {
+			if l == "" {
+				fmt.Fprintf(w, "\n")
+			} else {
+				fmt.Fprintf(w, "        %s\n", l)
+			}
+		}
+		fmt.Fprintf(w, "}\n")
+	}
+
+	fmt.Fprintf(w, "\n\n/* X(op) for every opcode op in hex\n*/\n\n#define MYTH_OPLIST(X) \\\n")
+	for op := 0; op < 256; op++ {
+		if op%16 == 0 {
+			fmt.Fprintf(w, "        ")
+		}
+		fmt.Fprintf(w, "X(%.02X)", op)
+		switch {
+		case op == 255:
+			fmt.Fprintf(w, "\n")
+		case op%16 == 15:
+			fmt.Fprintf(w, " \\\n")
+		default:
+			fmt.Fprintf(w, " ")
+		}
+	}
+
+	fmt.Fprintf(w, "\nstatic int (*myth_optab[256])(OPARGS) = {\n")
+	for op := 0; op < 256; op += 8 {
+		fmt.Fprintf(w, "        ")
+		for k := op; k < op+8; k++ {
+			fmt.Fprintf(w, "op%.02X,", k)
+			if k < op+7 {
+				fmt.Fprintf(w, " ")
+			}
+		}
+		fmt.Fprintf(w, "\n")
+	}
+	fmt.Fprintf(w, "};\n")
+
+	fmt.Fprintf(w, "\n/* Disassembler: mnemonic and length in bytes,\n")
+	fmt.Fprintf(w, "   inline so that units without one stay warning free\n*/\n")
+	fmt.Fprintf(w, "\nOPINLINE const char*\nmyth_opname(int op)\n{\n")
+	fmt.Fprintf(w, "        static const char *name[256] = {\n")
+	for op := 0; op < 256; op += 8 {
+		fmt.Fprintf(w, "                ")
+		for k := op; k < op+8; k++ {
+			fmt.Fprintf(w, "%q,", tab[k].Name)
+			if k < op+7 {
+				fmt.Fprintf(w, " ")
+			}
+		}
+		fmt.Fprintf(w, "\n")
+	}
+	fmt.Fprintf(w, "        };\n\n        return name[op];\n}\n")
+	fmt.Fprintf(w, "\nOPINLINE int\nmyth_oplen(int op)\n{\n")
+	fmt.Fprintf(w, "        static uchar len[256] = {\n")
+	for op := 0; op < 256; op += 16 {
+		fmt.Fprintf(w, "                ")
+		for k := op; k < op+16; k++ {
+			fmt.Fprintf(w, "%d,", oplen(k))
+			if k < op+15 {
+				fmt.Fprintf(w, " ")
+			}
+		}
+		fmt.Fprintf(w, "\n")
+	}
+	fmt.Fprintf(w, "        };\n\n        return len[op];\n}\n\n#endif\n")
+}
+
+func wrGo(tab []instr, fname string) {
+	f, e := os.Create(fname)
+	if e != nil {
+		log.Fatal("Could not create ", fname)
+	}
+	defer f.Close()
+	w := bufio.NewWriter(f)
+	defer w.Flush()
+
+	fmt.Fprintf(w, "// Generated by mkoptab.go from res/myth_instructions.json, do not edit\n\n")
+	fmt.Fprintf(w, "package main\n\n// Mnemonics, appended to symTab\nvar opTab = []symbol{")
+	last := ""
+	for op, in := range tab {
+		if in.Group != last {
+			fmt.Fprintf(w, "\n\t/*%s*/\n\t", in.Group)
+			last = in.Group
+		} else if op%8 == 0 {
+			fmt.Fprintf(w, "\n\t")
+		} else {
+			fmt.Fprintf(w, " ")
+		}
+		fmt.Fprintf(w, "{0x%.02X, %q},", op, in.Name)
+	}
+	fmt.Fprintf(w, "\n}\n")
+}
+
+func main() {
+	var tab []instr
+
+	src, e := os.ReadFile("../res/myth_instructions.json")
+	if e != nil {
+		log.Fatal("Could not read instruction set")
+	}
+	if e = json.Unmarshal(src, &tab); e != nil {
+		log.Fatal("Instruction set: ", e)
+	}
+	check(tab)
+	wrC(tab, "clox/optab.h")
+	wrGo(tab, "optab.go")
+}
@@ -0,0 +1,45 @@
+// Generated by mkoptab.go from res/myth_instructions.json, do not edit
+
+package main
+
+// Mnemonics, appended to symTab
+var opTab = []symbol{
+	/*SYS*/
+	{0x00, "NOP"}, {0x01, "SSI"}, {0x02, "SSO"}, {0x03, "SCL"}, {0x04, "SCH"}, {0x05, "RET"}, {0x06, "COR"}, {0x07, "OWN"},
+	/*FIX*/
+	{0x08, "P4"}, {0x09, "P1"}, {0x0A, "P2"}, {0x0B, "P3"}, {0x0C, "M4"}, {0x0D, "M3"}, {0x0E, "M2"}, {0x0F, "M1"},
+	/*ALU*/
+	{0x10, "CLR"}, {0x11, "IDO"}, {0x12, "OCR"}, {0x13, "OCO"}, {0x14, "SLR"}, {0x15, "SLO"}, {0x16, "SRR"}, {0x17, "SRO"},
+	{0x18, "AND"}, {0x19, "IOR"}, {0x1A, "EOR"}, {0x1B, "ADD"}, {0x1C, "CAR"}, {0x1D, "RLO"}, {0x1E, "REO"}, {0x1F, "RGO"},
+	/*TRAP*/
+	{0x20, "*0"}, {0x21, "*1"}, {0x22, "*2"}, {0x23, "*3"}, {0x24, "*4"}, {0x25, "*5"}, {0x26, "*6"}, {0x27, "*7"},
+	{0x28, "*8"}, {0x29, "*9"}, {0x2A, "*10"}, {0x2B, "*11"}, {0x2C, "*12"}, {0x2D, "*13"}, {0x2E, "*14"}, {0x2F, "*15"},
+	{0x30, "*16"}, {0x31, "*17"}, {0x32, "*18"}, {0x33, "*19"}, {0x34, "*20"}, {0x35, "*21"}, {0x36, "*22"}, {0x37, "*23"},
+	{0x38, "*24"}, {0x39, "*25"}, {0x3A, "*26"}, {0x3B, "*27"}, {0x3C, "*28"}, {0x3D, "*29"}, {0x3E, "*30"}, {0x3F, "*31"},
+	/*GIRO*/
+	{0x40, "0g"}, {0x41, "1g"}, {0x42, "2g"}, {0x43, "3g"}, {0x44, "4g"}, {0x45, "5g"}, {0x46, "6g"}, {0x47, "7g"},
+	{0x48, "g0"}, {0x49, "g1"}, {0x4A, "g2"}, {0x4B, "g3"}, {0x4C, "g4"}, {0x4D, "g5"}, {0x4E, "g6"}, {0x4F, "g7"},
+	{0x50, "0i"}, {0x51, "1i"}, {0x52, "2i"}, {0x53, "3i"}, {0x54, "4i"}, {0x55, "5i"}, {0x56, "6i"}, {0x57, "7i"},
+	{0x58, "i0"}, {0x59, "i1"}, {0x5A, "i2"}, {0x5B, "i3"}, {0x5C, "i4"}, {0x5D, "i5"}, {0x5E, "i6"}, {0x5F, "i7"},
+	{0x60, "0r"}, {0x61, "1r"}, {0x62, "2r"}, {0x63, "3r"}, {0x64, "4r"}, {0x65, "5r"}, {0x66, "6r"}, {0x67, "7r"},
+	{0x68, "r0"}, {0x69, "r1"}, {0x6A, "r2"}, {0x6B, "r3"}, {0x6C, "r4"}, {0x6D, "r5"}, {0x6E, "r6"}, {0x6F, "r7"},
+	{0x70, "0o"}, {0x71, "1o"}, {0x72, "2o"}, {0x73, "3o"}, {0x74, "4o"}, {0x75, "5o"}, {0x76, "6o"}, {0x77, "7o"},
+	{0x78, "o0"}, {0x79, "o1"}, {0x7A, "o2"}, {0x7B, "o3"}, {0x7C, "o4"}, {0x7D, "o5"}, {0x7E, "o6"}, {0x7F, "o7"},
+	/*PAIR*/
+	{0x80, "no"}, {0x81, "END"}, {0x82, "SCROUNGE_NL"}, {0x83, "ng"}, {0x84, "nr"}, {0x85, "ni"}, {0x86, "ns"}, {0x87, "np"},
+	{0x88, "ne"}, {0x89, "na"}, {0x8A, "nb"}, {0x8B, "nj"}, {0x8C, "nw"}, {0x8D, "nt"}, {0x8E, "nf"}, {0x8F, "nc"},
+	{0x90, "mo"}, {0x91, "SCROUNGE_MM"}, {0x92, "SCROUNGE_ML"}, {0x93, "mg"}, {0x94, "mr"}, {0x95, "mi"}, {0x96, "ms"}, {0x97, "mp"},
+	{0x98, "me"}, {0x99, "ma"}, {0x9A, "mb"}, {0x9B, "mj"}, {0x9C, "mw"}, {0x9D, "mt"}, {0x9E, "mf"}, {0x9F, "mc"},
+	{0xA0, "lo"}, {0xA1, "SCROUNGE_LM"}, {0xA2, "SCROUNGE_LL"}, {0xA3, "lg"}, {0xA4, "lr"}, {0xA5, "li"}, {0xA6, "ls"}, {0xA7, "lp"},
+	{0xA8, "le"}, {0xA9, "la"}, {0xAA, "lb"}, {0xAB, "lj"}, {0xAC, "lw"}, {0xAD, "lt"}, {0xAE, "lf"}, {0xAF, "lc"},
+	{0xB0, "go"}, {0xB1, "gm"}, {0xB2, "gl"}, {0xB3, "SCROUNGE_GG"}, {0xB4, "gr"}, {0xB5, "gi"}, {0xB6, "gs"}, {0xB7, "gp"},
+	{0xB8, "ge"}, {0xB9, "ga"}, {0xBA, "gb"}, {0xBB, "gj"}, {0xBC, "gw"}, {0xBD, "gt"}, {0xBE, "gf"}, {0xBF, "gc"},
+	{0xC0, "ro"}, {0xC1, "rm"}, {0xC2, "rl"}, {0xC3, "rg"}, {0xC4, "SCROUNGE_RR"}, {0xC5, "ri"}, {0xC6, "rs"}, {0xC7, "rp"},
+	{0xC8, "re"}, {0xC9, "ra"}, {0xCA, "rb"}, {0xCB, "rj"}, {0xCC, "rw"}, {0xCD, "rt"}, {0xCE, "rf"}, {0xCF, "rc"},
+	{0xD0, "io"}, {0xD1, "im"}, {0xD2, "il"}, {0xD3, "ig"}, {0xD4, "ir"}, {0xD5, "SCROUNGE_II"}, {0xD6, "is"}, {0xD7, "ip"},
+	{0xD8, "ie"}, {0xD9, "ia"}, {0xDA, "ib"}, {0xDB, "ij"}, {0xDC, "iw"}, {0xDD, "it"}, {0xDE, "if"}, {0xDF, "ic"},
+	{0xE0, "so"}, {0xE1, "sm"}, {0xE2, "sl"}, {0xE3, "sg"}, {0xE4, "sr"}, {0xE5, "si"}, {0xE6, "ss"}, {0xE7, "sp"},
+	{0xE8, "se"}, {0xE9, "sa"}, {0xEA, "sb"}, {0xEB, "sj"}, {0xEC, "sw"}, {0xED, "st"}, {0xEE, "sf"}, {0xEF, "sc"},
+	{0xF0, "po"}, {0xF1, "pm"}, {0xF2, "pl"}, {0xF3, "pg"}, {0xF4, "pr"}, {0xF5, "pi"}, {0xF6, "ps"}, {0xF7, "pp"},
+	{0xF8, "pe"}, {0xF9, "pa"}, {0xFA, "pb"}, {0xFB, "pj"}, {0xFC, "pw"}, {0xFD, "pt"}, {0xFE, "pf"}, {0xFF, "pc"},
+}
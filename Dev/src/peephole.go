@@ -0,0 +1,889 @@
+/*
+   Peephole optimizer for goldie (-O)
+
+   *Myth* Project
+   Author: mim@ok-schalter.de (Michael/Dosflange@github)
+*/
+
+package main
+
+import (
+	"fmt"
+	"strings"
+	"unicode"
+)
+
+// Pass 1 notes what each word assembled as. Per unit (see
+// Incremental assembly), the instructions are then optimized and
+// the words of removed instructions deleted from srcLine, after
+// which pass 1 runs again on the rewritten source. Labels are
+// assembled from the new text, so every offset stays right and
+// lox_debug.txt shows the code as assembled.
+//
+// Only units that start a page (P[...]+ or P[...]value) and hold
+// nothing but instructions are touched: mnemonics, their literal,
+// comments, C[...] and O[...] without a value. Jumps must go to
+// <label or >label inside the unit. A string, a data byte, an
+// O[...]value or a computed jump leaves the unit as written,
+// unless it follows a label after the code: such a tail, and all
+// from a label used as data (no >Table) on, stays as it is.
+//
+// Over the basic blocks (up to a label or a jump, call, return,
+// E write or serial clock edge), along fall-through and forward
+// jumps: a block starts with the values all blocks leading to it
+// agree on, and ends with what the blocks it leads to read:
+//   - redundant loads: nX, gX etc. and GIRO moves that put into a
+//     register or local the value it already holds
+//   - dead stores: register and local writes overwritten before
+//     they are read
+// Nothing is known after a loop back or a call, nor anywhere in a
+// unit other units jump into.
+// Per unit:
+//   - jump threading: nj, nt, nf and nw to an nj go to its target,
+//     nj, nt and nf to the next instruction are removed
+//   - leaf frames: a routine without calls, COR or other writes to
+//     I does not need to save I in L6, its i6 and 6i go. OWN stays,
+//     RET reads L7.
+//
+// Memory through G:O or L:O may be a GIRO local (L:F8h-FFh), G
+// can point into the frame page.
+
+// How pass 1 assembled a word
+const (
+	wkComment = iota
+	wkOffsRef
+	wkPOC
+	wkPredef
+	wkConst
+	wkPageRef
+	wkTrap
+	wkString
+	wkUnknown
+)
+
+type wordRec struct {
+	at   srcPos
+	word string // Trailing comma chopped
+	kind int
+	unit int
+	page byte // After it
+	offs byte
+}
+
+var optimizing bool // Pass 1 notes words (-O, -L)
+var optWords []wordRec
+
+func noteWord(at srcPos, word string, kind int) {
+	if optimizing {
+		optWords = append(optWords, wordRec{at, word, kind, len(units) - 1, page, offs})
+	}
+}
+
+// Registers and GIRO locals an instruction reads or writes
+const (
+	resR = 1 << iota
+	resO
+	resG
+	resI
+	resL0 // L:F8h, resL0<<k for L:F8h+k
+)
+const resLocals = 0xFF * resL0
+const resAll = resR | resO | resG | resI | resLocals
+
+type effect struct {
+	reads   uint32
+	kills   uint32 // Always written
+	writes  uint32 // Possibly written
+	pure    bool   // No other effect, may be removed
+	barrier bool   // Ends a basic block
+}
+
+var pairSrc = [8]uint32{0, resG | resO, resO | resLocals, resG, resR, resI, 0, 0}
+var giroReg = [4]uint32{resG, resI, resR, resO}
+var aluReads = [16]uint32{0, resO, resR, resO, resR, resO, resR, resO,
+	resR | resO, resR | resO, resR | resO, resR | resO,
+	resR | resO, resR | resO, resR | resO, resR | resO}
+
+// Pair opcode destinations, see mkoptab.go
+const (
+	dstO = 0
+	dstL = 2
+	dstG = 3
+	dstR = 4
+	dstI = 5
+	dstB = 10
+	dstJ = 11
+	dstW = 12
+	dstT = 13
+	dstF = 14
+	dstC = 15
+)
+
+const (
+	opCOR = 0x06
+	opNJ  = 0x8B
+	opNW  = 0x8C
+	opNT  = 0x8D
+	opNF  = 0x8E
+	opNC  = 0x8F
+	opI6  = 0x5E
+	op6I  = 0x56
+)
+
+func isScrounge(op byte) bool {
+	src, dst := op>>4&7, op&15
+	if op&0x80 == 0 {
+		return false
+	}
+	if src <= 2 && (dst == 1 || dst == 2) {
+		return true
+	}
+	return src == dst && src >= 3 && src <= 5
+}
+
+func opLen(op byte) int {
+	if op&0xF0 == 0x80 && !isScrounge(op) {
+		return 2
+	}
+	return 1
+}
+
+func opEffect(op byte) effect {
+	switch {
+	case op&0x80 != 0:
+		if isScrounge(op) {
+			return effect{barrier: true}
+		}
+		e := effect{reads: pairSrc[op>>4&7], pure: true}
+		switch op & 15 {
+		case dstO:
+			e.kills = resO
+		case 1: // G:O
+			e.reads |= resG | resO
+			e.pure = false
+		case dstL:
+			e.reads |= resO
+			e.writes = resLocals
+			e.pure = false
+		case dstG:
+			e.kills = resG
+		case dstR:
+			e.kills = resR
+		case dstI:
+			e.kills = resI
+		case 6, 7: // SOR, POR
+			e.pure = false
+		case dstW: // Counts I down
+			e.reads |= resI
+			e.writes = resI
+			e.barrier = true
+			e.pure = false
+		case dstT, dstF:
+			e.reads |= resR
+			e.barrier = true
+			e.pure = false
+		case 9: // O += v, carry into G
+			e.reads |= resO | resG
+			e.kills = resO
+			e.writes = resG
+		default:
+			e.pure = false
+			e.barrier = true
+		}
+		e.writes |= e.kills
+		return e
+	case op&0x40 != 0:
+		reg, loc := giroReg[op>>4&3], uint32(resL0)<<(op&7)
+		if op&8 != 0 {
+			return effect{reads: reg, kills: loc, writes: loc, pure: true}
+		}
+		return effect{reads: loc, kills: reg, writes: reg, pure: true}
+	case op&0x20 != 0: // TRAP
+		return effect{barrier: true}
+	case op&0x10 != 0:
+		return effect{reads: aluReads[op&15], kills: resR, writes: resR, pure: true}
+	case op&0x08 != 0:
+		return effect{reads: resR, kills: resR, writes: resR, pure: true}
+	}
+	switch op {
+	case 0x00, 0x01: // NOP, SSI
+		return effect{}
+	case 0x07: // OWN
+		return effect{kills: resL0 << 7, writes: resL0 << 7}
+	}
+	return effect{barrier: true}
+}
+
+// Registers and GIRO locals as numbered in opEffect()
+func resIndex(bit uint32) int {
+	n := 0
+	for bit > 1 {
+		bit >>= 1
+		n++
+	}
+	return n
+}
+
+// GIRO locals an instruction may reach through G:O
+
+func viaG(op byte) (reads, writes uint32) {
+	if op&0x80 == 0 || isScrounge(op) {
+		return 0, 0
+	}
+	if op>>4&7 == 1 {
+		reads = resLocals
+	}
+	if op&15 == 1 {
+		writes = resLocals
+	}
+	return reads, writes
+}
+
+// Pair sources that are moves: the literal (0) or a register
+var pairRes = map[byte]uint32{0: 0, 3: resG, 4: resR, 5: resI}
+
+type insn struct {
+	op     byte
+	mn     int      // optWords index of the mnemonic
+	arg    int      // Of the literal, -1 if none
+	ref    string   // Jump target as written, <label or >label
+	labels []string // O[...] in front of it
+	dead   bool
+}
+
+type codeUnit struct {
+	ins  []insn
+	end  []string // Labels after the last instruction
+	page string   // Its page label
+}
+
+var opByName = map[string]byte{}
+
+// Instructions of a unit, false if it is not an instruction stream.
+// Data may follow the code from a label on, as may code that is
+// only used through a label: from the first label that a literal
+// other than a jump target refers to (no >Table, Page.Table) the
+// rest of the unit is left alone.
+
+func decodeUnit(words []int) (*codeUnit, bool) {
+	cu := &codeUnit{}
+	var labels []string
+	data := false
+
+	if len(words) == 0 || !strings.Contains(optWords[words[0]].word, "P[") {
+		return nil, false
+	}
+	w := optWords[words[0]].word
+	hasVal, label, _ := extractLabel(w)
+	if !hasVal && w[len(w)-1] != '+' {
+		return nil, false // Continues the page before
+	}
+	cu.page = label
+
+	for _, k := range words[1:] {
+		wr := &optWords[k]
+		n := len(cu.ins)
+		if wr.page != optWords[words[0]].page {
+			return nil, false // Runs into the next page
+		}
+		if wr.kind == wkPOC && strings.Contains(wr.word, "O[") {
+			hasVal, label, _ := extractLabel(wr.word)
+			if hasVal || n > 0 && cu.ins[n-1].arg == -2 {
+				return nil, false
+			}
+			labels = append(labels, label)
+			continue
+		}
+		if data || wr.kind == wkComment || wr.kind == wkPOC {
+			continue
+		}
+		if n > 0 && cu.ins[n-1].arg == -2 { // Literal expected
+			if wr.kind == wkString {
+				return nil, false
+			}
+			cu.ins[n-1].arg = k
+			continue
+		}
+		op, ok := opByName[wr.word]
+		if wr.kind == wkTrap || wr.kind == wkUnknown && wr.word[0] == '*' {
+			op, ok = 0x20, true // *label is unknown in pass 1
+		} else if wr.kind != wkPredef {
+			ok = false
+		}
+		if !ok {
+			if len(labels) == 0 {
+				return nil, false
+			}
+			data = true
+			cu.end = labels
+			continue
+		}
+		arg := -1
+		if opLen(op) == 2 {
+			arg = -2
+		}
+		cu.ins = append(cu.ins, insn{op: op, mn: k, arg: arg, labels: labels})
+		labels = nil
+	}
+	if !data {
+		cu.end = labels
+	}
+	if n := len(cu.ins); n > 0 && cu.ins[n-1].arg == -2 {
+		return nil, false
+	}
+
+	// Cut at the first label used as data
+	used := map[string]bool{}
+	for k := range optWords {
+		wr := &optWords[k]
+		if wr.kind == wkOffsRef || wr.kind == wkUnknown {
+			if part := strings.Split(wr.word, "."); len(part) > 1 && part[0] == cu.page {
+				used[part[1]] = true
+			}
+		}
+	}
+	for _, in := range cu.ins {
+		if in.arg >= 0 && !isJump(in.op) {
+			if ref := optWords[in.arg].word; len(ref) > 1 && (ref[0] == '<' || ref[0] == '>') {
+				used[ref[1:]] = true
+			}
+		}
+	}
+	for i, in := range cu.ins {
+		for _, l := range in.labels {
+			if used[l] {
+				cu.ins, cu.end = cu.ins[:i], in.labels
+				break
+			}
+		}
+	}
+
+	// Jumps only to labels of this unit
+	for i := range cu.ins {
+		in := &cu.ins[i]
+		if !isJump(in.op) {
+			continue
+		}
+		if in.op&0x70 != 0 {
+			return nil, false // Computed
+		}
+		ref := optWords[in.arg].word // >label is unknown in pass 1
+		if len(ref) < 2 || ref[0] != '<' && ref[0] != '>' {
+			return nil, false
+		}
+		in.ref = ref
+		if cu.resolve(i, ref) == -1 {
+			return nil, false
+		}
+	}
+	return cu, true
+}
+
+func isJump(op byte) bool {
+	return op&0x80 != 0 && !isScrounge(op) && op&15 >= dstJ && op&15 <= dstF
+}
+
+func (cu *codeUnit) labelsAt(p int) []string {
+	if p == len(cu.ins) {
+		return cu.end
+	}
+	return cu.ins[p].labels
+}
+
+func hasLabel(labels []string, name string) bool {
+	for _, l := range labels {
+		if l == name {
+			return true
+		}
+	}
+	return false
+}
+
+// Instruction a jump at i to 'ref' lands on, as backRef() and
+// fwdRef() find it, len(ins) past the end, -1 if not in the unit
+
+func (cu *codeUnit) resolve(i int, ref string) int {
+	if ref[0] == '<' {
+		for p := i; p >= 0; p-- {
+			if hasLabel(cu.labelsAt(p), ref[1:]) {
+				return p
+			}
+		}
+		return -1
+	}
+	for p := i + 1; p <= len(cu.ins); p++ {
+		if hasLabel(cu.labelsAt(p), ref[1:]) {
+			return p
+		}
+	}
+	return -1
+}
+
+func (cu *codeUnit) live(p int) int {
+	for p < len(cu.ins) && cu.ins[p].dead {
+		p++
+	}
+	return p
+}
+
+// Basic blocks as index ranges over the instructions, dead ones
+// included
+
+func (cu *codeUnit) blocks() [][2]int {
+	var b [][2]int
+	start := 0
+	labelled := false
+	for i := range cu.ins {
+		in := &cu.ins[i]
+		labelled = labelled || len(in.labels) > 0
+		if in.dead {
+			continue
+		}
+		if labelled && i > start {
+			b = append(b, [2]int{start, i})
+			start = i
+		}
+		labelled = false
+		if opEffect(in.op).barrier {
+			b = append(b, [2]int{start, i + 1})
+			start = i + 1
+		}
+	}
+	return append(b, [2]int{start, len(cu.ins)})
+}
+
+// Blocks each block may continue with, -1 for the end of the unit
+// and for jumps past the last instruction
+
+func (cu *codeUnit) flow(bs [][2]int) [][]int {
+	at := make([]int, len(cu.ins)+1) // Block of each instruction
+	for k, b := range bs {
+		for i := b[0]; i < b[1]; i++ {
+			at[i] = k
+		}
+	}
+	at[len(cu.ins)] = -1
+
+	succ := make([][]int, len(bs))
+	for k, b := range bs {
+		next := -1
+		if k+1 < len(bs) {
+			next = k + 1
+		}
+		last := b[1] - 1
+		for last >= b[0] && cu.ins[last].dead {
+			last--
+		}
+		if last < b[0] || !isJump(cu.ins[last].op) {
+			succ[k] = []int{next} // Calls return here
+			continue
+		}
+		in := &cu.ins[last]
+		succ[k] = []int{at[cu.live(cu.resolve(last, in.ref))]}
+		if in.op != opNJ {
+			succ[k] = append(succ[k], next)
+		}
+	}
+	return succ
+}
+
+// Value of the literal of instruction i, same words give the same
+// byte in pass 2 except offset references
+
+func (cu *codeUnit) literal(i int, ids map[string]int, next *int) int {
+	wr := &optWords[cu.ins[i].arg]
+	key := wr.word
+	switch wr.kind {
+	case wkOffsRef:
+		*next++
+		return *next
+	case wkPredef:
+		for _, s := range symTab {
+			if s.str == wr.word {
+				key = fmt.Sprint("#", s.val)
+				break
+			}
+		}
+	}
+	if _, ok := ids[key]; !ok {
+		*next++
+		ids[key] = *next
+	}
+	return ids[key]
+}
+
+// Redundant loads, by value numbering over the blocks, 'entered'
+// as for dropFrame()
+
+func (cu *codeUnit) dropLoads(entered bool) int {
+	ids := map[string]int{}
+	next := 0
+	n := 0
+	bs := cu.blocks()
+	pred := make([][]int, len(bs))
+	for k, s := range cu.flow(bs) {
+		for _, t := range s {
+			if t != -1 {
+				pred[t] = append(pred[t], k)
+			}
+		}
+	}
+	out := make([][12]int, len(bs)) // Values at the end of each block
+
+	for k, b := range bs {
+		var val [12]int
+		known := len(pred[k]) > 0 && !entered
+		for _, p := range pred[k] {
+			known = known && p < k
+		}
+		for r := range val {
+			if known {
+				val[r] = out[pred[k][0]][r]
+				for _, p := range pred[k][1:] {
+					if out[p][r] != val[r] {
+						val[r] = 0
+					}
+				}
+			}
+			if val[r] == 0 {
+				next++
+				val[r] = next
+			}
+		}
+		for i := b[0]; i < b[1]; i++ {
+			in := &cu.ins[i]
+			if in.dead {
+				continue
+			}
+			e := opEffect(in.op)
+			_, alias := viaG(in.op)
+			e.writes |= alias
+			if e.barrier && !isJump(in.op) {
+				e.writes = resAll // Unknown on return
+			}
+			src, dst := -1, -1 // Resource indices of a move
+			v := 0
+			switch {
+			case in.op&0x80 != 0 && e.pure && e.kills != 0 && e.writes == e.kills:
+				dst = resIndex(e.kills)
+				if s, ok := pairRes[in.op>>4&7]; ok {
+					if s == 0 {
+						v = cu.literal(i, ids, &next)
+					} else {
+						src = resIndex(s)
+					}
+				}
+			case in.op&0xC0 == 0x40:
+				src, dst = resIndex(e.reads), resIndex(e.kills)
+			}
+			if src != -1 {
+				v = val[src]
+			}
+			if dst != -1 && v != 0 && val[dst] == v {
+				in.dead = true
+				n++
+				continue
+			}
+			for k := range val {
+				if e.writes&(1<<k) != 0 {
+					next++
+					val[k] = next
+				}
+			}
+			if dst != -1 && v != 0 {
+				val[dst] = v
+			}
+		}
+		out[k] = val
+	}
+	return n
+}
+
+// Dead stores, by liveness over the blocks backwards
+
+func (cu *codeUnit) dropStores() int {
+	n := 0
+	bs := cu.blocks()
+	succ := cu.flow(bs)
+	entry := make([]uint32, len(bs)) // Live at the start of each block
+
+	for k := len(bs) - 1; k >= 0; k-- {
+		b := bs[k]
+		live := uint32(0)
+		for _, t := range succ[k] {
+			if t <= k {
+				live = resAll // End of the unit or loop back
+			} else {
+				live |= entry[t]
+			}
+		}
+		for i := b[1] - 1; i >= b[0]; i-- {
+			in := &cu.ins[i]
+			if in.dead {
+				continue
+			}
+			e := opEffect(in.op)
+			alias, _ := viaG(in.op)
+			e.reads |= alias
+			if e.barrier && isJump(in.op) {
+				live |= e.reads
+				continue
+			}
+			if e.barrier {
+				live = resAll
+				continue
+			}
+			if e.pure && e.writes&live == 0 {
+				in.dead = true
+				n++
+				continue
+			}
+			live = live&^e.kills | e.reads
+		}
+		entry[k] = live
+	}
+	return n
+}
+
+// Reference from instruction i that lands on t, "" if none
+
+func (cu *codeUnit) refTo(i int, t int) string {
+	for p := 0; p <= len(cu.ins); p++ {
+		if cu.live(p) != t {
+			continue
+		}
+		for _, l := range cu.labelsAt(p) {
+			ref := ">" + l
+			if p <= i {
+				ref = "<" + l
+			}
+			if cu.live(cu.resolve(i, ref)) == t {
+				return ref
+			}
+		}
+	}
+	return ""
+}
+
+// Jump threading
+
+func (cu *codeUnit) threadJumps() int {
+	n := 0
+	for i := range cu.ins {
+		in := &cu.ins[i]
+		if in.dead || in.op < opNJ || in.op > opNF {
+			continue
+		}
+		from := cu.live(cu.resolve(i, in.ref))
+		t := from
+		seen := map[int]bool{}
+		for t < len(cu.ins) && cu.ins[t].op == opNJ && !seen[t] {
+			seen[t] = true
+			t = cu.live(cu.resolve(t, cu.ins[t].ref))
+		}
+		if in.op != opNW && t == cu.live(i+1) {
+			in.dead = true
+			n++
+		} else if ref := cu.refTo(i, t); t != from && ref != "" {
+			in.ref = ref
+			n++
+		}
+	}
+	return n
+}
+
+// Leaf frame elision, 'entered' if another unit refers to one of
+// its labels and may jump there
+
+func (cu *codeUnit) dropFrame(entered bool) int {
+	var frame []int
+	first := true // No label or jump yet
+	saved := false
+
+	if entered {
+		return 0
+	}
+	for i := range cu.ins {
+		in := &cu.ins[i]
+		if len(in.labels) > 0 {
+			first = false
+		}
+		if in.dead {
+			continue
+		}
+		op := in.op
+		e := opEffect(op)
+		switch {
+		case op == opI6:
+			if !saved && !first {
+				return 0
+			}
+			saved = true
+			frame = append(frame, i)
+		case op == op6I:
+			frame = append(frame, i)
+		case op == opCOR || op&0xE0 == 0x20:
+			return 0
+		case op&0x80 != 0 && (op&15 == dstW || op&15 == dstB || op&15 == dstC):
+			return 0
+		case (e.reads|e.writes)&(resI|resL0<<6) != 0:
+			return 0
+		}
+		if e.barrier {
+			first = false
+		}
+	}
+	if !saved {
+		return 0
+	}
+	for _, i := range frame {
+		cu.ins[i].dead = true
+	}
+	return len(frame)
+}
+
+// Optimize all units, rewrite srcLine, true if anything changed
+
+func optimize() bool {
+	var loads, stores, jumps, frames int
+
+	byUnit := unitWords()
+	entered := map[string]bool{} // Pages whose labels other units use
+	for _, wr := range optWords {
+		if wr.kind == wkOffsRef && wr.word[0] != '<' && wr.word[0] != '>' {
+			entered[strings.Split(wr.word, ".")[0]] = true
+		}
+	}
+
+	edits := map[srcPos]string{} // New text of a word, "" deletes it
+	for u := 1; u < len(units); u++ {
+		cu, ok := decodeUnit(byUnit[u])
+		if !ok {
+			continue
+		}
+		for {
+			l, s := cu.dropLoads(entered[cu.page]), cu.dropStores()
+			j := cu.threadJumps()
+			f := cu.dropFrame(entered[cu.page])
+			loads, stores, jumps, frames = loads+l, stores+s, jumps+j, frames+f
+			if l+s+j+f == 0 {
+				break
+			}
+		}
+		for _, in := range cu.ins {
+			if in.dead {
+				edits[optWords[in.mn].at] = ""
+				if in.arg >= 0 {
+					edits[optWords[in.arg].at] = ""
+				}
+			} else if in.ref != "" && in.ref != optWords[in.arg].word {
+				edits[optWords[in.arg].at] = in.ref
+			}
+		}
+	}
+	fmt.Printf("Optimizer: %d loads, %d stores, %d frame saves removed, %d jumps threaded\n",
+		loads, stores, frames, jumps)
+
+	editSource(edits)
+	return loads+stores+jumps+frames > 0
+}
+
+// Indices into optWords per unit
+
+func unitWords() [][]int {
+	for _, s := range opTab {
+		opByName[s.str] = s.val
+	}
+	byUnit := make([][]int, len(units))
+	for k, wr := range optWords {
+		byUnit[wr.unit] = append(byUnit[wr.unit], k)
+	}
+	return byUnit
+}
+
+func editSource(edits map[srcPos]string) {
+	lines := map[int]bool{}
+	for at := range edits {
+		lines[at.line] = true
+	}
+	code := map[srcPos]bool{} // Words that are not comments
+	for _, wr := range optWords {
+		if lines[wr.at.line] && wr.kind != wkComment {
+			code[wr.at] = true
+		}
+	}
+	for l := range lines {
+		srcLine[l-1] = editLine(srcLine[l-1], l, edits, code)
+	}
+}
+
+// Apply the edits of one line, words as strings.Fields() splits it.
+// A comma ends a group of instructions: the comma of a deleted word
+// goes to the word before it in its group, and one left at the end
+// of the code on the line is dropped.
+
+func editLine(line string, lnum int, edits map[srcPos]string, code map[srcPos]bool) string {
+	var span [][2]int
+	start := -1
+	for i, c := range line {
+		if unicode.IsSpace(c) {
+			if start >= 0 {
+				span = append(span, [2]int{start, i})
+				start = -1
+			}
+		} else if start < 0 {
+			start = i
+		}
+	}
+	if start >= 0 {
+		span = append(span, [2]int{start, len(line)})
+	}
+	if len(span) == 0 {
+		return line
+	}
+
+	var word, gap []string // Kept words, the space after each
+	last := -1             // Last kept code word
+	tail := false          // Code after it was deleted
+	lastGone := false
+	for w, sp := range span {
+		end := len(line)
+		if w+1 < len(span) {
+			end = span[w+1][0]
+		}
+		at := srcPos{lnum, w}
+		orig := line[sp[0]:sp[1]]
+		comma := orig[len(orig)-1] == ','
+		text, ok := edits[at]
+		lastGone = ok && text == ""
+		switch {
+		case !ok:
+			text = orig
+		case text == "":
+			tail = true
+			if comma && last >= 0 && !strings.HasSuffix(word[last], ",") {
+				word[last] += ","
+			}
+			continue
+		case comma:
+			text += ","
+		}
+		if code[at] {
+			last, tail = len(word), false
+		}
+		word = append(word, text)
+		gap = append(gap, line[sp[1]:end])
+	}
+	if tail && last >= 0 {
+		word[last] = strings.TrimSuffix(word[last], ",")
+	}
+
+	out := line[:span[0][0]]
+	for k := range word {
+		out += word[k] + gap[k]
+	}
+	if lastGone {
+		out = strings.TrimRightFunc(out, unicode.IsSpace)
+	}
+	return out
+}
@@ -6,6 +6,7 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -36,8 +37,6 @@
 #define RHS_A   14 // Internal
 #define RHS_B   15 // Utility
 
-unsigned pass; /* counts assembly passes */
-
 /* Generate table of all possible ALU mnemonics */
 /* Array index equates to operation code */
 
@@ -121,6 +120,9 @@ void gen_opcodes()
             else if (i==RHS_M && j==LHS_M) {
                 strcpy( mnemo_decoder[j*16+i], "LID" );
             }
+            else if (i==RHS_R && j==LHS_R) { /* Halts sonne_run.c */
+                strcpy( mnemo_decoder[j*16+i], "HALT" );
+            }
             else if (i==RHS_SIG) { /* Signals */
                 strcat( mnemo_decoder[j*16+i], lhs_S[j]);
                 //printf("%s %d %d\n", mnemo_decoder[j*16+i], j*16, i);
@@ -177,6 +179,90 @@ struct {
 } defmap[8192];
 unsigned defmap_topindex;
 
+/* Frame labels by name. A name may label several frames, last is
+   the latest one assembled so far (backward references), first the
+   lowest below 128 (micro-calls), -1 if none. Both hold the byte a
+   reference stores, frames following RAM run from row 80h up.
+*/
+
+struct {
+    char name[SYMSIZE];
+    int last;
+    int first;
+} labelset[256];
+unsigned labelset_topindex;
+
+/* Names referenced before their definition, each with a chain
+   of fixups, see below
+*/
+
+struct {
+    char name[SYMSIZE];
+    int head; /* -1 if none pending */
+} pendset[128*128];
+unsigned pendset_topindex;
+
+
+/* Hashed look-up of mnemonics, definitions and labels.
+   Open addressing with linear probing, a slot holds index+1
+   into alu_mnemo[], mnemo_decoder[], defmap[], labelset[] or
+   pendset[], 0 if empty. A name keeps the first index added,
+   as with the linear scans these replace.
+*/
+
+#define HASHSIZE 32768 /* Power of two, over twice any table */
+
+unsigned alu_hash[HASHSIZE];
+unsigned mnemo_hash[HASHSIZE];
+unsigned def_hash[HASHSIZE];
+unsigned label_hash[HASHSIZE];
+unsigned pend_hash[HASHSIZE];
+
+const char *alu_key( unsigned i) { return alu_mnemo[i]; }
+const char *mnemo_key( unsigned i) { return mnemo_decoder[i]; }
+const char *def_key( unsigned i) { return defmap[i].name; }
+const char *label_key( unsigned i) { return labelset[i].name; }
+const char *pend_key( unsigned i) { return pendset[i].name; }
+
+unsigned
+hashname( const char *s)
+{
+    unsigned h = 2166136261u; /* FNV-1a */
+    while (*s) h = (h ^ (uint8_t) *s++) * 16777619u;
+    return h;
+}
+
+int
+hash_find( unsigned *tab, const char *(*key)(unsigned), const char *name)
+{
+    unsigned i = hashname(name) & (HASHSIZE-1);
+
+    for (; tab[i]; i = (i+1) & (HASHSIZE-1))
+        if (!strcmp(key(tab[i]-1), name)) return tab[i]-1;
+    return -1;
+}
+
+void
+hash_add( unsigned *tab, const char *(*key)(unsigned), const char *name, unsigned idx)
+{
+    unsigned i = hashname(name) & (HASHSIZE-1);
+
+    for (; tab[i]; i = (i+1) & (HASHSIZE-1))
+        if (!strcmp(key(tab[i]-1), name)) return;
+    tab[i] = idx+1;
+}
+
+void def_add( unsigned i) { hash_add(def_hash, def_key, defmap[i].name, i); }
+
+/* Hash the precompiled tables and populate_defmap() entries */
+
+    void hash_tables()
+    {
+        for (int i=0; i<256; i++) hash_add(alu_hash, alu_key, alu_mnemo[i], i);
+        for (int i=0; i<256; i++) hash_add(mnemo_hash, mnemo_key, mnemo_decoder[i], i);
+        for (int i=0; i<defmap_topindex; i++) def_add(i);
+    }
+
 #define BYTE_TO_BINARY_PATTERN "%c%c%c%c.%c%c%c%c"
 #define BYTE_TO_BINARY(byte)  \
   (byte & 0x80 ? '1' : '0'), \
@@ -350,7 +436,7 @@ long srclength; /* Number of bytes in src file */
         return buffer;
     }
 
-uint8_t isinram = 0; // Horrible hack for RAM branch targets, all so broken, so lost
+uint8_t isinram = 0; /* Past RAM, labels refer to frame + 80h */
 
 uint8_t ROM_mem[128*128]; /* 128 (ROM only) frames * 128 bytes = 32k */
 unsigned ROM_srcLine[128*128]; /* Which line number generated the output byte */
@@ -412,30 +498,14 @@ unsigned lines; /* tracks number of lines processed */
 
     int find_backref(char* refstr)
     {
-        //printf("BACKW REFSTR=%s\n", refstr);
-        unsigned here;
-            here = objframe;
-            for (int i=here; i>=0; i--)
-                if (!strcmp(refstr, frame_mnemo[i])) return i;
-        return -1;
-    }
-
-    int find_fwdref(char* refstr)
-    {
-        //printf("FWD REFSTR=%s\n", refstr);
-        unsigned here;
-            here = objframe + 1;
-            for (int i=here; i<256; i++)
-                if (!strcmp(refstr, frame_mnemo[i])) return i;
-        return -1;
+        int k = hash_find(label_hash, label_key, refstr);
+        return k == -1 ? -1 : labelset[k].last;
     }
 
     int find_mcref(char* refstr)
     {
-        //printf("FWD REFSTR=%s\n", refstr);
-        unsigned here;
-        for (int i=0; i<128; i++) if (!strcmp(refstr, frame_mnemo[i])) return i;
-        return -1;
+        int k = hash_find(label_hash, label_key, refstr);
+        return k == -1 ? -1 : labelset[k].first;
     }
 
 
@@ -445,44 +515,25 @@ unsigned lines; /* tracks number of lines processed */
 
     int defmap_frame_and_type(char* buf, uint8_t* typefound)
     {
-        for (int i=0; i<defmap_topindex; i++)
-        {
-            if (!strcmp( defmap[i].name, buf)) {
-                //printf ("Found def %s\n", wordbuf);
-                *typefound = defmap[i].type;
-                return defmap[i].frame;
-            }
-        }
-        return -1;
+        int i = hash_find(def_hash, def_key, buf);
+
+        if (i == -1) return -1;
+        *typefound = defmap[i].type;
+        return defmap[i].frame;
     }
 
 /* Try to find an entry matching wordbuf in precompiled mnemonics */
 
     int compare_to_tables(char* buf)
     {
-        for (int i=0; i<256; i++)
-        {
-            if (!strcmp( alu_mnemo[i], buf)) {
-                //printf ("Found alu mnemonic %s - %02X\n", wordbuf, (i<<4) & (i>>4));
-                return i;
-            }
-        }
-
-        for (int i=0; i<256; i++)
-        {
-            if (!strcmp( mnemo_decoder[i], buf)) {
-                //printf ("Found mnemonic %s (%02X)\n", wordbuf, i);
-                return i;
-            }
-        }
+        int i;
 
-        for (int i=0; i<defmap_topindex; i++)
-        {
-            if (!strcmp( defmap[i].name, buf)) {
-                //printf ("Found def (or number literal!) %s\n", buf);
-                return defmap[i].val;
-            }
-        }
+        i = hash_find(alu_hash, alu_key, buf);
+        if (i != -1) return i;
+        i = hash_find(mnemo_hash, mnemo_key, buf);
+        if (i != -1) return i;
+        i = hash_find(def_hash, def_key, buf);
+        if (i != -1) return defmap[i].val;
         return -1;
     }
 
@@ -502,6 +553,114 @@ unsigned lines; /* tracks number of lines processed */
     }
 
 
+/* Fixup list: a reference to a name not defined yet stores a
+   placeholder byte and a fixup chained to the name in pendset[].
+   Defining the name patches the placeholders of its kind, so the
+   source is read only once.
+*/
+
+#define FIX_FWD   0 /* >LABEL, next frame labelled */
+#define FIX_MCALL 1 /* *LABEL, first frame labelled, ORed with 80h */
+#define FIX_FRAME 2 /* #NAME, frame of the definition */
+#define FIX_VAL   3 /* NAME, value of the definition */
+
+char *fix_prefix[] = { ">", "*", "#", "" };
+
+struct {
+    unsigned addr; /* ROM_mem index of the placeholder */
+    unsigned line;
+    uint8_t kind;
+    int next;
+} fixup[128*128];
+unsigned fixup_topindex;
+
+    void store_fixup( char* name, uint8_t kind)
+    {
+        int k = hash_find(pend_hash, pend_key, name);
+
+        if (k == -1) {
+            k = pendset_topindex++;
+            strcpy(pendset[k].name, name);
+            pendset[k].head = -1;
+            hash_add(pend_hash, pend_key, name, k);
+        }
+        fixup[fixup_topindex].addr = objframe * 128 + objcursor;
+        fixup[fixup_topindex].line = lines;
+        fixup[fixup_topindex].kind = kind;
+        fixup[fixup_topindex].next = pendset[k].head;
+        pendset[k].head = fixup_topindex++;
+        store(0);
+    }
+
+/* Patch the pending fixups of one kind for name, unlink them */
+
+    void resolve( char* name, uint8_t kind, uint8_t byte)
+    {
+        int k = hash_find(pend_hash, pend_key, name);
+        int *link;
+
+        if (k == -1) return;
+        for (link = &pendset[k].head; *link != -1; )
+            if (fixup[*link].kind == kind) {
+                ROM_mem[fixup[*link].addr] = byte;
+                *link = fixup[*link].next;
+            }
+            else link = &fixup[*link].next;
+    }
+
+/* Report what is still pending after the last line */
+
+    void unresolved()
+    {
+        int i, fatal = 0;
+
+        for (int k=0; k<pendset_topindex; k++)
+            for (i = pendset[k].head; i != -1; i = fixup[i].next) {
+                if (fixup[i].kind == FIX_FWD)
+                    printf("Unresolved reference '>%s', line %d\n** ERROR **\n", pendset[k].name, fixup[i].line);
+                else if (fixup[i].kind == FIX_MCALL)
+                    printf("Unresolved micro-call reference '*%s', line %d\n** ERROR **\n", pendset[k].name, fixup[i].line);
+                else
+                    printf("Unknown symbol: %s%s, line %d\n** ERROR **\n", fix_prefix[fixup[i].kind], pendset[k].name, fixup[i].line);
+                fatal = 1; /* A placeholder would shift the image */
+            }
+        if (fatal) exit(1);
+    }
+
+/* Define a frame label, frames following RAM run from row 80h up */
+
+    void label_define( char* name)
+    {
+        int k = hash_find(label_hash, label_key, name);
+
+        if (k == -1) {
+            k = labelset_topindex++;
+            strcpy(labelset[k].name, name);
+            labelset[k].first = -1;
+            hash_add(label_hash, label_key, name, k);
+        }
+        labelset[k].last = isinram ? objframe+128 : objframe;
+        resolve(name, FIX_FWD, labelset[k].last);
+        if (labelset[k].first == -1 && objframe < 128) {
+            labelset[k].first = objframe;
+            resolve(name, FIX_MCALL, objframe | 0x80);
+        }
+    }
+
+/* Add a definition or offset label, the first of a name counts */
+
+    void def_define( char* name, uint8_t val, uint8_t frame, int type)
+    {
+        strcpy(defmap[defmap_topindex].name, name);
+        defmap[defmap_topindex].val = val;
+        defmap[defmap_topindex].frame = frame;
+        defmap[defmap_topindex].type |= type;
+        def_add(defmap_topindex++);
+        resolve(name, FIX_FRAME, frame);
+        resolve(name, FIX_VAL, val);
+    }
+
+
 int labelallowed; /* Only one frame label per full-stop */
 int endframe;
 int handled;
@@ -591,16 +750,9 @@ int ramgap;
                     wordbuf[endpos] = '\0';
                     
                     /* ! prefix means export this symbol, don't throw away */
-                    /* pass ==2 avoid duplicate export symbols */
-                    if (wordbuf[0]=='!' && pass==2) {
-                      defmap[defmap_topindex].type |= 1;
-                      /* Skip ! */
-                      strcpy( defmap[defmap_topindex].name, wordbuf+1 );
-                    } 
-                    else strcpy( defmap[defmap_topindex].name, wordbuf );
-                    defmap[defmap_topindex].val = objcursor + 1;
-                    defmap[defmap_topindex].frame = objframe;
-                    defmap_topindex++;
+                    if (wordbuf[0]=='!')
+                        def_define(wordbuf+1, objcursor + 1, objframe, 1);
+                    else def_define(wordbuf, objcursor + 1, objframe, 0);
                     handled = 1;
                 }
             }
@@ -613,6 +765,10 @@ int ramgap;
                     store(k);
                     handled = 1;
                 }
+                else if (strlen(wordbuf)>1) {
+                    store_fixup(wordbuf+1, FIX_FRAME);
+                    handled = 1;
+                }
             }
 
             /* Check for frame label definition */
@@ -637,6 +793,7 @@ int ramgap;
                         }
                         else frame_mnemo_export[objframe] = 0;
                         strcpy(frame_mnemo[objframe], wordbuf+1);
+                        label_define(wordbuf+1);
                         //printf("Defining @%s\n", wordbuf+1);
                         labelallowed = 0; /* only 1 frame label per full stop */
                         handled = 1;
@@ -656,6 +813,11 @@ int ramgap;
                         exit(0);
                     }
                     k = find_backref(wordbuf+1);
+                    if (k == -1) {
+                        printf("Unresolved reference '%s', line %d\n** ERROR **\n", wordbuf, lines);
+                        exit(0);
+                    }
+                    store(k);
                     handled = 1;
                 }
                 if (wordbuf[0]=='>') {
@@ -663,20 +825,9 @@ int ramgap;
                         printf("Empty forward reference, line %d\n** ERROR **\n", lines);
                         exit(0);
                     }
-                    k = find_fwdref(wordbuf+1);
-                    //printf("searching for >%s\n",wordbuf+1);
+                    store_fixup(wordbuf+1, FIX_FWD); /* Next frame labelled so */
                     handled = 1;
                 }
-                if (handled && k == -1) {
-                    if (pass==2) {
-                        printf("Unresolved reference '%s', line %d\n** ERROR **\n", wordbuf, lines);
-                        exit(0);
-                    }
-                }
-                if (handled) {
-                     store(isinram ? k+128 : k);
-                     //printf("k was %d for %s\n", k, wordbuf);   
-                }
             }
 
 
@@ -715,16 +866,8 @@ int ramgap;
                     }
 
                     /* ! prefix means export this symbol, don't throw away */
-                    /* pass ==1 avoid duplicate export symbols */
-                    if (pass==1){
-                        if (wordbuf[0]=='!') {
-                            defmap[defmap_topindex].type |= 1;
-                            /* Skip ! */
-                            strcpy( defmap[defmap_topindex].name, wordbuf+1 );
-                        }
-                        else strcpy(defmap[defmap_topindex].name, wordbuf);
-                        defmap[defmap_topindex++].val = k;
-                    }        
+                    if (wordbuf[0]=='!') def_define(wordbuf+1, k, 0, 1);
+                    else def_define(wordbuf, k, 0, 0);
                     handled = 1;
                 }
             }
@@ -737,16 +880,9 @@ int ramgap;
                     }
                     /* Check if it's a micro-call */
                     k = find_mcref(wordbuf+1);
-                    if (k != -1) {
-                        handled = 1;
-                        store(k | 0x80);
-                        //store(k); // Fling is gone
-                    } else {
-                        if (pass==2) {
-                            printf("Unresolved micro-call reference '%s', line %d\n** ERROR **\n", wordbuf, lines);
-                            exit(0);
-                        }
-                    }
+                    if (k != -1) store(k | 0x80);
+                    else store_fixup(wordbuf+1, FIX_MCALL);
+                    handled = 1;
                 }
             }
 
@@ -761,8 +897,9 @@ int ramgap;
                 }
             }
 
-            if (!handled)
-            //if (!handled && pass==2)
+            if (!handled && wordbuf[0]) /* Maybe defined further down */
+                store_fixup(wordbuf, FIX_VAL);
+            else if (!handled)
             {
                printf("Unknown symbol: %s, line %d\n", wordbuf, lines);
             }
@@ -842,26 +979,24 @@ int main (int arc, char **argv)
 	printf("%ld bytes read\n", srclength);
 
 	clear();
-    pass = 0;
 
     gen_alu_opcodes();
     gen_opcodes(); //for (int i=0; i<128; i++) printf("%s\n", mnemo_decoder[i]);
     populate_defmap(); //for (int i=0; i<defmap_topindex; i++) printf("%s %d\n", defmap[i].name, defmap[i].val);
+    hash_tables();
 
-    for (pass=1; pass<3; pass++) {
-        printf("Pass %d\n", pass);
-
-        for (int i=0; i<128; i++) frame_lid[i] = 0;
-        for (int i=0; i<128; i++) ROM_srcLine[i] = 0;
+    /* One pass, forward references are patched through the fixups */
+    for (int i=0; i<128; i++) frame_lid[i] = 0;
+    for (int i=0; i<128; i++) ROM_srcLine[i] = 0;
 
-        ramgap = -1;
-        cursor = 0;
-        objcursor = 0;
-        objframe = 0;
-        lines=0;
-        labelallowed=1;
-    	while (beginline()); /* Traverse source-text by lines */
-    }
+    ramgap = -1;
+    cursor = 0;
+    objcursor = 0;
+    objframe = 0;
+    lines=0;
+    labelallowed=1;
+	while (beginline()); /* Traverse source-text by lines */
+    unresolved();
 
 	    printf("%d lines processed\n", lines);
 
@@ -985,18 +1120,27 @@ int main (int arc, char **argv)
     int outputlen;
     int lead_frame=0, lead_offset=0;
 
+    /* Object code bytes by source line, each line's list in frame
+       and offset order, so every byte is visited once
+    */
+    unsigned maxline = 0, npos = (objframe < 128 ? objframe+1 : 128) * 128;
+    static int line_next[128*128];
+    for (int i=0; i<npos; i++)
+        if (ROM_srcLine[i] > maxline) maxline = ROM_srcLine[i];
+    int *line_head = malloc((maxline+1) * sizeof(int));
+    for (int i=0; i<=maxline; i++) line_head[i] = -1;
+    for (int i=npos-1; i>=0; i--) {
+        line_next[i] = line_head[ROM_srcLine[i]];
+        line_head[ROM_srcLine[i]] = i;
+    }
+
     while (k<srclength) {
 
         /* Write object code generated for line*/
 
-        lead_frame = -1;
-        lead_offset = -1;
-        for (int frame=0; frame<=objframe; frame++)
-            for (int offset=0; offset<128; offset++)
-                if (ROM_srcLine[frame*128 + offset] == lines) {
-                    if (lead_frame == -1) lead_frame = frame;
-                    if (lead_offset == -1) lead_offset = offset;
-                }
+        int pos = lines <= maxline ? line_head[lines] : -1;
+        lead_frame = pos == -1 ? -1 : pos / 128;
+        lead_offset = pos == -1 ? -1 : pos % 128;
 
         if (lead_frame != -1 || lead_offset != -1)
         {
@@ -1006,20 +1150,19 @@ int main (int arc, char **argv)
 
         outputlen = 0;
         int linefill = 0;
-        for (int frame=0; frame<=objframe; frame++) {
-            for (int offset=0; offset<128; offset++) {
-                if (ROM_srcLine[frame*128 + offset] == lines) {
-                    if (!(++linefill%8)) {
-                        fprintf(f, "\n        ");
-                        outputlen -= 21;
-                    }
-                    lead_frame = frame;
-                    lead_offset = offset;
-                    fprintf(f, "%02X ", ROM_mem[frame*128+offset]);
-                    outputlen += 3;
-                    if (offset>frame_lid[frame]) break;
-                }
+        int skipframe = -1; /* Rest of this frame is past its lid */
+        for (; pos != -1; pos = line_next[pos]) {
+            int frame = pos / 128, offset = pos % 128;
+            if (frame == skipframe) continue;
+            if (!(++linefill%8)) {
+                fprintf(f, "\n        ");
+                outputlen -= 21;
             }
+            lead_frame = frame;
+            lead_offset = offset;
+            fprintf(f, "%02X ", ROM_mem[frame*128+offset]);
+            outputlen += 3;
+            if (offset>frame_lid[frame]) skipframe = frame;
         }
 
         if (outputlen) outputlen = outputlen>(24+3) ? 24 : outputlen-3;
@@ -1040,6 +1183,7 @@ int main (int arc, char **argv)
         fprintf(f, "\n");
     }
 
+    free(line_head);
     fclose(f);
 
 }
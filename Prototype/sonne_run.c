@@ -5,6 +5,13 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define BLUR_SIZE (16*256*256) // ALU look-up ROM, 16 maps of 256*256
 
 
 uint8_t	pc_low, pc_low_copy,
@@ -22,6 +29,8 @@ uint8_t	pc_low, pc_low_copy,
 		alu_op, alu_copy, alu_lock,
 		memory[256*256];
 
+uint8_t *blur; // Mapped ROM image for hardware ALU mode, else NULL
+
 
 uint8_t par_in()
 {
@@ -41,7 +50,8 @@ uint8_t alu_result()
 	uint8_t offs = alu_op >> 4;
 	if (offs>7) offs += (15<<4); // Sign  extend
 	uint8_t op = alu_op & 15;
-	switch(op){
+	if (blur) alu_copy = blur[op*65536 + bacc*256 + aacc]; // ROM address lines
+	else switch(op){
 	case 0: alu_copy = aacc; break; // IDA
 	case 1: alu_copy = bacc; break; // IDB
 	case 2: alu_copy = ~aacc; break; // OCA
@@ -95,44 +105,6 @@ void exec_TRAP( uint8_t instr)
 	pc_high = addr_high;
 }
 
-void act_pseudo( uint8_t dest, uint8_t source)
-{
-	switch (dest & 15) {
-	case 0: break; // SIG This case handled by caller
-	case 1: rreg = source; break; // R
-	case 2: memory[effective()] = source; break; // M
-	case 3: pc_low_copy = source; break; // X
-	case 4: pc_high_copy = source; break; // Y
-	case 5: serial_out_byte = source; break; // S
-	case 6: par_out( source); break; // P
-	case 7: alu_op=source; alu_lock=0; break; // F
-	case 8: dreg = source; break; // D
-	case 9: greg = source; break; // G
-	case 10: pc_high = source; pc_low = 0; break; // J
-	case 11: alu_result(); if (!zflag) pc_high = source; pc_low = 0; break; // T
-	case 12: alu_result(); if (zflag) pc_high = source; pc_low = 0; break; // E
-	case 13: exec_TRAP( source); break; // C
-	case 14: aacc = source; wptr = &aacc; alu_lock=1; break; // A
-	case 15: bacc = source; wptr = &bacc; alu_lock=1; break; // B
-	}
-}
-
-
-
-uint8_t get_pseudo( uint8_t source)
-{
-	switch (source) {
-	case 0: return fetch(); // L
-	case 1: return rreg; // R
-	case 2: return memory[effective()]; // M
-	case 3: return pc_low_copy; // X
-	case 4: return pc_high_copy; // Y
-	case 5: return serial_in_byte; // S
-	case 6: return par_in(); // P
-	default: return alu_result(); // F
-	}
-}
-
 void shift_in()
 {
 	uint8_t bit = 1; // Dummy of a physical bit stream clocked by sclock
@@ -151,76 +123,118 @@ void shift_out() {
 }
 
 
-void exec_SIGNAL( uint8_t instr)
-{
-	uint8_t dest = instr & 15;
-	uint8_t source = (instr >> 4) & 7; /* High order 3 bits */
-	if (dest) { // Transfer
-		if ((source == 0) && (dest == 2)) { // Scrounge RET
-			pc_low = pc_low_copy;
-			pc_high = pc_high_copy;
-		}
-		else if ((source == 2) && (dest == 2)) {pc_high++; pc_low=0;} // Scrounge LID
-		else act_pseudo( dest, get_pseudo( source));
-	}
-	else {
-		switch (source) {
-		case 0: break; /* NOP */
-		case 1: shift_in(); break; /* SCI */
-		case 2: shift_out(); break; /* SCO */
-		case 3: sclock = 0; break; /* SCL */
-		case 4: sclock = 1; break; /* SCH */
-		case 5: tristate = 1; break; /* OFF */
-		case 6: sptr++; break; /* LEAVE */
-		case 7: sptr--; break; /* ENTER */
-		}
-	}
-}
+// Threaded dispatch: each opcode jumps straight to its handler.
+// Transfers jump to their source label, which jumps to the
+// destination label. One instruction per machine cycle.
+// The scrounge R->R (HALT) stops the run, returns cycles spent.
+
+#define HALT 0x11
+
+int halted;
 
-void exec_GETPUT( uint8_t instr)
+long run( long budget)
 {
-	uint8_t offs = instr & 7;
-	if (instr & 32) { /* B register */
-		if (instr & 16) { /* Local */
-			if (instr & 8) memory[sptr*256 + 128 + 64 + offs] = bacc;
-			else bacc = memory[sptr*256 + 128 + 64 + offs];
-		}
-		else { /* Global */
-			if (instr & 8) memory[greg*256 + 128 + offs] = bacc;
-			else bacc = memory[greg*256 + 128 + offs];
-		}
-	}
-	else { /* A register */
-		if (instr & 16) { /* Local */
-			if (instr & 8) memory[sptr*256 + 128 + 64 + offs] = aacc;
-			else aacc = memory[sptr*256 + 128 + 64 + offs];
-		}
-		else { /* Global */
-			if (instr & 8) memory[greg*256 + 128 + offs] = aacc;
-			else aacc = memory[greg*256 + 128 + offs];
-		}
+	static void *dst[16] = {
+		&&next, &&put_R, &&put_M, &&put_X, &&put_Y, &&put_S, &&put_P, &&put_F,
+		&&put_D, &&put_G, &&put_J, &&put_T, &&put_E, &&put_C, &&put_A, &&put_B
+	};
+	static void *src[8] = {
+		&&get_L, &&get_R, &&get_M, &&get_X, &&get_Y, &&get_S, &&get_P, &&get_F
+	};
+	static void *sig[8] = {
+		&&next, &&sci, &&sco, &&scl, &&sch, &&off, &&leave, &&enter
+	};
+	static void *op[256];
+	uint8_t instr, v = 0, *acc;
+	uint16_t addr;
+	long n = 0;
+
+	if (!op[0]) {
+		for (int i=0; i<128; i++) op[i] = i & 15 ? src[i >> 4] : sig[i >> 4];
+		for (int i=128; i<192; i++) op[i] = &&trap;
+		for (int i=192; i<256; i++) op[i] = &&getput;
+		op[0x02] = &&ret; // Scrounge RET (L->M)
+		op[0x22] = &&lid; // Scrounge LID (M->M)
+		op[HALT] = &&halt;
 	}
+	halted = 0;
+
+#define NEXT if (n == budget) return n; n++; instr = fetch(); goto *op[instr]
+next:	NEXT;
+
+get_L:	v = fetch(); goto *dst[instr & 15];
+get_R:	v = rreg; goto *dst[instr & 15];
+get_M:	v = memory[effective()]; goto *dst[instr & 15];
+get_X:	v = pc_low_copy; goto *dst[instr & 15];
+get_Y:	v = pc_high_copy; goto *dst[instr & 15];
+get_S:	v = serial_in_byte; goto *dst[instr & 15];
+get_P:	v = par_in(); goto *dst[instr & 15];
+get_F:	v = alu_result(); goto *dst[instr & 15];
+
+put_R:	rreg = v; NEXT;
+put_M:	memory[effective()] = v; NEXT;
+put_X:	pc_low_copy = v; NEXT;
+put_Y:	pc_high_copy = v; NEXT;
+put_S:	serial_out_byte = v; NEXT;
+put_P:	par_out( v); NEXT;
+put_F:	alu_op = v; alu_lock = 0; NEXT;
+put_D:	dreg = v; NEXT;
+put_G:	greg = v; NEXT;
+put_J:	pc_high = v; pc_low = 0; NEXT;
+put_T:	alu_result(); if (!zflag) pc_high = v; pc_low = 0; NEXT;
+put_E:	alu_result(); if (zflag) pc_high = v; pc_low = 0; NEXT;
+put_C:	exec_TRAP( v); NEXT;
+put_A:	aacc = v; wptr = &aacc; alu_lock = 1; NEXT;
+put_B:	bacc = v; wptr = &bacc; alu_lock = 1; NEXT;
+
+sci:	shift_in(); NEXT;
+sco:	shift_out(); NEXT;
+scl:	sclock = 0; NEXT;
+sch:	sclock = 1; NEXT;
+off:	tristate = 1; NEXT;
+leave:	sptr++; NEXT;
+enter:	sptr--; NEXT;
+
+ret:	pc_low = pc_low_copy; pc_high = pc_high_copy; NEXT;
+lid:	pc_high++; pc_low = 0; NEXT;
+halt:	halted = 1; return n;
+
+trap:	exec_TRAP( instr & 63); NEXT;
+
+getput:	acc = instr & 32 ? &bacc : &aacc; /* B or A register */
+	addr = instr & 16 ? sptr*256 + 128 + 64 : greg*256 + 128; /* Local or global */
+	addr += instr & 7;
+	if (instr & 8) memory[addr] = *acc;
+	else *acc = memory[addr];
+	NEXT;
+#undef NEXT
 }
 
 
 
-void decode()
+uint8_t *map_blur( char *fname)
 {
-	uint8_t instr = fetch();
-	if ((instr & 128) == 0) exec_SIGNAL( instr); /* Strip off b7 */
-	else if (instr & 64) exec_GETPUT( instr & 63); /* Strip off b7 and b6 */
-	else exec_TRAP( instr & 63); /* Strip off b7 and b6 */
+	struct stat st;
+	void *p;
+	int fd = open(fname, O_RDONLY);
+	if (fd == -1) return NULL;
+	if (fstat(fd, &st) || st.st_size < BLUR_SIZE) {
+		close(fd);
+		return NULL;
+	}
+	p = mmap(NULL, BLUR_SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	return p == MAP_FAILED ? NULL : p;
 }
 
 
-
 int
 rdimg()
 {
 	FILE *f;
 	f = fopen("daffodil", "r");
 	if (f == NULL) return -1;
-	fread(memory,1,65535,f);
+	fread(memory,1,sizeof memory,f);
 	fclose(f);
 	return 0;
 }
@@ -231,28 +245,40 @@ wrimg()
 {
 	FILE *f;
 	f = fopen("daffodil", "rb+");
-	fwrite(memory, 1, 65535, f);
+	if (f == NULL) return -1;
+	fwrite(memory, 1, sizeof memory, f);
 	fclose(f);
 	return 0;
 }
 
 
-int main() {
+int main( int argc, char *argv[]) {
+	long budget = 65535, n; // Cycles, 0 runs until HALT
+
 	reset_cpu();
 
+	for (int i=1; i+1<argc; i+=2) {
+		if (!strcmp(argv[i], "-b")) { // ALU from ROM image, e.g. blur3.obj
+			blur = map_blur(argv[i+1]);
+			if (blur == NULL) {
+				printf("Cannot map ALU ROM %s\n", argv[i+1]);
+				exit(0);
+			}
+		}
+		else if (!strcmp(argv[i], "-n")) budget = atol(argv[i+1]);
+		else {
+			printf("Usage: sonne_run [-b rom] [-n cycles]\n");
+			exit(0);
+		}
+	}
+
 	if (rdimg()) {
 	 printf("Missing Daffofil\n");
 	exit(0);	
 	}
 
-	for (int i=0; i<65535; i++) decode();
+	n = run( budget ? budget : -1);
+	printf("%s after %ld cycles\n", halted ? "Halted" : "Stopped", n);
 
 	wrimg();
 }
-
-
-
-
-
-
-
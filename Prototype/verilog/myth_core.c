@@ -0,0 +1,520 @@
+/* Sonne Microcontroller rev. Myth
+   Clock level model of myth_DE1_core.v
+
+   Models the core the way Quartus synthesises it: every
+   register is a flip-flop updated on the rising clock edge,
+   cpu_phase as seen by the main always block is the value
+   before the edge. The block RAM of myth_DE1_top.v is clocked
+   on the falling edge, it latches maddr, mdata_put and mwren
+   and drives mdata_get with the (new) byte at maddr.
+   maddr goes through the 15 bit port of the top level, so
+   {page, 8'h7C} in the GET-PUT cases loses the page MSB.
+
+   Each instruction takes three clocks:
+   phase 0 fetch, phase 1 read (decode, set maddr for the
+   operand), phase 2 write (take mdata_get, GET-PUT stores).
+
+   Runs an image in lockstep with mythlib.c (included below)
+   and stops at the first instruction after which the
+   registers, or the memory bytes the core wrote, differ.
+
+   Known differences of the RTL from mythlib.c, which show
+   up as divergence when a program uses them:
+   fetch and GET-PUT use page 255 instead of G,
+   GET-PUT addresses as above, GET-PUT I moves O,
+   RR traps to page 4, RS OS IS load SIR instead of SOR,
+   IX jumps to the decremented I,
+   SG PG load I, MM (CLR) sets L to 0 instead of 255,
+   DC reads a register that is never written (0),
+   N/M P do not change par_rdy, jumps don't save BIO.
+
+   Build using:
+   cc -O2 -o myth_core myth_core.c
+
+   Run:
+   ./myth_core [-n instructions] [-r] [-s] image
+   -r compares registers only, -s runs the core alone
+   to measure its speed.
+*/
+
+#define MYTH_NOMAIN
+#include "mythlib.c"
+#include <time.h>
+
+#define CORE_GLOBAL_PAGE 255
+#define CORE_ADDRMASK 0x7FFF /* wire[14:0] maddr in myth_DE1_top.v */
+#define CORE_NWR 16 /* Writes tracked between compares */
+
+
+struct myth_core {
+
+    /* CPU registers */
+
+    uint8_t pc;
+    uint8_t reg_C;
+    uint8_t reg_I;
+    uint8_t reg_R;
+    uint8_t reg_D;
+    uint8_t reg_L;
+    uint8_t reg_G;
+    uint8_t reg_E;
+    uint8_t par_ir;
+    uint8_t par_or;
+    uint8_t ser_ir;
+    uint8_t ser_or;
+    uint8_t par_rdy;
+    uint8_t reg_A;
+    uint8_t reg_B;
+    uint8_t reg_O;
+
+    /* MISC */
+
+    uint8_t opcode;
+    uint8_t cpu_phase;
+    uint8_t ljo;
+    uint8_t xMx;
+
+    /* Ports */
+
+    uint32_t maddr;
+    uint8_t mdata_put;
+    uint8_t mwren;
+    uint8_t mdata_get;
+
+    uint8_t sd_clk;
+    uint8_t sd_mosi;
+    uint8_t sd_cs;
+    uint8_t sd_miso;
+
+    uint8_t seg7[3]; // Bytes shown on HEX1:0, HEX3:2, HEX5:4
+
+    /* memory_inst */
+
+    uint8_t ram[0x8000];
+    uint32_t wraddr[CORE_NWR]; // Bytes written since the last compare
+    uint8_t nwr;
+
+    unsigned long clocks;
+};
+
+
+void
+core_call( struct myth_core *c, uint8_t src)
+{
+    c->reg_D = c->reg_C;
+    c->reg_C = src;
+    c->reg_O = c->pc;
+    c->pc = 0;
+}
+
+uint32_t
+core_fetchaddr( struct myth_core *c)
+{
+    return (c->pc & 128 ? CORE_GLOBAL_PAGE : c->reg_C) << 7 | (c->pc & 127);
+}
+
+uint32_t
+core_dataaddr( struct myth_core *c)
+{
+    return (c->xMx & 128 ? c->reg_L : c->reg_D) << 7 | (c->xMx & 127);
+}
+
+void
+core_store( struct myth_core *c, uint8_t val)
+{
+    c->maddr = core_dataaddr(c);
+    c->mdata_put = val;
+    c->mwren = 1;
+}
+
+/* Source of the R O D I S P pair rows
+*/
+uint8_t
+core_source( struct myth_core *c, uint8_t src)
+{
+    switch (src)
+    {
+        case LHS_D: return c->reg_D;
+        case LHS_O: return c->reg_O;
+        case LHS_R: return c->reg_R;
+        case LHS_I: return c->reg_I;
+        case LHS_S: return c->ser_ir;
+        default: return c->par_ir;
+    }
+}
+
+/* Phase 1 of opcodes 80h-FFh
+*/
+void
+core_read_pair( struct myth_core *c, uint8_t src, uint8_t dst)
+{
+    uint8_t val;
+
+    if (src == LHS_N) {
+        if (dst == RHS_M) { // RET
+            c->pc = c->reg_O;
+            c->reg_C = c->reg_D;
+            return;
+        }
+        c->maddr = core_fetchaddr(c);
+        c->pc++;
+        return;
+    }
+    if (src == LHS_M) {
+        if (dst == RHS_M) c->reg_L = 0; // CLR
+        else c->maddr = core_dataaddr(c);
+        return;
+    }
+
+    val = core_source(c, src);
+    switch (dst)
+    {
+        case RHS_G:
+            if (src >= LHS_S) c->reg_I = val; // SG PG
+            else c->reg_G = val;
+            break;
+        case RHS_M: core_store(c, val); break;
+        case RHS_D: c->reg_D = val; break;
+        case RHS_O: c->reg_O = val; break;
+        case RHS_R:
+            if (src == LHS_R) core_call(c, 0xC4 & 31); // RR not decoded, traps
+            else c->reg_R = val;
+            break;
+        case RHS_I: c->reg_I = val; break;
+        case RHS_S:
+            if (src == LHS_D || src == LHS_P) c->ser_or = val;
+            else c->ser_ir = val;
+            break;
+        case RHS_P:
+            if (src == LHS_P) break; // PP
+            c->par_or = val;
+            c->par_rdy = 0;
+            break;
+        case RHS_E: c->reg_E = val; break;
+        case RHS_X:
+            c->reg_I--;
+            if (c->reg_I) c->pc = src == LHS_I ? c->reg_I : val;
+            break;
+        case RHS_J: c->pc = val; break;
+        case RHS_T: if (c->reg_R) c->pc = val; break;
+        case RHS_F: if (!c->reg_R) c->pc = val; break;
+        case RHS_C:
+            if (src == LHS_O) c->reg_R = c->reg_C; // CPI
+            else if (src == LHS_D) c->reg_R = c->ljo; // LJO
+            else core_call(c, val);
+            break;
+        case RHS_A: c->reg_A = val; c->xMx = c->reg_A; break;
+        case RHS_B: c->reg_B = val; c->xMx = c->reg_B; break;
+    }
+}
+
+/* Phase 2 of the N and M rows
+*/
+void
+core_write_pair( struct myth_core *c, uint8_t dst)
+{
+    uint8_t val = c->mdata_get;
+
+    switch (dst)
+    {
+        case RHS_G: c->reg_G = val; break;
+        case RHS_M: break; // RET, CLR
+        case RHS_D: c->reg_D = val; break;
+        case RHS_O: c->reg_O = val; break;
+        case RHS_R: c->reg_R = val; break;
+        case RHS_I: c->reg_I = val; break;
+        case RHS_S: c->ser_or = val; break;
+        case RHS_P: c->par_or = val; break;
+        case RHS_E: c->reg_E = val; break;
+        case RHS_X:
+            c->reg_I--;
+            if (c->reg_I) c->pc = val;
+            break;
+        case RHS_J: c->pc = val; c->seg7[0] = val; break;
+        case RHS_T: if (c->reg_R) c->pc = val; break;
+        case RHS_F: if (!c->reg_R) c->pc = val; break;
+        case RHS_C: core_call(c, val); break;
+        case RHS_A: c->reg_A = val; c->xMx = c->reg_A; break;
+        case RHS_B: c->reg_B = val; c->xMx = c->reg_B; break;
+    }
+}
+
+uint32_t
+core_gpaddr( struct myth_core *c, uint8_t op)
+{
+    uint8_t page = op & 4 ? c->reg_L : CORE_GLOBAL_PAGE;
+    return (page << 8 | (0x7C + (op >> 4 & 3))) & CORE_ADDRMASK;
+}
+
+/* Phase 1 of opcodes 00h-7Fh
+*/
+void
+core_read_other( struct myth_core *c, uint8_t op)
+{
+    if (op & 64) { c->maddr = core_gpaddr(c, op); return; }
+    if (op & 32) { core_call(c, op & 31); return; }
+    if (op & 16) {
+        switch (op & 15)
+        {
+            case ALU_IDA: c->reg_R = c->reg_A; break;
+            case ALU_IDB: c->reg_R = c->reg_B; break;
+            case ALU_OCA: c->reg_R = ~c->reg_A; break;
+            case ALU_OCB: c->reg_R = ~c->reg_B; break;
+            case ALU_SLA: c->reg_R = c->reg_A << 1; break;
+            case ALU_SLB: c->reg_R = c->reg_B << 1; break;
+            case ALU_SRA: c->reg_R = c->reg_A >> 1; break;
+            case ALU_SRB: c->reg_R = c->reg_B >> 1; break;
+            case ALU_AND: c->reg_R = c->reg_A & c->reg_B; break;
+            case ALU_IOR: c->reg_R = c->reg_A | c->reg_B; break;
+            case ALU_EOR: c->reg_R = c->reg_A ^ c->reg_B; break;
+            case ALU_ADD: c->reg_R = c->reg_A + c->reg_B; break;
+            case ALU_CAR: c->reg_R = (c->reg_A + c->reg_B) >> 8; break;
+            case ALU_ALB: c->reg_R = c->reg_A < c->reg_B ? 255 : 0; break;
+            case ALU_AEB: c->reg_R = c->reg_A == c->reg_B ? 255 : 0; break;
+            case ALU_AGB: c->reg_R = c->reg_A > c->reg_B ? 255 : 0; break;
+        }
+        return;
+    }
+    if (op & 8) {
+        static const uint8_t addend[8] = {4, 1, 2, 3, 0xFC, 0xFD, 0xFE, 0xFF};
+        c->reg_R += addend[op & 7];
+        return;
+    }
+    switch (op & 7)
+    {
+        case SYS_NOP: break;
+        case SYS_SSI: c->ser_ir = c->ser_ir << 1 | c->sd_miso; break;
+        case SYS_SSO: c->sd_mosi = c->ser_or >> 7; c->ser_or <<= 1; break;
+        case SYS_SCL: c->sd_clk = 0; break;
+        case SYS_SCH: c->sd_clk = 1; break;
+        case SYS_RDY:
+            c->par_rdy = 1;
+            c->seg7[1] = c->reg_A;
+            c->seg7[2] = c->reg_B;
+            break;
+        case SYS_NEW: c->reg_L--; break;
+        case SYS_OLD: c->reg_L++; break;
+    }
+}
+
+/* Phase 2 of GET-PUT
+*/
+void
+core_write_getput( struct myth_core *c, uint8_t op)
+{
+    uint8_t *reg[4] = {&c->reg_A, &c->reg_B, &c->reg_R, &c->reg_O};
+    uint8_t guide = op & 3;
+
+    if (op & 8) {
+        c->mdata_put = *reg[guide];
+        c->mwren = 1;
+        return;
+    }
+    *reg[guide] = c->mdata_get;
+    if (guide < 2) c->xMx = *reg[guide];
+}
+
+void
+core_posedge( struct myth_core *c)
+{
+    uint8_t phase = c->cpu_phase;
+
+    c->cpu_phase = phase == 2 ? 0 : phase + 1;
+    c->sd_cs = (c->reg_E & 15) != 1; // io_devsel_AL, E before the edge
+
+    switch (phase)
+    {
+        case 0:
+            c->mwren = 0;
+            c->maddr = core_fetchaddr(c);
+            c->pc++;
+            break;
+
+        case 1:
+            c->opcode = c->mdata_get;
+            if (c->opcode & 128)
+                core_read_pair(c, c->opcode >> 4 & 7, c->opcode & 15);
+            else core_read_other(c, c->opcode);
+            break;
+
+        case 2:
+            if (c->opcode & 128) {
+                if ((c->opcode >> 4 & 7) <= LHS_M)
+                    core_write_pair(c, c->opcode & 15);
+            }
+            else if (c->opcode & 64) core_write_getput(c, c->opcode);
+            break;
+    }
+}
+
+void
+core_negedge( struct myth_core *c)
+{
+    uint32_t a = c->maddr & CORE_ADDRMASK;
+
+    if (c->mwren) {
+        c->ram[a] = c->mdata_put;
+        if (c->nwr < CORE_NWR) c->wraddr[c->nwr++] = a;
+    }
+    c->mdata_get = c->ram[a];
+}
+
+/* Three clocks, from the fetch edge to the one before the next
+*/
+void
+core_instr( struct myth_core *c)
+{
+    c->nwr = 0;
+    for (int i=0; i<3; i++) {
+        core_posedge(c);
+        core_negedge(c);
+    }
+    c->clocks += 3;
+}
+
+/* Power up with the state mythlib.c starts from
+*/
+void
+core_load( struct myth_core *c, Myth_vm *vm)
+{
+    memset(c, 0, sizeof *c);
+    memcpy(c->ram, vm->ram, sizeof c->ram);
+    c->pc = vm->reg_PC;
+    c->reg_C = vm->reg_C;
+    c->reg_I = vm->reg_I;
+    c->reg_R = vm->reg_R;
+    c->reg_D = vm->reg_D;
+    c->reg_L = vm->reg_L;
+    c->reg_G = vm->reg_G;
+    c->reg_E = vm->reg_E;
+    c->par_ir = vm->reg_PIR;
+    c->par_or = vm->reg_POR;
+    c->ser_ir = vm->reg_SIR;
+    c->ser_or = vm->reg_SOR;
+    c->par_rdy = vm->par_ready;
+    c->reg_A = vm->reg_A;
+    c->reg_B = vm->reg_B;
+    c->reg_O = vm->reg_O;
+    c->xMx = vm->reg_xMx;
+    c->sd_clk = vm->ser_clock;
+    c->sd_miso = 1; // As shift_in()
+}
+
+
+/* Registers compared after each instruction, mythlib.c : core
+*/
+#define CORE_REGS(X) \
+    X("PC", reg_PC, pc) X("C", reg_C, reg_C) X("G", reg_G, reg_G) \
+    X("D", reg_D, reg_D) X("L", reg_L, reg_L) X("O", reg_O, reg_O) \
+    X("R", reg_R, reg_R) X("I", reg_I, reg_I) X("A", reg_A, reg_A) \
+    X("B", reg_B, reg_B) X("E", reg_E, reg_E) X("xMx", reg_xMx, xMx) \
+    X("SIR", reg_SIR, ser_ir) X("SOR", reg_SOR, ser_or) \
+    X("PIR", reg_PIR, par_ir) X("POR", reg_POR, par_or) \
+    X("SCLK", ser_clock, sd_clk)
+
+#define CORE_DIFF(name, v, k) \
+    if (vm->v != c->k) { printf("  %-4s mythlib %02X core %02X\n", name, vm->v, c->k); n++; }
+
+int
+core_compare( struct myth_core *c, Myth_vm *vm, int regsonly)
+{
+    int n = 0;
+    uint32_t a;
+
+    CORE_REGS(CORE_DIFF)
+    if (regsonly) return n;
+    for (int i=0; i<c->nwr; i++) {
+        a = c->wraddr[i];
+        if (vm->ram[a] != c->ram[a]) {
+            printf("  %02X.%02X mythlib %02X core %02X\n", a >> 7, a & 127, vm->ram[a], c->ram[a]);
+            n++;
+        }
+    }
+    return n;
+}
+
+/* First memory byte that differs, -1 if none
+*/
+long
+core_memdiff( struct myth_core *c, Myth_vm *vm)
+{
+    for (long a=0; a<sizeof c->ram; a++)
+        if (vm->ram[a] != c->ram[a]) return a;
+    return -1;
+}
+
+
+/* myth_tb.cpp (Verilator) defines CORE_NOMAIN to reuse the above
+*/
+#ifndef CORE_NOMAIN
+
+void
+usage( void)
+{
+    printf("Usage: myth_core [-n instructions] [-r] [-s] image\n");
+    exit(-1);
+}
+
+int
+main( int argc, char **argv)
+{
+    static struct myth_vm vm;
+    static struct myth_core core;
+    unsigned long i, n = MAX_CYCLES;
+    int regsonly = 0, solo = 0, diverged = 0;
+    uint8_t c, pc, op;
+    long a;
+    double secs;
+    clock_t t0;
+
+    for (argc--, argv++; argc > 1 && argv[0][0] == '-'; argc--, argv++) {
+        if (!strcmp(argv[0], "-r")) regsonly = 1;
+        else if (!strcmp(argv[0], "-s")) solo = 1;
+        else if (!strcmp(argv[0], "-n") && argc > 2) {
+            n = strtoul(argv[1], NULL, 0);
+            argc--, argv++;
+        }
+        else usage();
+    }
+    if (argc != 1) usage();
+
+    if (myth_rdimg(&vm, argv[0])) {
+        printf("File '%s' input error\n", argv[0]);
+        exit(-1);
+    }
+    myth_reset_cold(&vm);
+    core_load(&core, &vm);
+
+    t0 = clock();
+    if (solo)
+        for (i=0; i<n; i++) core_instr(&core);
+    else
+        for (i=0; i<n && !quitf; i++) {
+            c = vm.reg_C;
+            pc = vm.reg_PC;
+            op = myth_step(&vm, 1);
+            core_instr(&core);
+            if (core_compare(&core, &vm, regsonly)) {
+                printf("Diverged at instruction %lu, %02X.%02X %02X %s\n",
+                    i, c, pc, op, myth_mnemonics[op]);
+                diverged = 1;
+                i++;
+                break;
+            }
+        }
+    secs = (double) (clock() - t0) / CLOCKS_PER_SEC;
+
+    if (!solo && !diverged && !regsonly && (a = core_memdiff(&core, &vm)) != -1) {
+        printf("Memory differs at %02lX.%02lX, mythlib %02X core %02X\n",
+            a >> 7, a & 127, vm.ram[a], core.ram[a]);
+        diverged = 1;
+    }
+    printf("HEX5-0: %02X %02X %02X\n", core.seg7[2], core.seg7[1], core.seg7[0]);
+    printf("%s after %lu instructions, %lu clocks",
+        solo ? "Ran" : diverged ? "Diverged" : "Agreed", i, core.clocks);
+    if (secs > 0) printf(", %.2f MHz", core.clocks / secs / 1e6);
+    printf("\n");
+    return diverged;
+}
+
+#endif
@@ -0,0 +1,270 @@
+/* Sonne Microcontroller rev. Myth
+   Verilator testbench for myth_DE1_core.v
+
+   Loads an image with myth_rdimg() as mythlib.c does, copies
+   memory and registers into the RTL and runs both side by side,
+   comparing the registers (and the memory bytes the RTL wrote)
+   at every instruction boundary, i.e. whenever cpu_phase is
+   back to 0. Stops at the first divergence and reports the
+   simulation speed.
+
+   The bench stands in for memory_inst of myth_DE1_top.v (a
+   Quartus megafunction): a RAM clocked on the falling edge,
+   behind the 15 bit maddr wire of the top level. This is the
+   memory of myth_core.c, see there for the RTL's known
+   departures from mythlib.c.
+
+   -b compares at block boundaries only (after jumps, calls,
+      returns and traps), mythlib.c still steps every instruction
+   -c compares against the clock model myth_core.c instead,
+      maddr, mwren and mdata_put at every clock, all registers
+      at every instruction, RTL quirks included
+   -r compares registers only
+
+   cpu_phase is set with a blocking assignment in its own always
+   block, so whether the main block sees it before or after the
+   edge is up to the simulator. Quartus builds a flip-flop
+   (before), as myth_core.c does; -c shows at once if Verilator
+   ordered it the other way.
+
+   Build using:
+   verilator --cc --exe --build -O3 --public-flat-rw -Wno-fatal \
+     --top-module myth_core myth_DE1_core.v myth_tb.cpp -o myth_tb
+
+   Run:
+   ./obj_dir/myth_tb [-n instructions] [-b] [-c] [-r] image
+*/
+
+#include <verilated.h>
+#include "Vmyth_core.h"
+#include "Vmyth_core___024root.h"
+
+#define CORE_NOMAIN
+#include "myth_core.c"
+
+#define RTL(sig) (top->rootp->myth_core__DOT__##sig)
+
+/* Registers shared by myth_DE1_core.v and struct myth_core
+*/
+#define RTL_REGS(X) \
+    X(pc) X(reg_C) X(reg_I) X(reg_R) X(reg_D) X(reg_L) X(reg_G) \
+    X(reg_E) X(par_ir) X(par_or) X(ser_ir) X(ser_or) X(par_rdy) \
+    X(reg_A) X(reg_B) X(reg_O) X(opcode) X(cpu_phase) X(ljo) X(xMx)
+
+#define RTL_GET(r) c->r = RTL(r);
+#define RTL_SET(r) RTL(r) = c->r;
+#define RTL_DIFF(r) \
+    if (a->r != b->r) { printf("  %-9s rtl %02X model %02X\n", #r, a->r, b->r); n++; }
+
+
+void
+rtl_load( Vmyth_core *top, struct myth_core *c)
+{
+    RTL_REGS(RTL_SET)
+    top->sd_clk = c->sd_clk;
+    top->sd_miso = c->sd_miso;
+    top->clk = 0;
+    top->eval();
+}
+
+void
+rtl_snap( Vmyth_core *top, struct myth_core *c)
+{
+    RTL_REGS(RTL_GET)
+    c->sd_clk = top->sd_clk;
+    c->sd_mosi = top->sd_mosi;
+}
+
+/* One clock: rising edge into the core, falling edge into
+   the RAM in c
+*/
+void
+rtl_clock( Vmyth_core *top, struct myth_core *c)
+{
+    top->clk = 1;
+    top->eval();
+    c->maddr = top->maddr;
+    c->mdata_put = top->mdata_put;
+    c->mwren = top->mwren;
+    core_negedge(c);
+    top->mdata_get = c->mdata_get;
+    top->clk = 0;
+    top->eval();
+    c->clocks++;
+}
+
+/* Clock up to the next fetch
+*/
+void
+rtl_instr( Vmyth_core *top, struct myth_core *c)
+{
+    for (int i=0; i<3; i++) {
+        rtl_clock(top, c);
+        if (RTL(cpu_phase) == 0) break;
+    }
+}
+
+int
+rtl_same( struct myth_core *a, struct myth_core *b)
+{
+    int n = 0;
+
+    RTL_REGS(RTL_DIFF)
+    RTL_DIFF(sd_clk)
+    RTL_DIFF(sd_mosi)
+    return n;
+}
+
+/* Instruction op at c.pc ended a block, execution went on at
+   newc.newpc
+*/
+int
+branched( uint8_t c, uint8_t pc, uint8_t op, uint8_t newc, uint8_t newpc)
+{
+    uint8_t len = (op & 0xF0) == 0x80 && op != 0x81 ? 2 : 1;
+    return newc != c || newpc != (uint8_t) (pc + len);
+}
+
+
+/* Against mythlib.c, returns nonzero on divergence
+*/
+int
+run_myth( Vmyth_core *top, Myth_vm *vm, struct myth_core *rtl,
+          unsigned long n, unsigned long *done, int block, int regsonly)
+{
+    unsigned long i;
+    uint8_t c, pc, op;
+    long a;
+
+    for (i=0; i<n && !quitf; i++) {
+        c = vm->reg_C;
+        pc = vm->reg_PC;
+        op = myth_step(vm, 1);
+        rtl_instr(top, rtl);
+        if (block && !branched(c, pc, op, vm->reg_C, vm->reg_PC)) continue;
+
+        rtl_snap(top, rtl);
+        a = -1;
+        if (!regsonly && rtl->nwr == CORE_NWR) a = core_memdiff(rtl, vm); // Lost track
+        if (core_compare(rtl, vm, regsonly) || a != -1) {
+            if (a != -1)
+                printf("  %02lX.%02lX mythlib %02X core %02X\n", a >> 7, a & 127, vm->ram[a], rtl->ram[a]);
+            printf("Diverged at instruction %lu, %02X.%02X %02X %s\n",
+                i, c, pc, op, myth_mnemonics[op]);
+            *done = i + 1;
+            return 1;
+        }
+        rtl->nwr = 0;
+    }
+    *done = i;
+    if (!regsonly && (a = core_memdiff(rtl, vm)) != -1) {
+        printf("Memory differs at %02lX.%02lX, mythlib %02X core %02X\n",
+            a >> 7, a & 127, vm->ram[a], rtl->ram[a]);
+        return 1;
+    }
+    return 0;
+}
+
+/* Against myth_core.c, clock by clock
+*/
+int
+run_model( Vmyth_core *top, struct myth_core *model, struct myth_core *rtl,
+           unsigned long n, unsigned long *done, int block)
+{
+    unsigned long i;
+    uint8_t c, pc;
+    int k;
+
+    for (i=0; i<n; i++) {
+        c = model->reg_C;
+        pc = model->pc;
+        for (k=0; k<3; k++) {
+            core_posedge(model);
+            core_negedge(model);
+            rtl_clock(top, rtl);
+            if ((rtl->maddr & CORE_ADDRMASK) != (model->maddr & CORE_ADDRMASK)
+                || rtl->mwren != model->mwren
+                || (rtl->mwren && rtl->mdata_put != model->mdata_put)) {
+                printf("  clock %lu: maddr %04X/%04X mwren %d/%d mdata_put %02X/%02X\n",
+                    rtl->clocks, rtl->maddr & CORE_ADDRMASK, model->maddr & CORE_ADDRMASK,
+                    rtl->mwren, model->mwren, rtl->mdata_put, model->mdata_put);
+                break;
+            }
+        }
+        model->clocks += 3;
+        if (k == 3 && block && !branched(c, pc, model->opcode, model->reg_C, model->pc)) continue;
+        rtl_snap(top, rtl);
+        if (k < 3 || rtl_same(rtl, model)) {
+            printf("Diverged at instruction %lu, opcode %02X %s\n",
+                i, model->opcode, myth_mnemonics[model->opcode]);
+            *done = i + 1;
+            return 1;
+        }
+    }
+    *done = i;
+    return 0;
+}
+
+
+void
+usage( void)
+{
+    printf("Usage: myth_tb [-n instructions] [-b] [-c] [-r] image\n");
+    exit(-1);
+}
+
+int
+main( int argc, char **argv)
+{
+    static struct myth_vm vm;
+    static struct myth_core rtl, model;
+    unsigned long n = MAX_CYCLES, done;
+    int block = 0, clockmodel = 0, regsonly = 0, diverged;
+    double secs, hz;
+    clock_t t0;
+
+    VerilatedContext *ctx = new VerilatedContext;
+    ctx->commandArgs(argc, argv);
+    Vmyth_core *top = new Vmyth_core{ctx};
+
+    for (argc--, argv++; argc > 1 && argv[0][0] == '-'; argc--, argv++) {
+        if (!strcmp(argv[0], "-b")) block = 1;
+        else if (!strcmp(argv[0], "-c")) clockmodel = 1;
+        else if (!strcmp(argv[0], "-r")) regsonly = 1;
+        else if (!strcmp(argv[0], "-n") && argc > 2) {
+            n = strtoul(argv[1], NULL, 0);
+            argc--, argv++;
+        }
+        else usage();
+    }
+    if (argc != 1) usage();
+
+    if (myth_rdimg(&vm, argv[0])) {
+        printf("File '%s' input error\n", argv[0]);
+        exit(-1);
+    }
+    myth_reset_cold(&vm);
+    core_load(&rtl, &vm);
+    core_load(&model, &vm);
+    rtl_load(top, &rtl);
+
+    t0 = clock();
+    if (clockmodel) diverged = run_model(top, &model, &rtl, n, &done, block);
+    else diverged = run_myth(top, &vm, &rtl, n, &done, block, regsonly);
+    secs = (double) (clock() - t0) / CLOCKS_PER_SEC;
+
+    printf("%s %s after %lu instructions, %lu clocks",
+        diverged ? "Diverged from" : "Agreed with",
+        clockmodel ? "myth_core.c" : "mythlib.c", done, rtl.clocks);
+    if (secs > 0) {
+        hz = rtl.clocks / secs;
+        if (hz >= 1e6) printf(", %.2f MHz", hz / 1e6);
+        else printf(", %.1f kHz", hz / 1e3);
+    }
+    printf("\n");
+
+    top->final();
+    delete top;
+    delete ctx;
+    return diverged;
+}
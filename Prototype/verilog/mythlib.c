@@ -8,8 +8,11 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 
+#include "../../Dev/src/clox/myst.h"
+
 #define LHS_N     0
 #define LHS_M     1
 #define LHS_D     2
@@ -371,8 +374,17 @@ struct myth_vm {
 
     void (*E_posedge[16])(struct myth_vm*);
     void (*E_negedge[16])(struct myth_vm*);
+    uint16_t E_devs; // Slots with a device attached
+
+    uint8_t *cpage[2]; // Fetch pages C and G, by offset bit 7
+    uint8_t *dpage[2]; // Data pages D and L, by offset bit 7
 } vm;
 
+/* The page pointers follow C, G, D and L wherever these change,
+   code setting them directly calls myth_repage() afterwards
+*/
+#define MYTH_PAGE(vm, p) ((vm)->ram + 128 * (p))
+
 
 typedef struct myth_vm Myth_vm;
 
@@ -459,8 +471,8 @@ myth_SYS( Myth_vm *vm, uint8_t op)
           case SYS_SCL: vm->ser_clock = 0; break;
           case SYS_SCH: vm->ser_clock = 1; break;
           case SYS_RDY: vm->par_ready = 1; break;
-          case SYS_NEW: vm->reg_L -= 1; break;
-          case SYS_OLD: vm->reg_L += 1; break;
+          case SYS_NEW: vm->dpage[1] = MYTH_PAGE(vm, --vm->reg_L); break;
+          case SYS_OLD: vm->dpage[1] = MYTH_PAGE(vm, ++vm->reg_L); break;
       }
 }
 
@@ -471,6 +483,8 @@ myth_TRAP( Myth_vm *vm, uint8_t addr)
     vm->reg_PC = 0;
     vm->reg_D = vm->reg_C;
     vm->reg_C = addr;
+    vm->dpage[0] = vm->cpage[0];
+    vm->cpage[0] = MYTH_PAGE(vm, addr);
 }
 
 void
@@ -485,12 +499,8 @@ myth_parallel_out( Myth_vm *vm, uint8_t val)
 uint8_t
 myth_fetch( Myth_vm *vm)
 {
-    uint16_t caddr;
-    uint8_t t;
-    t = vm->reg_PC++;
-    caddr = t&128 ? vm->reg_G : vm->reg_C;
-    caddr = 128 * caddr + (t&127);
-    return vm->ram[caddr];
+    uint8_t t = vm->reg_PC++;
+    return vm->cpage[t>>7][t&127];
 }
 
 void
@@ -500,27 +510,32 @@ myth_jump( Myth_vm *vm, uint8_t val)
     vm->reg_PC = val;
 }
 
+void myth_set_E( Myth_vm *vm, uint8_t val);
+
 void
 myth_write_reg( Myth_vm *vm, uint8_t selector, uint8_t val)
 {
-    uint16_t daddr;
     uint8_t t;
     switch (selector & 15)
     {
-        case RHS_G: vm->reg_G = val; break;
+        case RHS_G:
+            vm->reg_G = val;
+            vm->cpage[1] = MYTH_PAGE(vm, val);
+            break;
         case RHS_M:
             t = vm->reg_xMx;
-            daddr = t&128 ? vm->reg_L : vm->reg_D;
-            daddr = 128 * daddr + (t&127);
-            vm->ram[daddr] = val; break;
+            vm->dpage[t>>7][t&127] = val;
+            break;
+        case RHS_D:
+            vm->reg_D = val;
+            vm->dpage[0] = MYTH_PAGE(vm, val);
             break;
-        case RHS_D: vm->reg_D = val; break;
         case RHS_O: vm->reg_O = val; break;
         case RHS_R: vm->reg_R  = val; break;
         case RHS_I: vm->reg_I = val; break;
         case RHS_S: vm->reg_SOR = val; break;
         case RHS_P: myth_parallel_out(vm, val); break;
-        case RHS_E: vm->reg_E = val; break;
+        case RHS_E: myth_set_E(vm, val); break;
         case RHS_X:
             vm->reg_I--;
             if (vm->reg_I) myth_jump(vm, val);
@@ -543,16 +558,13 @@ myth_write_reg( Myth_vm *vm, uint8_t selector, uint8_t val)
 uint8_t
 myth_read_reg( Myth_vm *vm, uint8_t selector)
 {
-    uint16_t daddr;
-    uint8_t t, val;
+    uint8_t t;
     switch (selector & 7)
     {
         case LHS_N: return myth_fetch(vm);
         case LHS_M:
             t = vm->reg_xMx;
-            daddr = t&128 ? vm->reg_L : vm->reg_D;
-            daddr = 128 * daddr + (t&127);
-            return val = vm->ram[daddr];
+            return vm->dpage[t>>7][t&127];
         case LHS_D: return vm->reg_D;
         case LHS_O: return vm->reg_O;
         case LHS_R: return vm->reg_R;
@@ -571,9 +583,10 @@ myth_PAIR( Myth_vm *vm, uint8_t src, uint8_t dst)
     if ((src == LHS_N) && (dst == RHS_M)) { // Scrounge RET
         vm->reg_PC = vm->reg_O;
         vm->reg_C = vm->reg_D;
+        vm->cpage[0] = vm->dpage[0];
     }
     else
-    if ((src==LHS_M) && (dst==RHS_M)) vm->reg_L = 255;
+    if ((src==LHS_M) && (dst==RHS_M)) vm->dpage[1] = MYTH_PAGE(vm, vm->reg_L = 255);
     else if ((src==LHS_O) && (dst==RHS_C)) vm->reg_R = vm->reg_C;
     else if ((src==LHS_D) && (dst==RHS_C)) vm->reg_R = vm->reg_BIO;
     else if (src!=0 && src==dst);
@@ -586,30 +599,30 @@ myth_GETPUT( Myth_vm *vm, uint8_t bits)
 {
     uint8_t guide = bits & 3;
     uint8_t gp_offs = (bits >> 4) & 3;
-    uint16_t addr;
+    uint8_t *loc;
 
     #define PUTBIT bits & 8
     #define LOCALBIT bits & 4
 
     // GETPUT locations located at end of page
-    if (LOCALBIT) addr = 128*(vm->reg_L+1) - 4 + gp_offs; // Local page
-    else addr = 128*(vm->reg_G+1) - 4 + gp_offs; // Global page
+    if (LOCALBIT) loc = vm->dpage[1] + 124 + gp_offs; // Local page
+    else loc = vm->cpage[1] + 124 + gp_offs; // Global page
 
     switch(guide) {
-        case 0: if (PUTBIT) vm->ram[addr] = vm->reg_A;
-                else myth_set_A(vm, vm->ram[addr]);
+        case 0: if (PUTBIT) *loc = vm->reg_A;
+                else myth_set_A(vm, *loc);
                 break;
 
-        case 1: if (PUTBIT) vm->ram[addr] = vm->reg_B;
-                else myth_set_B(vm, vm->ram[addr]);
+        case 1: if (PUTBIT) *loc = vm->reg_B;
+                else myth_set_B(vm, *loc);
                 break;
 
-        case 2: if (PUTBIT) vm->ram[addr] = vm->reg_R;
-                else vm->reg_R = vm->ram[addr];
+        case 2: if (PUTBIT) *loc = vm->reg_R;
+                else vm->reg_R = *loc;
                 break;
 
-        case 3: if (PUTBIT) vm->ram[addr] = vm->reg_I;
-                else vm->reg_I = vm->ram[addr];
+        case 3: if (PUTBIT) *loc = vm->reg_I;
+                else vm->reg_I = *loc;
                 break;
     }
 }
@@ -644,6 +657,15 @@ myth_decode( struct myth_vm* vm,  uint8_t opcode)
     myth_SYS(vm, opcode & 7);
 }
 
+void
+myth_repage( struct myth_vm* vm)
+{
+    vm->cpage[0] = MYTH_PAGE(vm, vm->reg_C);
+    vm->cpage[1] = MYTH_PAGE(vm, vm->reg_G);
+    vm->dpage[0] = MYTH_PAGE(vm, vm->reg_D);
+    vm->dpage[1] = MYTH_PAGE(vm, vm->reg_L);
+}
+
 void
 myth_reset_warm( struct myth_vm* vm)
 {
@@ -653,6 +675,31 @@ myth_reset_warm( struct myth_vm* vm)
     vm->par_ready = 1;
     vm->reg_C = 0;
     vm->reg_PC = 0;
+    myth_repage(vm);
+}
+
+/* Device bus on the E register select lines.
+   Slots 0-15 are shared by the low and high nybble of E, each
+   holds a posedge (selected) and negedge (deselected) handler.
+   Empty slots hold the null device, so edges never need a check,
+   and with no device attached at all E writes skip the edges.
+*/
+
+void
+myth_nodev( struct myth_vm* vm)
+{
+    (void) vm;
+}
+
+void
+myth_attach( struct myth_vm* vm, uint8_t slot,
+             void (*posedge)(struct myth_vm*), void (*negedge)(struct myth_vm*))
+{
+    slot &= 15;
+    vm->E_posedge[slot] = posedge ? posedge : myth_nodev;
+    vm->E_negedge[slot] = negedge ? negedge : myth_nodev;
+    if (posedge || negedge) vm->E_devs |= 1 << slot;
+    else vm->E_devs &= ~(1 << slot);
 }
 
 void
@@ -660,10 +707,7 @@ myth_reset_cold( struct myth_vm* vm)
 {
     myth_reset_warm(vm);
 
-    for (int i=0; i<16; i++) {
-        vm->E_posedge[i] = NULL;
-        vm->E_negedge[i] = NULL;
-    }
+    for (int i=0; i<16; i++) myth_attach(vm, i, NULL, NULL);
 }
 
 void
@@ -675,6 +719,7 @@ myth_set_E( Myth_vm *vm, uint8_t val)
     uint8_t hdevice = (val >> 4);
 
     vm->reg_E = val;
+    if (!vm->E_devs) return; // Null bus
 
     if (ldevice != ldevice_old) {
         vm->E_posedge[ldevice](vm);
@@ -699,17 +744,47 @@ myth_step( struct myth_vm* vm, unsigned n)
 
 
 
+/* Register block order in .myst images
+*/
+#define MYTH_NREGS 19
+#define MYTH_IMGSIZE MYST_MAXSIZE(128, 256, MYTH_NREGS)
+#define MYTH_LEGACYSIZE offsetof(struct myth_vm, E_posedge)
+
+uint8_t *
+myth_regs( Myth_vm *vm, int i)
+{
+    uint8_t *regs[MYTH_NREGS] = {
+        &vm->reg_G, &vm->reg_D, &vm->reg_O, &vm->reg_R, &vm->reg_I,
+        &vm->reg_A, &vm->reg_B, &vm->reg_BIO, &vm->reg_C, &vm->reg_L,
+        &vm->reg_E, &vm->reg_SIR, &vm->reg_SOR, &vm->reg_PIR, &vm->reg_POR,
+        &vm->reg_PC, &vm->reg_xMx, &vm->par_ready, &vm->ser_clock
+    };
+    return regs[i];
+}
+
 int
 myth_rdimg( Myth_vm *vm, char *fname)
 {
     FILE *f;
-    f = fopen(fname, "r");
+    static uint8_t buf[MYTH_IMGSIZE > MYTH_LEGACYSIZE ? MYTH_IMGSIZE : MYTH_LEGACYSIZE];
+    uint8_t regs[MYTH_NREGS];
+    long n;
+    int i;
+
+    f = fopen(fname, "rb");
     if (f == NULL) return -1;
-    fread(vm, 1,
-        sizeof(struct myth_vm)
-         - 2 * sizeof(void (*[16])(void)),
-    f);
+    n = fread(buf, 1, sizeof buf, f);
     fclose(f);
+
+    if (n == MYTH_LEGACYSIZE && !myst_ismagic(buf, n)) { /* Raw sasm dump */
+        memcpy(vm, buf, n);
+        myth_repage(vm);
+        return 0;
+    }
+    if (myst_decode(buf, n, MYST_VERILOG, vm->ram, 128, 256, regs, MYTH_NREGS))
+        return -1;
+    for (i=0; i<MYTH_NREGS; i++) *myth_regs(vm, i) = regs[i];
+    myth_repage(vm);
     return 0;
 }
 
@@ -717,27 +792,28 @@ int
 myth_wrimg( Myth_vm *vm, char *fname)
 {
     FILE *f;
-    f = fopen(fname, "rb+");
-    if (f == NULL) return -1;
+    static uint8_t buf[MYTH_IMGSIZE];
+    uint8_t regs[MYTH_NREGS];
+    long n;
+    int i;
+
+    for (i=0; i<MYTH_NREGS; i++) regs[i] = *myth_regs(vm, i);
+    n = myst_encode(buf, MYST_VERILOG, vm->ram, 128, 256, regs, MYTH_NREGS);
+    f = fopen(fname, "wb");
     if (f == NULL) return -1;
-    fread(vm, 1,
-        sizeof(struct myth_vm)
-         - 2 * sizeof(void (*[16])(void)),
-    f);
+    if (fwrite(buf, 1, n, f) != n) { fclose(f); return -1; }
     fclose(f);
     return 0;
 }
 
 
+#define MAX_CYCLES 1000
 
+/* Programs that link the machine in (myth_core.c) define
+   MYTH_NOMAIN before including this file
+*/
+#ifndef MYTH_NOMAIN
 
-
-
-
-
-
-
-#define MAX_CYCLES 1000
 int
 main( int argc, char **argv)
 {
@@ -765,7 +841,7 @@ main( int argc, char **argv)
     else {
         myth_reset_cold(&vm);
         for (i=0; i<MAX_CYCLES; i++) {
-            myth_decode(&vm, myth_fetch(&vm));
+            myth_step(&vm, 1);
 
          //   printf("A=%02X B=%02X R=%02X C=%02X PC=%02X D=%02X W=%02X L=%02X I=%02X  L0:%02X L1:%02X L2:%02X L3:%02X\n",
          //       vm.reg_A, vm.reg_B, vm.reg_R, vm.reg_C, vm.reg_PC, vm.reg_D,
@@ -783,5 +859,4 @@ main( int argc, char **argv)
     } else printf("Saved after %d cycles\n", i);
 }
 
-
-
+#endif
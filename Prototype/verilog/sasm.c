@@ -6,10 +6,13 @@
  */
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
+#include "../../Dev/src/clox/myst.h"
+
 #define LHS_N     0
 #define LHS_M     1
 #define LHS_D     2
@@ -76,6 +79,8 @@ struct myth_vm {
 
 unsigned pass; /* counts assembly passes */
 
+void mnemo_add( unsigned i);
+
 /* Generate a table of all possible instruction mnemonics */
 /* Array index equates to operation code */
 
@@ -181,6 +186,7 @@ void gen_opcodes()
           }
     }
 
+    for (int i=0; i<256; i++) mnemo_add(i);
 }
 
 
@@ -208,6 +214,65 @@ struct {
 } defmap[8192];
 unsigned defmap_topindex;
 
+/* Labels by name, with the frames defining them.
+   The names themselves stay in frame_mnemo[][].
+*/
+
+struct {
+    char name[SYMSIZE];
+    uint64_t frames[4];
+} labelset[256*16];
+unsigned labelset_topindex;
+
+
+/* Hashed look-up of mnemonics, definitions and labels.
+   Open addressing with linear probing, a slot holds index+1
+   into mnemo_decoder[], defmap[] or labelset[], 0 if empty.
+   A name keeps the first index added, as with the linear
+   scans these replace.
+*/
+
+#define HASHSIZE 16384 /* Power of two, over twice any table */
+
+unsigned mnemo_hash[HASHSIZE];
+unsigned def_hash[HASHSIZE];
+unsigned label_hash[HASHSIZE];
+
+const char *mnemo_key( unsigned i) { return mnemo_decoder[i]; }
+const char *def_key( unsigned i) { return defmap[i].name; }
+const char *label_key( unsigned i) { return labelset[i].name; }
+
+unsigned
+hashname( const char *s)
+{
+    unsigned h = 2166136261u; /* FNV-1a */
+    while (*s) h = (h ^ (uint8_t) *s++) * 16777619u;
+    return h;
+}
+
+int
+hash_find( unsigned *tab, const char *(*key)(unsigned), const char *name)
+{
+    unsigned i = hashname(name) & (HASHSIZE-1);
+
+    for (; tab[i]; i = (i+1) & (HASHSIZE-1))
+        if (!strcmp(key(tab[i]-1), name)) return tab[i]-1;
+    return -1;
+}
+
+void
+hash_add( unsigned *tab, const char *(*key)(unsigned), const char *name, unsigned idx)
+{
+    unsigned i = hashname(name) & (HASHSIZE-1);
+
+    for (; tab[i]; i = (i+1) & (HASHSIZE-1))
+        if (!strcmp(key(tab[i]-1), name)) return;
+    tab[i] = idx+1;
+}
+
+void mnemo_add( unsigned i) { hash_add(mnemo_hash, mnemo_key, mnemo_decoder[i], i); }
+void def_add( unsigned i) { hash_add(def_hash, def_key, defmap[i].name, i); }
+
 #define BYTE_TO_BINARY_PATTERN "%c%c%c%c_%c%c%c%c"
 #define BYTE_TO_BINARY(byte)  \
   (byte & 0x80 ? '1' : '0'), \
@@ -226,57 +291,78 @@ unsigned defmap_topindex;
   (nybble & 0x02 ? '1' : '0'), \
   (nybble & 0x01 ? '1' : '0') \
 
+/* Number literals: decimal 0 to 255 and -1 to -128, hex with
+   one or two upper case digits (Fh, 0Fh), binary with four or
+   eight digits (1111b, 0000_1111b). Returns 0 if buf isn't one.
+*/
+
+    int parse_number( const char* buf, uint8_t* val)
+    {
+        int n = strlen(buf), v = 0, i = 0;
+
+        if (n == 0) return 0;
+        if (buf[n-1] == 'h') {
+            if (n < 2 || n > 3) return 0;
+            for (; i<n-1; i++) {
+                if (isdigit(buf[i])) v = v*16 + buf[i] - '0';
+                else if (buf[i] >= 'A' && buf[i] <= 'F') v = v*16 + buf[i] - 'A' + 10;
+                else return 0;
+            }
+        }
+        else if (buf[n-1] == 'b') {
+            if (n != 5 && n != 10) return 0;
+            for (; i<n-1; i++) {
+                if (n == 10 && i == 4) {
+                    if (buf[i] != '_') return 0;
+                }
+                else if (buf[i] == '0' || buf[i] == '1') v = v*2 + buf[i] - '0';
+                else return 0;
+            }
+        }
+        else {
+            if (buf[0] == '-') i++;
+            if (n-i < 1 || n-i > 3 || (buf[i] == '0' && (i || n > 1))) return 0;
+            for (; i<n; i++) {
+                if (!isdigit(buf[i])) return 0;
+                v = v*10 + buf[i] - '0';
+            }
+            if (buf[0] == '-') v = v > 128 ? -1 : -v & 0xFF;
+            else if (v > 255) v = -1;
+            if (v == -1) return 0;
+        }
+        *val = v;
+        return 1;
+    }
+
+/* The literal spellings in the order of the numbers table
+   written to opcode_matrix.txt, i from 0 to 927
+*/
+
+    uint8_t number_name( int i, char* buf)
+    {
+        if (i < 256) { sprintf(buf, "%d", i); return i; }
+        i -= 256;
+        if (i < 128) { sprintf(buf, "-%d", i+1); return -(i+1) & 0xFF; }
+        i -= 128;
+        if (i < 256) { sprintf(buf, "%02Xh", i); return i; }
+        i -= 256;
+        if (i < 16) { sprintf(buf, "%Xh", i); return i; }
+        i -= 16;
+        if (i < 256) { sprintf(buf, BYTE_TO_BINARY_PATTERN "b", BYTE_TO_BINARY(i)); return i; }
+        i -= 256;
+        sprintf(buf, NYBBLE_TO_BINARY_PATTERN "b", NYBBLE_TO_BINARY(i));
+        return i;
+    }
+
     void create_def( char* label, uint8_t val) {
             sprintf(defmap[defmap_topindex].name, "%s", label);
             defmap[defmap_topindex].val = val;
-            defmap_topindex++;
+            def_add(defmap_topindex++);
     }
 
     void populate_defmap()
     {
         defmap_topindex = 0;
-        /* Create decimal numbers */
-        for (int i=0; i<256; i++) {
-            sprintf(defmap[defmap_topindex].name, "%d", i);
-            defmap[defmap_topindex].val = i;
-            defmap_topindex++;
-        }
-
-        /* Create negative decimals */
-        for (int i=1; i<=128; i++) {
-            sprintf(defmap[defmap_topindex].name, "-%d", i);
-            defmap[defmap_topindex].val = -i & 0xFF;
-            defmap_topindex++;
-        }
-
-        /* Create zero-padded hex numbers */
-        for (int i=0; i<256; i++) {
-            sprintf(defmap[defmap_topindex].name, "%02X", i);
-            strcat(defmap[defmap_topindex].name, "h");
-            defmap[defmap_topindex].val = i;
-            defmap_topindex++;
-        }
-        /* Create unpadded hex numbers (nybbles) */
-        for (int i=0; i<16; i++) {
-            sprintf(defmap[defmap_topindex].name, "%X", i);
-            strcat(defmap[defmap_topindex].name, "h");
-            defmap[defmap_topindex].val = i;
-            defmap_topindex++;
-        }
-        /* Create binary numbers byte */
-        for (int i=0; i<256; i++) {
-            sprintf(defmap[defmap_topindex].name, BYTE_TO_BINARY_PATTERN, BYTE_TO_BINARY(i));
-            strcat(defmap[defmap_topindex].name, "b");
-            defmap[defmap_topindex].val = i;
-            defmap_topindex++;
-        }
-        /* Create binary numbers nybble */
-        for (int i=0; i<16; i++) {
-            sprintf(defmap[defmap_topindex].name, NYBBLE_TO_BINARY_PATTERN, NYBBLE_TO_BINARY(i));
-            strcat(defmap[defmap_topindex].name, "b");
-            defmap[defmap_topindex].val = i;
-            defmap_topindex++;
-        }
 
         /* Create ASCII names and others */
 
@@ -439,48 +525,74 @@ unsigned lines; /* tracks number of lines processed */
     }
 
 
+/* Define a frame or offset label */
+
+    void label_define( unsigned frame, unsigned slot, char* name, uint8_t ref)
+    {
+        int k;
+
+        frame += slot / 16; /* offslabels can run past the frame */
+        slot %= 16;
+        strcpy(frame_mnemo[frame][slot], name);
+        frame_refs[frame][slot] = ref;
+        if (!name[0]) return;
+
+        k = hash_find(label_hash, label_key, name);
+        if (k == -1) {
+            k = labelset_topindex++;
+            strcpy(labelset[k].name, name);
+            hash_add(label_hash, label_key, name, k);
+        }
+        labelset[k].frames[frame / 64] |= 1ULL << (frame % 64);
+    }
+
+/* Slot of label k in frame i, -1 if there is none
+   (the frame bit may be stale, the slot was overwritten)
+*/
+
+    int label_slot( int k, int i)
+    {
+        if (!(labelset[k].frames[i / 64] >> (i % 64) & 1)) return -1;
+        for (int j=0; j<16; j++)
+            if (!strcmp(labelset[k].name, frame_mnemo[i][j])) return j;
+        return -1;
+    }
+
 /* Validate label references */
 
     int find_backref(char* refstr)
     {
-        //printf("BACKW REFSTR=%s\n", refstr);
-        unsigned here;
-            here = objframe;
-            for (int i=here; i>=0; i--) {
-                for(int j=0; j<16; j++)
-                    if (!strcmp(refstr, frame_mnemo[i][j])) {
-                        theDamned = i;
-                        return frame_refs[i][j];
-                    }
+        int k = hash_find(label_hash, label_key, refstr), j;
+
+        if (k == -1) return -1;
+        for (int i=objframe; i>=0; i--)
+            if ((j = label_slot(k, i)) != -1) {
+                theDamned = i;
+                return frame_refs[i][j];
             }
         return -1;
     }
 
     int find_fwdref(char* refstr)
     {
-        //printf("FWD REFSTR=%s\n", refstr);
-        unsigned here;
-            here = objframe;
-            for (int i=here; i<256; i++) {
-                for(int j=0; j<16; j++) {
-                    //if (!strcmp(refstr, "skip") && i<4)
-                    //    printf("i=%d, j=%d, %s, searching for:%s %d\n", i,j, frame_mnemo[i][j], refstr, frame_refs[i][j]);
-                    if (!strcmp(refstr, frame_mnemo[i][j])) {
-                        theDamned = i;
-                        return frame_refs[i][j];
-                    }
-                }
+        int k = hash_find(label_hash, label_key, refstr), j;
+
+        if (k == -1) return -1;
+        for (int i=objframe; i<256; i++)
+            if ((j = label_slot(k, i)) != -1) {
+                theDamned = i;
+                return frame_refs[i][j];
             }
         return -1;
     }
 
     int find_mcref(char* refstr)
     {
-        //printf("FWD REFSTR=%s\n", refstr);
-        unsigned here;
+        int k = hash_find(label_hash, label_key, refstr);
+
+        if (k == -1) return -1;
         for (int i=0; i<256; i++)
-            for(int j=0; j<16; j++)
-                if (!strcmp(refstr, frame_mnemo[i][j])) return i;
+            if (label_slot(k, i) != -1) return i;
         return -1;
     }
 
@@ -491,36 +603,33 @@ unsigned lines; /* tracks number of lines processed */
 
     int defmap_frame_and_type(char* buf, uint8_t* typefound)
     {
-        for (int i=0; i<defmap_topindex; i++)
-        {
-            if (!strcmp( defmap[i].name, buf)) {
-                //printf ("Found def %s\n", wordbuf);
-                *typefound = defmap[i].type;
-                return defmap[i].frame;
-            }
+        uint8_t val;
+        int i;
+
+        if (parse_number(buf, &val)) { /* Literals were entries of frame 0 */
+            *typefound = 0;
+            return 0;
         }
-        return -1;
+        i = hash_find(def_hash, def_key, buf);
+        if (i == -1) return -1;
+        *typefound = defmap[i].type;
+        return defmap[i].frame;
     }
 
-/* Try to find an entry matching wordbuf in precompiled mnemonics */
+/* Try to find an entry matching wordbuf in precompiled mnemonics,
+   number literals and definitions, in this order
+*/
 
     int compare_to_tables(char* buf)
     {
-        for (int i=0; i<256; i++)
-        {
-            if (!strcmp( mnemo_decoder[i], buf)) {
-                //printf ("Found mnemonic %s (%02X)\n", wordbuf, i);
-                return i;
-            }
-        }
+        uint8_t val;
+        int i;
 
-        for (int i=0; i<defmap_topindex; i++)
-        {
-            if (!strcmp( defmap[i].name, buf)) {
-                //printf ("Found def (or number literal!) %s\n", buf);
-                return defmap[i].val;
-            }
-        }
+        i = hash_find(mnemo_hash, mnemo_key, buf);
+        if (i != -1) return i;
+        if (parse_number(buf, &val)) return val;
+        i = hash_find(def_hash, def_key, buf);
+        if (i != -1) return defmap[i].val;
         return -1;
     }
 
@@ -682,8 +791,7 @@ check_if_ref(char* mybuf)
                     if (wordbuf[0]=='!' && pass==2) {
                     }
                     else frame_mnemo_export[objframe] = 0;
-                    strcpy(frame_mnemo[objframe][offslabels], wordbuf);
-                    frame_refs[objframe][offslabels] = objcursor;
+                    label_define(objframe, offslabels, wordbuf, objcursor);
                     //printf("Defining %s@ objframe=%d offslabels=%d offs:%d\n", wordbuf, objframe, offslabels, objcursor);
                     offslabels++;
                     handled = 1;
@@ -762,8 +870,7 @@ check_if_ref(char* mybuf)
                                 //printf("Found export label: %s\n", wordbuf);
                         }
                         else frame_mnemo_export[objframe] = 0;
-                        strcpy(frame_mnemo[objframe][offslabels], wordbuf+1);
-                        frame_refs[objframe][offslabels] = objframe;
+                        label_define(objframe, offslabels, wordbuf+1, objframe);
                         //printf("Defining @%s objframe=%d offslabels=%d\n", wordbuf+1, objframe, offslabels);
                         offslabels++;
                         labelallowed = 0; /* only 1 frame label per full stop */
@@ -828,7 +935,8 @@ check_if_ref(char* mybuf)
                             strcpy( defmap[defmap_topindex].name, wordbuf+1 );
                         }
                         else strcpy(defmap[defmap_topindex].name, wordbuf);
-                        defmap[defmap_topindex++].val = k;
+                        defmap[defmap_topindex].val = k;
+                        def_add(defmap_topindex++);
                     }        
                     handled = 1;
                 }
@@ -1063,7 +1171,8 @@ int main (int argc, char **argv)
     fprintf(f,"struct {char *name; uint8_t val;} numbers[NUMBERS_ARRAY_SIZE] = {\n");
     for (int i=0; i<928/4; i++){
         for (int j=0; j<4; j++) {
-            fprintf(f,"{\"%s\",0x%02X}", defmap[i*4+j].name, defmap[i*4+j].val);
+            uint8_t val = number_name(i*4+j, tempbuf);
+            fprintf(f,"{\"%s\",0x%02X}", tempbuf, val);
             if (i==(928/4)-1 && j==3) break;
             else fprintf(f,", ");
         }
@@ -1170,11 +1279,18 @@ int main (int argc, char **argv)
 
     printf("Writing object file...\n\n");
 
-    f = fopen("myth.obj","w");
-    fwrite(&vm, 1,
-        sizeof(struct myth_vm)
-         - 2 * sizeof(void (*[16])(void)),
-    f);
+    /* Register block in mythlib.c myth_regs() order */
+    uint8_t regs[19] = {
+        vm.reg_G, vm.reg_D, vm.reg_O, vm.reg_R, vm.reg_I,
+        vm.reg_A, vm.reg_B, vm.reg_LJO, vm.reg_C, vm.reg_L,
+        vm.reg_E, vm.reg_SIR, vm.reg_SOR, vm.reg_PIR, vm.reg_POR,
+        vm.reg_PC, vm.reg_xMx, vm.par_ready, vm.ser_clock
+    };
+    static uint8_t img[MYST_MAXSIZE(128, 256, 19)];
+    long imglen = myst_encode(img, MYST_VERILOG, vm.ram, 128, 256, regs, 19);
+
+    f = fopen("myth.obj","wb");
+    fwrite(img, 1, imglen, f);
     fclose(f);
 
     mifgen("myth.mif"); // MIF file for Quartus import
@@ -1192,18 +1308,27 @@ int main (int argc, char **argv)
     int outputlen;
     int lead_frame=0, lead_offset=0;
 
+    /* Object code bytes by source line, each line's list in frame
+       and offset order, so every byte is visited once
+    */
+    unsigned maxline = 0, npos = (objframe+1) * 128;
+    static int line_next[256*128];
+    for (int i=0; i<npos; i++)
+        if (ROM_srcLine[i] > maxline) maxline = ROM_srcLine[i];
+    int *line_head = malloc((maxline+1) * sizeof(int));
+    for (int i=0; i<=maxline; i++) line_head[i] = -1;
+    for (int i=npos-1; i>=0; i--) {
+        line_next[i] = line_head[ROM_srcLine[i]];
+        line_head[ROM_srcLine[i]] = i;
+    }
+
     while (k<srclength) {
 
         /* Write object code generated for line*/
 
-        lead_frame = -1;
-        lead_offset = -1;
-        for (int frame=0; frame<=objframe; frame++)
-            for (int offset=0; offset<128; offset++)
-                if (ROM_srcLine[frame*128 + offset] == lines) {
-                    if (lead_frame == -1) lead_frame = frame;
-                    if (lead_offset == -1) lead_offset = offset;
-                }
+        int pos = lines <= maxline ? line_head[lines] : -1;
+        lead_frame = pos == -1 ? -1 : pos / 128;
+        lead_offset = pos == -1 ? -1 : pos % 128;
 
         if (lead_frame != -1 || lead_offset != -1)
         {
@@ -1213,20 +1338,19 @@ int main (int argc, char **argv)
 
         outputlen = 0;
         int linefill = 0;
-        for (int frame=0; frame<=objframe; frame++) {
-            for (int offset=0; offset<128; offset++) {
-                if (ROM_srcLine[frame*128 + offset] == lines) {
-                    if (!(++linefill%8)) {
-                        fprintf(f, "\n        ");
-                        outputlen -= 21;
-                    }
-                    lead_frame = frame;
-                    lead_offset = offset;
-                    fprintf(f, "%02X ", vm.ram[frame*128+offset]);
-                    outputlen += 3;
-                    if (offset>frame_lid[frame]) break;
-                }
+        int skipframe = -1; /* Rest of this frame is past its lid */
+        for (; pos != -1; pos = line_next[pos]) {
+            int frame = pos / 128, offset = pos % 128;
+            if (frame == skipframe) continue;
+            if (!(++linefill%8)) {
+                fprintf(f, "\n        ");
+                outputlen -= 21;
             }
+            lead_frame = frame;
+            lead_offset = offset;
+            fprintf(f, "%02X ", vm.ram[frame*128+offset]);
+            outputlen += 3;
+            if (offset>frame_lid[frame]) skipframe = frame;
         }
 
         if (outputlen) outputlen = outputlen>(24+3) ? 24 : outputlen-3;
@@ -1247,6 +1371,7 @@ int main (int argc, char **argv)
         fprintf(f, "\n");
     }
 
+    free(line_head);
     fclose(f);
 
 }